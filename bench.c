@@ -0,0 +1,639 @@
+/*
+ * CGUI Benchmark
+ * Drives gui_context_t through headless stress scenes (no window or GL context needed), reports
+ * timings, allocations and peak memory as JSON, and optionally fails when a scene regresses
+ * against a stored baseline. Timings are compared relative to a fixed calibration workload run
+ * between the frames, so a baseline recorded on one machine stays usable on another.
+ *
+ * Usage: cgui_bench [--out FILE] [--baseline FILE] [--tolerance RATIO] [--frames N]
+ */
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Counting heap hooks: every allocation carries its size so peak live bytes can be tracked
+static struct {
+    uint64_t allocations;
+    size_t live_bytes;
+    size_t peak_bytes;
+} bench_heap;
+
+#define BENCH_HEAP_HEADER 16 // Keeps the returned memory 16-byte aligned
+
+static void *bench_track(unsigned char *block, size_t size) {
+    if (!block) {
+        return NULL;
+    }
+    memcpy(block, &size, sizeof(size));
+    bench_heap.allocations++;
+    bench_heap.live_bytes += size;
+    if (bench_heap.live_bytes > bench_heap.peak_bytes) {
+        bench_heap.peak_bytes = bench_heap.live_bytes;
+    }
+    return block + BENCH_HEAP_HEADER;
+}
+
+static size_t bench_untrack(void *ptr) {
+    size_t size;
+    memcpy(&size, (unsigned char *)ptr - BENCH_HEAP_HEADER, sizeof(size));
+    bench_heap.live_bytes -= size;
+    return size;
+}
+
+static void *bench_malloc(size_t size) {
+    return bench_track((unsigned char *)malloc(size + BENCH_HEAP_HEADER), size);
+}
+
+static void *bench_calloc(size_t count, size_t size) {
+    return bench_track((unsigned char *)calloc(1, (count * size) + BENCH_HEAP_HEADER),
+                       count * size);
+}
+
+static void bench_free(void *ptr) {
+    if (ptr) {
+        bench_untrack(ptr);
+        free((unsigned char *)ptr - BENCH_HEAP_HEADER);
+    }
+}
+
+static void *bench_realloc(void *ptr, size_t size) {
+    if (!ptr) {
+        return bench_malloc(size);
+    }
+    size_t old_size = bench_untrack(ptr);
+    unsigned char *header = (unsigned char *)ptr - BENCH_HEAP_HEADER;
+    unsigned char *block = (unsigned char *)realloc(header, size + BENCH_HEAP_HEADER);
+    if (!block) {
+        bench_heap.live_bytes += old_size; // The old block is still owned by the caller
+        return NULL;
+    }
+    return bench_track(block, size);
+}
+
+// Large enough that the stress scenes are never truncated by the draw buffers
+#define CGUI_MAX_VERTICES (1 << 22)
+#define CGUI_MAX_INDICES (1 << 23)
+#define CGUI_MAX_DRAW_COMMANDS 65536
+#define CGUI_MALLOC(size) bench_malloc(size)
+#define CGUI_CALLOC(count, size) bench_calloc(count, size)
+#define CGUI_REALLOC(ptr, size) bench_realloc(ptr, size)
+#define CGUI_FREE(ptr) bench_free(ptr)
+#define CGUI_IMPLEMENTATION
+#include "cgui.h"
+
+#ifndef _WIN32
+#include <pthread.h> // <windows.h> comes with cgui.h on Windows
+#endif
+
+#define BENCH_DISPLAY_W 8000.0F
+#define BENCH_DISPLAY_H 8000.0F
+#define BENCH_WARMUP_FRAMES 3
+#define BENCH_MAX_SCENES 16
+
+// The library's monotonic clock: a wall-clock step during a run would skew a scene's timing
+static double bench_now_ns(void) { return (double)gui_time_ns(); }
+
+// =============================================================================
+// SCENES
+// =============================================================================
+
+// A scene builds one frame and returns the number of items (widgets or primitives) it submitted.
+// setup, when set, configures the fresh context before the first frame.
+typedef struct {
+    const char *name;
+    int (*frame)(gui_context_t *ctx, int frame_index);
+    void (*setup)(gui_context_t *ctx);
+} bench_scene_t;
+
+static int scene_buttons_10k(gui_context_t *ctx, int frame_index) {
+    (void)frame_index;
+    for (int row = 0; row < 100; row++) {
+        gui_begin_hbox(ctx, 0.0F, (float)row * 22.0F, 20.0F, 0.0F, 2.0F);
+        for (int col = 0; col < 100; col++) {
+            gui_push_id_int(ctx, (row * 100) + col);
+            gui_button(ctx, "OK", 60.0F, 20.0F);
+            gui_pop_id(ctx);
+        }
+        gui_end_hbox(ctx);
+    }
+    return 10000;
+}
+
+#define BENCH_LINE_POINTS 65537 // 65536 segments per polyline, 16 polylines per frame
+
+static gui_vec2_t bench_line_points[BENCH_LINE_POINTS];
+
+static int scene_lines_1m(gui_context_t *ctx, int frame_index) {
+    for (int strip = 0; strip < 16; strip++) {
+        float base_y = 100.0F + ((float)strip * 480.0F);
+        for (int i = 0; i < BENCH_LINE_POINTS; i++) {
+            float x = (float)i * (BENCH_DISPLAY_W / (float)BENCH_LINE_POINTS);
+            float y = base_y + (float)(((i * 7919) + frame_index) % 400);
+            bench_line_points[i] = (gui_vec2_t){x, y};
+        }
+        gui_add_polyline(ctx, bench_line_points, BENCH_LINE_POINTS, GUI_COLOR_WHITE, 1.0F);
+    }
+    return 16 * (BENCH_LINE_POINTS - 1);
+}
+
+static int scene_text_wall(gui_context_t *ctx, int frame_index) {
+    static const char line[] = "The quick brown fox jumps over the lazy dog 0123456789 "
+                               "Sphinx of black quartz, judge my vow. Pack my box with five";
+    int glyphs = 0;
+    for (int i = 0; i < 2000; i++) {
+        float y = (float)((i + frame_index) % 2000) * 4.0F;
+        gui_add_text(ctx, line, 0.0F, y, GUI_COLOR_WHITE, 10.0F);
+        glyphs += (int)sizeof(line) - 1;
+    }
+    return glyphs;
+}
+
+// Clip rects nested to the stack limit, each level with a vbox holding a label and a button
+static int scene_deep_nesting(gui_context_t *ctx, int frame_index) {
+    (void)frame_index;
+    int widgets = 0;
+    for (int tree = 0; tree < 64; tree++) {
+        float x = (float)(tree % 8) * 1000.0F;
+        float y = (float)(tree / 8) * 1000.0F;
+        gui_push_id_int(ctx, tree);
+        int depth = 0;
+        for (; depth < CGUI_MAX_CLIP_STACK - 1; depth++) {
+            float inset = (float)depth * 10.0F;
+            gui_push_clip_rect(ctx, x + inset, y + inset, 1000.0F - (inset * 2.0F),
+                               1000.0F - (inset * 2.0F), true);
+            gui_begin_vbox(ctx, x + inset, y + inset, 300.0F, 2.0F, 2.0F);
+            gui_push_id_int(ctx, depth);
+            gui_label(ctx, "level");
+            gui_button(ctx, "btn", 0.0F, 8.0F);
+            widgets += 2;
+        }
+        for (; depth > 0; depth--) {
+            gui_pop_id(ctx);
+            gui_end_vbox(ctx);
+            gui_pop_clip_rect(ctx);
+        }
+        gui_pop_id(ctx);
+    }
+    return widgets;
+}
+
+// Nested flex containers with weighted children
+static int scene_flex_nesting(gui_context_t *ctx, int frame_index) {
+    (void)frame_index;
+    int widgets = 0;
+    gui_begin_flex(ctx, "root", GUI_FLEX_COLUMN, 0.0F, 0.0F, BENCH_DISPLAY_W, BENCH_DISPLAY_H, 4.0F,
+                   4.0F);
+    for (int row = 0; row < 40; row++) {
+        gui_push_id_int(ctx, row);
+        gui_flex_item(ctx, 1.0F, 0.0F, 0.0F, GUI_ALIGN_STRETCH);
+        gui_begin_flex(ctx, "row", GUI_FLEX_ROW, 0.0F, 0.0F, 0.0F, 0.0F, 2.0F, 2.0F);
+        for (int col = 0; col < 40; col++) {
+            gui_push_id_int(ctx, col);
+            gui_flex_item(ctx, (float)(1 + (col % 3)), 20.0F, 0.0F, GUI_ALIGN_CENTER);
+            gui_button(ctx, "cell", 0.0F, 30.0F);
+            gui_pop_id(ctx);
+            widgets++;
+        }
+        gui_end_flex(ctx);
+        gui_pop_id(ctx);
+    }
+    gui_end_flex(ctx);
+    return widgets;
+}
+
+// 1000 sliders; the mouse holds the first one and sweeps across it every frame
+static int scene_slider_drag(gui_context_t *ctx, int frame_index) {
+    static float values[1000];
+    gui_begin_vbox(ctx, 0.0F, 0.0F, 400.0F, 0.0F, 2.0F);
+    for (int i = 0; i < 1000; i++) {
+        gui_push_id_int(ctx, i);
+        gui_slider_float(ctx, "value", &values[i], 0.0F, 1.0F, 0.0F);
+        gui_pop_id(ctx);
+    }
+    gui_end_vbox(ctx);
+
+    // Input for the next frame: press on the first slider, then drag
+    double t = (double)frame_index;
+    gui_input_add_mouse_pos(ctx, (float)(frame_index % 400), 10.0F, t);
+    gui_input_add_mouse_button(ctx, GUI_MOUSE_BUTTON_LEFT, true, t);
+    return 1000;
+}
+
+// Anti-aliased circles, filled and outlined: tessellation (fringes, joins) dominates the frame
+static int scene_circles_aa(gui_context_t *ctx, int frame_index) {
+    for (int i = 0; i < 10000; i++) {
+        float x = 40.0F + (float)((i % 100) * 79);
+        float y = 40.0F + (float)(((i / 100) * 79) + (frame_index % 8));
+        gui_add_circle_filled(ctx, x, y, 30.0F, GUI_COLOR_BLUE);
+        gui_add_circle(ctx, x, y, 34.0F, GUI_COLOR_WHITE, 2.0F);
+    }
+    return 20000;
+}
+
+static void setup_anti_aliased(gui_context_t *ctx) { ctx->style.anti_aliased_shapes = true; }
+
+// Persistent pool behind bench_parallel_for: BENCH_THREADS - 1 workers started by the first
+// parallel scene and stopped on exit. Each call publishes the task under a new generation; the
+// workers and the calling thread claim indices one at a time until all are taken, and the call
+// returns once every task has finished.
+#define BENCH_THREADS 4
+
+typedef struct {
+#ifdef _WIN32
+    SRWLOCK lock;
+    CONDITION_VARIABLE wake; // A new generation or quit
+    CONDITION_VARIABLE done; // The last task of the generation finished
+    HANDLE threads[BENCH_THREADS - 1];
+#else
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+    pthread_cond_t done;
+    pthread_t threads[BENCH_THREADS - 1];
+#endif
+    uint32_t thread_count;
+    uint64_t generation;
+    bool quit;
+    void (*task)(void *data, uint32_t index);
+    void *data;
+    uint32_t count;
+    uint32_t next;
+    uint32_t finished;
+} bench_pool_t;
+
+static bench_pool_t bench_pool;
+
+#ifdef _WIN32
+static void bench_pool_lock(bench_pool_t *pool) { AcquireSRWLockExclusive(&pool->lock); }
+static void bench_pool_unlock(bench_pool_t *pool) { ReleaseSRWLockExclusive(&pool->lock); }
+static void bench_pool_wait(bench_pool_t *pool, CONDITION_VARIABLE *cond) {
+    SleepConditionVariableSRW(cond, &pool->lock, INFINITE, 0);
+}
+static void bench_pool_broadcast(CONDITION_VARIABLE *cond) { WakeAllConditionVariable(cond); }
+#else
+static void bench_pool_lock(bench_pool_t *pool) { pthread_mutex_lock(&pool->lock); }
+static void bench_pool_unlock(bench_pool_t *pool) { pthread_mutex_unlock(&pool->lock); }
+static void bench_pool_wait(bench_pool_t *pool, pthread_cond_t *cond) {
+    pthread_cond_wait(cond, &pool->lock);
+}
+static void bench_pool_broadcast(pthread_cond_t *cond) { pthread_cond_broadcast(cond); }
+#endif
+
+// Runs the current generation's unclaimed tasks; called and returns with the lock held
+static void bench_pool_drain(bench_pool_t *pool) {
+    while (pool->next < pool->count) {
+        uint32_t index = pool->next++;
+        bench_pool_unlock(pool);
+        pool->task(pool->data, index);
+        bench_pool_lock(pool);
+        if (++pool->finished == pool->count) {
+            bench_pool_broadcast(&pool->done);
+        }
+    }
+}
+
+#ifdef _WIN32
+static DWORD WINAPI bench_worker_main(LPVOID arg) {
+#else
+static void *bench_worker_main(void *arg) {
+#endif
+    bench_pool_t *pool = (bench_pool_t *)arg;
+    bench_pool_lock(pool);
+    uint64_t seen = pool->generation;
+    for (;;) {
+        while (!pool->quit && pool->generation == seen) {
+            bench_pool_wait(pool, &pool->wake);
+        }
+        if (pool->quit) {
+            break;
+        }
+        seen = pool->generation;
+        bench_pool_drain(pool);
+    }
+    bench_pool_unlock(pool);
+    return 0;
+}
+
+static void bench_pool_start(bench_pool_t *pool) {
+    if (pool->thread_count > 0) {
+        return;
+    }
+#ifdef _WIN32
+    InitializeSRWLock(&pool->lock);
+    InitializeConditionVariable(&pool->wake);
+    InitializeConditionVariable(&pool->done);
+#else
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->wake, NULL);
+    pthread_cond_init(&pool->done, NULL);
+#endif
+    // Threads that fail to start leave their share to the others and the caller
+    for (uint32_t t = 0; t < BENCH_THREADS - 1; t++) {
+#ifdef _WIN32
+        HANDLE thread = CreateThread(NULL, 0, bench_worker_main, pool, 0, NULL);
+        if (thread) {
+            pool->threads[pool->thread_count++] = thread;
+        }
+#else
+        if (pthread_create(&pool->threads[pool->thread_count], NULL, bench_worker_main, pool) ==
+            0) {
+            pool->thread_count++;
+        }
+#endif
+    }
+}
+
+static void bench_pool_stop(bench_pool_t *pool) {
+    if (pool->thread_count == 0) {
+        return;
+    }
+    bench_pool_lock(pool);
+    pool->quit = true;
+    bench_pool_broadcast(&pool->wake);
+    bench_pool_unlock(pool);
+    for (uint32_t t = 0; t < pool->thread_count; t++) {
+#ifdef _WIN32
+        WaitForSingleObject(pool->threads[t], INFINITE);
+        CloseHandle(pool->threads[t]);
+#else
+        pthread_join(pool->threads[t], NULL);
+#endif
+    }
+#ifndef _WIN32
+    pthread_mutex_destroy(&pool->lock);
+    pthread_cond_destroy(&pool->wake);
+    pthread_cond_destroy(&pool->done);
+#endif
+    memset(pool, 0, sizeof(bench_pool_t));
+}
+
+static void bench_parallel_for(void *pool_ptr, uint32_t count,
+                               void (*task)(void *data, uint32_t index), void *data) {
+    bench_pool_t *pool = (bench_pool_t *)pool_ptr;
+    bench_pool_lock(pool);
+    pool->task = task;
+    pool->data = data;
+    pool->count = count;
+    pool->next = 0;
+    pool->finished = 0;
+    pool->generation++;
+    bench_pool_broadcast(&pool->wake);
+    bench_pool_drain(pool);
+    while (pool->finished < pool->count) {
+        bench_pool_wait(pool, &pool->done);
+    }
+    bench_pool_unlock(pool);
+}
+
+static void setup_deferred_parallel(gui_context_t *ctx) {
+    bench_pool_start(&bench_pool);
+    ctx->deferred = true;
+    ctx->parallel_for = bench_parallel_for;
+    ctx->parallel_pool = &bench_pool;
+}
+
+static void setup_anti_aliased_parallel(gui_context_t *ctx) {
+    setup_anti_aliased(ctx);
+    setup_deferred_parallel(ctx);
+}
+
+static const bench_scene_t bench_scenes[] = {
+    {"buttons_10k", scene_buttons_10k, NULL},
+    {"lines_1m", scene_lines_1m, NULL},
+    {"text_wall", scene_text_wall, NULL},
+    {"deep_nesting", scene_deep_nesting, NULL},
+    {"flex_nesting", scene_flex_nesting, NULL},
+    {"slider_drag", scene_slider_drag, NULL},
+    {"circles_aa", scene_circles_aa, setup_anti_aliased},
+    // The same scenes recorded and tessellated in blocks across the worker threads. Only
+    // circles_aa has enough tessellation per recorded call to gain from more than one core.
+    {"text_wall_mt", scene_text_wall, setup_deferred_parallel},
+    {"circles_aa_mt", scene_circles_aa, setup_anti_aliased_parallel},
+};
+
+// =============================================================================
+// RUNNER
+// =============================================================================
+
+static float bench_calibration_data[1 << 16];
+
+// One run of a fixed mix of float math and stores, independent of the library. Each scene runs it
+// before every frame and its timings are compared as multiples of the fastest run, which cancels
+// most of the difference in speed between machines (not all: caches and vector units differ) and
+// between quiet and busy moments on the same one.
+static double bench_calibrate(void) {
+    const uint32_t count = (uint32_t)(sizeof(bench_calibration_data) / sizeof(float));
+    double start = bench_now_ns();
+    for (uint32_t pass = 0; pass < 8; pass++) {
+        for (uint32_t i = 0; i < count; i++) {
+            float x = bench_calibration_data[i];
+            bench_calibration_data[i] = (x * 0.5F) + sqrtf((float)(i ^ pass) + 1.0F);
+        }
+    }
+    return bench_now_ns() - start;
+}
+
+typedef struct {
+    const char *name;
+    int frames;
+    int items;
+    double ns_per_frame; // Fastest frame: the least disturbed by the rest of the machine
+    double ns_per_item;
+    double calibration_ns; // Fastest calibration run
+    double relative;       // ns_per_frame over calibration_ns
+    uint32_t vertices;
+    double vertices_per_sec;
+    double allocs_per_frame;
+    size_t peak_bytes;
+} bench_result_t;
+
+static bench_result_t bench_run(const bench_scene_t *scene, int frames) {
+    memset(&bench_heap, 0, sizeof(bench_heap));
+    static gui_context_t ctx;
+    gui_init(&ctx);
+    if (scene->setup) {
+        scene->setup(&ctx);
+    }
+
+    bench_result_t result = {scene->name, frames, 0, 0.0, 0.0, 0.0, 0.0, 0, 0.0, 0.0, 0};
+    for (int f = 0; f < BENCH_WARMUP_FRAMES; f++) {
+        gui_begin_frame(&ctx, BENCH_DISPLAY_W, BENCH_DISPLAY_H);
+        scene->frame(&ctx, f);
+        gui_end_frame(&ctx);
+    }
+
+    // Only steady-state frames count toward the per-frame allocation figure
+    uint64_t allocations = bench_heap.allocations;
+    double elapsed = 0.0;
+    for (int f = 0; f < frames; f++) {
+        double calibration_ns = bench_calibrate();
+        if (f == 0 || calibration_ns < result.calibration_ns) {
+            result.calibration_ns = calibration_ns;
+        }
+        double start = bench_now_ns();
+        gui_begin_frame(&ctx, BENCH_DISPLAY_W, BENCH_DISPLAY_H);
+        result.items = scene->frame(&ctx, BENCH_WARMUP_FRAMES + f);
+        gui_end_frame(&ctx);
+        double frame_ns = bench_now_ns() - start;
+        elapsed += frame_ns;
+        if (f == 0 || frame_ns < result.ns_per_frame) {
+            result.ns_per_frame = frame_ns;
+        }
+    }
+
+    result.ns_per_item = (result.items > 0) ? result.ns_per_frame / (double)result.items : 0.0;
+    result.relative =
+        (result.calibration_ns > 0.0) ? result.ns_per_frame / result.calibration_ns : 0.0;
+    result.vertices = ctx.vertex_count;
+    result.vertices_per_sec =
+        (elapsed > 0.0) ? ((double)ctx.vertex_count * (double)frames) / (elapsed * 1e-9) : 0.0;
+    result.allocs_per_frame = (double)(bench_heap.allocations - allocations) / (double)frames;
+    result.peak_bytes = bench_heap.peak_bytes;
+
+    gui_shutdown(&ctx);
+    return result;
+}
+
+static void bench_write_json(FILE *file, const bench_result_t *results, int count) {
+    fprintf(file, "{\n  \"scenes\": [\n");
+    for (int i = 0; i < count; i++) {
+        const bench_result_t *r = &results[i];
+        fprintf(file,
+                "    {\"name\": \"%s\", \"frames\": %d, \"items\": %d, \"ns_per_frame\": %.1f, "
+                "\"ns_per_item\": %.3f, \"calibration_ns\": %.1f, \"relative\": %.4f, "
+                "\"vertices\": %u, \"vertices_per_sec\": %.0f, \"allocs_per_frame\": %.2f, "
+                "\"peak_bytes\": %zu}%s\n",
+                r->name, r->frames, r->items, r->ns_per_frame, r->ns_per_item, r->calibration_ns,
+                r->relative, r->vertices, r->vertices_per_sec, r->allocs_per_frame, r->peak_bytes,
+                (i + 1 < count) ? "," : "");
+    }
+    fprintf(file, "  ]\n}\n");
+}
+
+// Reads `"key": <number>` from the baseline object of the named scene (the format written by
+// bench_write_json). Returns false if the scene or key is missing.
+static bool bench_baseline_value(const char *json, const char *scene, const char *key,
+                                 double *out) {
+    char pattern[128];
+    snprintf(pattern, sizeof(pattern), "\"name\": \"%s\"", scene);
+    const char *object = strstr(json, pattern);
+    if (!object) {
+        return false;
+    }
+    const char *object_end = strchr(object, '}');
+    snprintf(pattern, sizeof(pattern), "\"%s\":", key);
+    const char *field = strstr(object, pattern);
+    if (!field || (object_end && field > object_end)) {
+        return false;
+    }
+    *out = strtod(field + strlen(pattern), NULL);
+    return true;
+}
+
+static char *bench_read_file(const char *path) {
+    FILE *file = fopen(path, "rb");
+    if (!file) {
+        return NULL;
+    }
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    char *data = (size >= 0) ? (char *)malloc((size_t)size + 1U) : NULL;
+    if (data) {
+        size_t read = fread(data, 1, (size_t)size, file);
+        data[read] = '\0';
+    }
+    fclose(file);
+    return data;
+}
+
+// A scene regresses when its time relative to the calibration exceeds the baseline's by more than
+// `tolerance`, or it emits more vertices or allocates more per steady-state frame (both exact,
+// whatever the machine). Returns the number of regressions.
+static int bench_compare(const char *json, const bench_result_t *results, int count,
+                         double tolerance) {
+    int regressions = 0;
+    for (int i = 0; i < count; i++) {
+        const bench_result_t *r = &results[i];
+        double base_relative;
+        double base_vertices;
+        double base_allocs;
+        if (!bench_baseline_value(json, r->name, "relative", &base_relative) ||
+            !bench_baseline_value(json, r->name, "vertices", &base_vertices) ||
+            !bench_baseline_value(json, r->name, "allocs_per_frame", &base_allocs)) {
+            fprintf(stderr, "%-14s no baseline\n", r->name);
+            continue;
+        }
+        bool slow = r->relative > base_relative * tolerance;
+        bool vertices = (double)r->vertices > base_vertices;
+        bool allocs = r->allocs_per_frame > base_allocs + 0.005;
+        fprintf(stderr,
+                "%-14s %9.4f x calibration (baseline %9.4f, x%.2f) %6.2f allocs/frame%s%s%s\n",
+                r->name, r->relative, base_relative,
+                (base_relative > 0.0) ? r->relative / base_relative : 0.0, r->allocs_per_frame,
+                slow ? "  SLOWER" : "", vertices ? "  MORE VERTICES" : "",
+                allocs ? "  MORE ALLOCATIONS" : "");
+        regressions += (slow || vertices || allocs) ? 1 : 0;
+    }
+    return regressions;
+}
+
+int main(int argc, char **argv) {
+    const char *out_path = NULL;
+    const char *baseline_path = NULL;
+    double tolerance = 1.5;
+    int frames = 20;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--out") == 0 && i + 1 < argc) {
+            out_path = argv[++i];
+        } else if (strcmp(argv[i], "--baseline") == 0 && i + 1 < argc) {
+            baseline_path = argv[++i];
+        } else if (strcmp(argv[i], "--tolerance") == 0 && i + 1 < argc) {
+            tolerance = strtod(argv[++i], NULL);
+        } else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            frames = atoi(argv[++i]);
+        } else {
+            fprintf(stderr,
+                    "usage: %s [--out FILE] [--baseline FILE] [--tolerance RATIO] [--frames N]\n",
+                    argv[0]);
+            return 2;
+        }
+    }
+    frames = (frames > 0) ? frames : 1;
+
+    int scene_count = (int)(sizeof(bench_scenes) / sizeof(bench_scenes[0]));
+    bench_result_t results[BENCH_MAX_SCENES];
+    for (int i = 0; i < scene_count; i++) {
+        results[i] = bench_run(&bench_scenes[i], frames);
+    }
+    bench_pool_stop(&bench_pool);
+
+    bench_write_json(stdout, results, scene_count);
+    if (out_path) {
+        FILE *file = fopen(out_path, "wb");
+        if (!file) {
+            fprintf(stderr, "cannot write %s\n", out_path);
+            return 1;
+        }
+        bench_write_json(file, results, scene_count);
+        fclose(file);
+    }
+
+    if (baseline_path) {
+        char *json = bench_read_file(baseline_path);
+        if (!json) {
+            fprintf(stderr, "cannot read baseline %s\n", baseline_path);
+            return 1;
+        }
+        int regressions = bench_compare(json, results, scene_count, tolerance);
+        free(json);
+        if (regressions > 0) {
+            fprintf(stderr, "%d scene(s) regressed against %s\n", regressions, baseline_path);
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -48,6 +48,82 @@ extern "C" {
 #define CGUI_MAX_LAYOUT_STACK 64
 #endif
 
+#ifndef CGUI_MAX_FLEX_CHILDREN
+#define CGUI_MAX_FLEX_CHILDREN 64 // Per flex container; extra children are stacked, not solved
+#endif
+
+#ifndef CGUI_REORDER_WINDOW
+#define CGUI_REORDER_WINDOW 64 // Commands a command may move back over when reordering
+#endif
+
+#ifndef CGUI_MAX_ID_STACK
+#define CGUI_MAX_ID_STACK 32
+#endif
+
+#ifndef CGUI_INPUT_QUEUE_SIZE
+#define CGUI_INPUT_QUEUE_SIZE 256 // Must be a power of two
+#endif
+
+#ifndef CGUI_MAX_TRANSFORM_STACK
+#define CGUI_MAX_TRANSFORM_STACK 16
+#endif
+
+#ifndef CGUI_MAX_LAYER_STACK
+#define CGUI_MAX_LAYER_STACK 16
+#endif
+
+#ifndef CGUI_MAX_CACHED_STACK
+#define CGUI_MAX_CACHED_STACK 16 // Nesting depth of gui_begin_cached blocks
+#endif
+
+#ifndef CGUI_DEFERRED_BLOCK_SIZE
+#define CGUI_DEFERRED_BLOCK_SIZE 256 // Deferred draw calls per tessellation task
+#endif
+
+#ifndef CGUI_LOG_SCAN_BUDGET
+#define CGUI_LOG_SCAN_BUDGET (8U * 1024U * 1024U) // Bytes a log view indexes per frame
+#endif
+
+#ifndef CGUI_HIT_GRID_CELL_SIZE
+#define CGUI_HIT_GRID_CELL_SIZE 64.0F // Pixels per hit-test grid cell
+#endif
+
+#ifndef CGUI_GRID_MAX_DIM
+#define CGUI_GRID_MAX_DIM 128 // Cells per axis; larger areas get larger cells
+#endif
+
+#ifndef CGUI_GRAPH_CELL_SIZE
+#define CGUI_GRAPH_CELL_SIZE 256.0F // Canvas units per node graph grid cell
+#endif
+
+#ifndef CGUI_GRAPH_LOD_ZOOM
+#define CGUI_GRAPH_LOD_ZOOM 0.5F // Node graphs zoomed out further drop titles and curves
+#endif
+
+#ifndef CGUI_GRAPH_LINK_SEGMENT
+#define CGUI_GRAPH_LINK_SEGMENT 8.0F // Pixels per link curve segment
+#endif
+
+#ifndef CGUI_STATS_HISTORY
+#define CGUI_STATS_HISTORY 120 // Frames of statistics kept for gui_stats_overlay
+#endif
+
+#ifndef CGUI_TRACE_CAPACITY
+#define CGUI_TRACE_CAPACITY 16384 // Zones kept per thread; must be a power of two
+#endif
+
+#ifndef CGUI_TRACE_MAX_DEPTH
+#define CGUI_TRACE_MAX_DEPTH 64 // Deeper zones are not recorded
+#endif
+
+#ifndef CGUI_STATE_STORAGE_INITIAL_CAPACITY
+#define CGUI_STATE_STORAGE_INITIAL_CAPACITY 256 // Must be a power of two
+#endif
+
+#ifndef CGUI_STATE_MAX_IDLE_FRAMES
+#define CGUI_STATE_MAX_IDLE_FRAMES 0 // Frames before unrequested state is freed; 0 keeps it
+#endif
+
 // =============================================================================
 // TYPES & STRUCTURES
 // =============================================================================
@@ -88,12 +164,26 @@ typedef struct {
     gui_vec2_t pos;
     gui_vec2_t uv;
     gui_color_t col;
+#ifdef CGUI_ENABLE_OPAQUE_PASS
+    float depth; // Later primitives are nearer (smaller); set when the primitive is closed
+#endif
 } gui_vertex_t;
 
+// 2D affine transform: x' = m[0] x + m[2] y + m[4], y' = m[1] x + m[3] y + m[5]
+typedef struct {
+    float m[6];
+} gui_transform_t;
+
 // Draw command
 typedef enum {
     GUI_DRAW_CMD_TRIANGLES,
     GUI_DRAW_CMD_SET_CLIP_RECT,
+    // Cached layers (see gui_begin_cached_layer); `texture` holds the layer ID, not a texture.
+    // The commands between BEGIN and END draw the layer's content into a clip_rect-sized
+    // texture; DRAW composites that texture (premultiplied alpha) with its quad.
+    GUI_DRAW_CMD_LAYER_BEGIN,
+    GUI_DRAW_CMD_LAYER_END,
+    GUI_DRAW_CMD_LAYER_DRAW,
 } gui_draw_cmd_type_t;
 
 typedef struct {
@@ -101,7 +191,8 @@ typedef struct {
     gui_texture_id_t texture;
     uint32_t idx_offset;
     uint32_t elem_count;
-    gui_rect_t clip_rect;
+    gui_rect_t clip_rect;      // Screen space
+    gui_transform_t transform; // Applied to the vertices by the backend, before the projection
 } gui_draw_cmd_t;
 
 // Mouse buttons
@@ -112,6 +203,39 @@ typedef enum {
     GUI_MOUSE_BUTTON_COUNT = 3,
 } gui_mouse_button_t;
 
+// Key codes index gui_input_t.keys and use GLFW's key values; printable keys use the ASCII code of
+// their unshifted (uppercase letter) character
+typedef enum {
+    GUI_KEY_SPACE = 32,
+    GUI_KEY_A = 65,
+    GUI_KEY_C = 67,
+    GUI_KEY_V = 86,
+    GUI_KEY_X = 88,
+    GUI_KEY_Y = 89,
+    GUI_KEY_Z = 90,
+    GUI_KEY_ESCAPE = 256,
+    GUI_KEY_ENTER = 257,
+    GUI_KEY_TAB = 258,
+    GUI_KEY_BACKSPACE = 259,
+    GUI_KEY_INSERT = 260,
+    GUI_KEY_DELETE = 261,
+    GUI_KEY_RIGHT = 262,
+    GUI_KEY_LEFT = 263,
+    GUI_KEY_DOWN = 264,
+    GUI_KEY_UP = 265,
+    GUI_KEY_PAGE_UP = 266,
+    GUI_KEY_PAGE_DOWN = 267,
+    GUI_KEY_HOME = 268,
+    GUI_KEY_END = 269,
+    GUI_KEY_LEFT_SHIFT = 340,
+    GUI_KEY_LEFT_CONTROL = 341,
+    GUI_KEY_LEFT_ALT = 342,
+    GUI_KEY_RIGHT_SHIFT = 344,
+    GUI_KEY_RIGHT_CONTROL = 345,
+    GUI_KEY_RIGHT_ALT = 346,
+    GUI_KEY_COUNT = 512,
+} gui_key_t;
+
 // Input state
 typedef struct {
     gui_vec2_t mouse_pos;
@@ -119,18 +243,72 @@ typedef struct {
     bool mouse_clicked[GUI_MOUSE_BUTTON_COUNT];
     bool mouse_released[GUI_MOUSE_BUTTON_COUNT];
     float mouse_wheel;
-    bool keys[512];
-    bool keys_pressed[512];
-    char text_input[32];
+    float mouse_wheel_h;
+    bool keys[GUI_KEY_COUNT];
+    bool keys_pressed[GUI_KEY_COUNT]; // Pressed or repeated this frame
+    char text_input[32];              // UTF-8 text typed this frame
+    double event_time;                // Timestamp of the last consumed input event
 } gui_input_t;
 
+// Input events
+typedef enum {
+    GUI_INPUT_EVENT_MOUSE_POS,
+    GUI_INPUT_EVENT_MOUSE_BUTTON,
+    GUI_INPUT_EVENT_MOUSE_WHEEL,
+    GUI_INPUT_EVENT_KEY,
+    GUI_INPUT_EVENT_TEXT,
+} gui_input_event_type_t;
+
+typedef struct {
+    gui_input_event_type_t type;
+    double timestamp; // Seconds, on the producer's clock
+    union {
+        gui_vec2_t mouse_pos;
+        struct {
+            int button;
+            bool down;
+        } mouse_button;
+        gui_vec2_t mouse_wheel; // x: horizontal, y: vertical
+        struct {
+            int key;
+            bool down; // Repeats are sent as further down events
+        } key;
+        uint32_t codepoint;
+    };
+} gui_input_event_t;
+
+// Lock-free single-producer/single-consumer event ring. One producer thread at a time pushes
+// (typically OS/GLFW callbacks); gui_begin_frame consumes.
+typedef struct {
+    gui_input_event_t events[CGUI_INPUT_QUEUE_SIZE];
+    volatile uint32_t head; // Written by the producer
+    volatile uint32_t tail; // Written by the consumer
+    uint32_t dropped;       // Events rejected because the ring was full (producer side)
+} gui_input_queue_t;
+
 // Layout types
 typedef enum {
     GUI_LAYOUT_NONE,
     GUI_LAYOUT_VBOX,
     GUI_LAYOUT_HBOX,
+    GUI_LAYOUT_FLEX,
 } gui_layout_type_t;
 
+typedef enum {
+    GUI_FLEX_ROW,
+    GUI_FLEX_COLUMN,
+} gui_flex_direction_t;
+
+// Cross-axis alignment of a flex child
+typedef enum {
+    GUI_ALIGN_STRETCH, // Fill the cross axis unless the child has an explicit cross size
+    GUI_ALIGN_START,
+    GUI_ALIGN_CENTER,
+    GUI_ALIGN_END,
+} gui_align_t;
+
+struct gui_flex_cache;
+
 typedef struct {
     gui_layout_type_t type;
     gui_rect_t bounds;
@@ -139,6 +317,15 @@ typedef struct {
     float spacing;
     float item_width;
     float item_height;
+
+    // Flex containers: cached solve, child counter and the pending gui_flex_item parameters
+    struct gui_flex_cache *flex;
+    gui_flex_direction_t direction;
+    int child_count;
+    float item_weight;
+    float item_min;
+    float item_max;
+    gui_align_t item_align;
 } gui_layout_state_t;
 
 // Frame allocator
@@ -148,6 +335,198 @@ typedef struct {
     size_t used;
 } gui_allocator_t;
 
+// Uniform grid over a set of rects: cell c lists the indices of the rects overlapping it in
+// entries[cell_start[c] .. cell_start[c + 1])
+typedef struct {
+    float origin_x, origin_y;
+    float cell_w, cell_h;
+    int cols, rows;
+    uint32_t *cell_start;
+    uint32_t *entries;
+    uint32_t cell_capacity;
+    uint32_t entry_capacity;
+} gui_grid_t;
+
+// Interactive rect recorded for hit testing (id 0 only blocks what lies below it)
+typedef struct {
+    gui_rect_t rect; // Screen space, clipped
+    gui_id_t id;
+    int layer;
+} gui_hit_item_t;
+
+struct gui_cached_block;
+
+// Cached block whose body is running this frame (see gui_begin_cached)
+typedef struct {
+    struct gui_cached_block *block; // NULL when the body runs without being recorded
+    gui_vec2_t origin;
+    gui_rect_t clip;
+    gui_transform_t transform;
+    uint32_t vertex_start;
+    uint32_t index_start;
+    uint32_t hit_start;
+    uint32_t prim_start;
+    uint32_t culled_start;
+    int layout_index; // Parent layout whose cursor movement is recorded, -1 if none
+    float cursor_x, cursor_y;
+    bool layered; // A cached layer was drawn inside: layer commands are not recorded
+} gui_cached_scope_t;
+
+struct gui_cached_layer;
+
+// Persistent per-ID state entry (see gui_get_state)
+typedef struct {
+    gui_id_t id;
+    size_t size;
+    void *data;
+    void (*destructor)(void *data); // Releases resources owned by data (optional)
+    uint64_t last_frame;            // Frame that last requested it (see gui_state_evict)
+} gui_state_entry_t;
+
+// List clipper: visible item range of a uniformly sized, scrolled list
+typedef struct {
+    int item_count;
+    float item_height;
+    int display_start;
+    int display_end;
+} gui_list_clipper_t;
+
+// Table column description
+typedef struct {
+    const char *label;
+    float width;     // Initial width (<= 0 uses style.table_column_width)
+    float min_width; // Lower bound while resizing
+} gui_table_column_t;
+
+// Returns the text of one cell, either written into buf or as a pointer to caller-owned text
+typedef const char *(*gui_table_cell_fn)(void *user_data, int row, int column, char *buf,
+                                         size_t buf_size);
+
+// Table description (nothing is copied; all arrays must stay valid for the call)
+typedef struct {
+    const gui_table_column_t *columns;
+    int column_count;
+    int row_count;
+    const int *row_order; // Optional sort permutation: display row -> data row
+    gui_table_cell_fn cell_text;
+    void *user_data;
+} gui_table_desc_t;
+
+// Writes the children of `node` into `children`, at most `capacity` of them, and returns how
+// many it has; it is called again with enough room when that exceeds capacity
+typedef uint32_t (*gui_tree_children_fn)(void *user_data, uint64_t node, uint64_t *children,
+                                         uint32_t capacity);
+
+// Returns the label of a node like gui_table_cell_fn, and whether it has children (which may
+// be a guess: expanding a node without any just shows nothing below it)
+typedef const char *(*gui_tree_label_fn)(void *user_data, uint64_t node, bool *has_children,
+                                         char *buf, size_t buf_size);
+
+// Tree description. Nodes are caller-defined 64-bit keys; the root itself is not shown.
+typedef struct {
+    uint64_t root;
+    gui_tree_children_fn children;
+    gui_tree_label_fn label;
+    void *user_data;
+    uint32_t version; // Change when the children of expanded nodes change
+} gui_tree_desc_t;
+
+// Node of a gui_node_graph, in canvas units. Dragging a node moves its rect.
+typedef struct {
+    gui_rect_t rect;
+    const char *title;
+} gui_graph_node_t;
+
+// Link from the right edge of node `from` to the left edge of node `to`
+typedef struct {
+    uint32_t from;
+    uint32_t to;
+} gui_graph_link_t;
+
+// Graph description (nothing is copied; the arrays must stay valid for the call)
+typedef struct {
+    gui_graph_node_t *nodes;
+    uint32_t node_count;
+    const gui_graph_link_t *links;
+    uint32_t link_count;
+    uint32_t version; // Change when nodes or links are added, removed or moved by the caller
+} gui_graph_desc_t;
+
+// Run of a text buffer: `length` bytes from `start` in the original text or the added text
+typedef struct {
+    bool added;
+    size_t start;
+    size_t length;
+} gui_text_piece_t;
+
+// Text edited by gui_text_editor, stored as a piece table: the document is the concatenation of
+// its pieces, which reference the original text (never modified) or an append-only buffer of
+// inserted text, so an edit splits or trims at most two pieces and never moves text. Line starts
+// are indexed and kept up to date by each edit. Fields are internal; use the functions below.
+typedef struct {
+    char *original;
+    char *added;
+    size_t added_length;
+    size_t added_capacity;
+    gui_text_piece_t *pieces;
+    uint32_t piece_count;
+    uint32_t piece_capacity;
+    size_t length;
+
+    // Line i starts at line_starts[i], plus line_shift from line_shift_from on: the shift of
+    // the lines after an edit is applied lazily, so repeated edits within a line cost O(1)
+    size_t *line_starts;
+    uint32_t line_count;
+    uint32_t line_capacity;
+    uint32_t line_shift_from;
+    size_t line_shift; // Wraps around for negative shifts
+
+    // Piece found by the last lookup, from which sequential reads continue
+    uint32_t cached_piece;
+    size_t cached_start;
+
+    uint32_t dirty_line; // First line edited since the editor showing the buffer last drew it
+} gui_text_buffer_t;
+
+// Skyline segment of an atlas page: columns [x, x + width) are filled down to row y
+typedef struct {
+    int x;
+    int y;
+    int width;
+} gui_atlas_skyline_t;
+
+// Atlas page, uploaded by the backend as one texture
+typedef struct {
+    uint8_t *pixels;          // RGBA8, rows tightly packed
+    gui_texture_id_t texture; // NULL until first uploaded
+    int dirty_y0;             // Rows [dirty_y0, dirty_y1) changed since the last upload
+    int dirty_y1;
+    gui_atlas_skyline_t *skyline; // Left to right, covering the page width
+    uint32_t skyline_count;
+    uint32_t skyline_capacity;
+} gui_atlas_page_t;
+
+// Packed image: its page and texture coordinates, and its size in pixels
+typedef struct {
+    uint32_t page;
+    gui_vec2_t uv0;
+    gui_vec2_t uv1;
+    float width;
+    float height;
+} gui_atlas_image_t;
+
+typedef struct {
+    int page_width;
+    int page_height;
+    int padding;
+    gui_atlas_page_t *pages;
+    uint32_t page_count;
+    uint32_t page_capacity;
+    gui_atlas_image_t *images;
+    uint32_t image_count;
+    uint32_t image_capacity;
+} gui_atlas_t;
+
 // Style configuration
 typedef struct {
     gui_color_t button_bg;
@@ -158,13 +537,60 @@ typedef struct {
     gui_color_t slider_bg;
     gui_color_t slider_grab;
     gui_color_t slider_grab_active;
+    gui_color_t scrollbar_bg;
+    gui_color_t scrollbar_grab;
+    gui_color_t scrollbar_grab_active;
+    gui_color_t table_bg;
+    gui_color_t table_row_alt_bg;
+    gui_color_t table_header_bg;
+    gui_color_t table_header_bg_hovered;
+    gui_color_t table_border;
+    gui_color_t plot_bg;
+    gui_color_t plot_line;
+    gui_color_t text_highlight; // Behind search matches
     float button_padding;
     float button_rounding;
     float slider_height;
     float slider_grab_size;
     float text_size;
+    float scrollbar_size;
+    float table_cell_padding;
+    float table_column_width;
+    bool anti_aliased_shapes; // 1px alpha fringe on lines, polygons and circles (off by default)
 } gui_style_t;
 
+// Counters for one frame, published by gui_end_frame
+typedef struct {
+    uint32_t vertex_count;
+    uint32_t index_count;
+    uint32_t draw_command_count;
+    uint32_t clip_switches;     // Commands whose clip rect differs from the previous one
+    uint32_t texture_switches;  // Commands whose texture differs from the previous one
+    uint32_t merged_commands;   // Commands merged into an earlier one by reordering
+    uint32_t widget_count;
+    uint32_t hit_item_count;
+    uint32_t culled_primitives; // Skipped for lying entirely outside the clip rect
+    uint32_t cached_blocks;     // gui_begin_cached blocks replayed instead of run
+    uint32_t cached_layers;     // gui_begin_cached_layer layers composited instead of run
+    size_t arena_used;
+    size_t arena_high_water;    // High-water marks are since gui_init
+    uint32_t vertex_high_water;
+    uint32_t index_high_water;
+    float begin_ms;             // CPU time in gui_begin_frame
+    float widgets_ms;           // CPU time between gui_begin_frame and gui_end_frame
+    float end_ms;               // CPU time in gui_end_frame
+    float cpu_ms;               // Sum of the three
+    uint64_t upload_bytes;      // Reported by the backend since the previous gui_end_frame
+    float upload_ms;
+} gui_frame_stats_t;
+
+// Runs task(data, i) for every i below count, possibly concurrently, and returns once all have
+// finished. Supplied by the application (a thread pool); see gui_context_t.deferred.
+typedef void (*gui_parallel_for_fn)(void *pool, uint32_t count,
+                                    void (*task)(void *data, uint32_t index), void *data);
+
+struct gui_deferred_block;
+
 // Main context
 typedef struct {
     // Memory management
@@ -178,22 +604,124 @@ typedef struct {
     gui_draw_cmd_t *draw_commands;
     uint32_t draw_command_count;
 
+#ifdef CGUI_ENABLE_OPAQUE_PASS
+    // Opaque pass, built by gui_end_frame when opaque_pass is set: the untextured triangles
+    // whose vertices all have alpha 255, listed again front-to-back. A depth-testing backend
+    // draws them first so the full list, drawn after, skips every pixel they hide. The lists
+    // are allocated by the first frame that builds them.
+    uint32_t *opaque_indices;
+    uint32_t opaque_index_count;
+    gui_draw_cmd_t *opaque_commands;
+    uint32_t opaque_command_count;
+#endif
+
+    // Primitive being recorded; with opaque_pass set, its depth is stamped when the next one
+    // starts (otherwise vertices carry no depth)
+    uint32_t prim_vertex_start;
+    uint32_t prim_count;
+
+    // Deferred tessellation (off by default): the gui_add_* calls are recorded into the frame
+    // arena and tessellated in gui_end_frame (or earlier, where cached blocks, layers and flex
+    // containers need the vertices), in blocks run through parallel_for when it is set. The
+    // output is identical to immediate drawing.
+    bool deferred;
+    gui_parallel_for_fn parallel_for;
+    void *parallel_pool;
+    struct gui_deferred_block *deferred_head;
+    struct gui_deferred_block *deferred_tail;
+    gui_rect_t deferred_clip; // Clip rect of the last recorded command
+
+    // Command reordering (off by default): gui_end_frame moves each triangle command back over
+    // up to CGUI_REORDER_WINDOW commands whose bounds it does not overlap, into the nearest one
+    // with the same clip rect, texture and transform. What overlaps keeps its order, so the
+    // output looks the same with fewer draw calls.
+    bool reorder_commands;
+
+#ifdef CGUI_ENABLE_OPAQUE_PASS
+    // Opaque pass (off by default): stamps each primitive's depth and builds the opaque lists
+    // in gui_end_frame. Both cost a pass over every vertex and triangle, which pays off only
+    // where fill rate dominates (large overlapping panels); set it before the first frame.
+    // Only compiled with CGUI_ENABLE_OPAQUE_PASS defined (identically in every file including
+    // cgui.h, as it adds gui_vertex_t.depth); without it vertices stay 20 bytes.
+    bool opaque_pass;
+#endif
+
     // Clipping
     gui_rect_t clip_stack[CGUI_MAX_CLIP_STACK];
     int clip_stack_count;
 
+    // Transforms: `transform` is the top of the stack (identity when it is empty) and
+    // cull_rect the current clip rect in its coordinates
+    gui_transform_t transform_stack[CGUI_MAX_TRANSFORM_STACK];
+    int transform_stack_count;
+    gui_transform_t transform;
+    bool transformed;            // transform is not the identity
+    gui_vec2_t screen_mouse_pos; // input.mouse_pos while a transform is pushed
+    gui_rect_t cull_rect;
+
+    // Texture of the primitives being recorded (NULL = untextured)
+    gui_texture_id_t current_texture;
+
     // Layout
     gui_layout_state_t layout_stack[CGUI_MAX_LAYOUT_STACK];
     int layout_stack_count;
 
+    // ID scopes
+    gui_id_t id_stack[CGUI_MAX_ID_STACK];
+    int id_stack_count;
+
+    // Persistent widget state (open addressing, keyed by ID)
+    gui_state_entry_t *state_entries;
+    uint32_t state_capacity;
+    uint32_t state_count;
+
     // Input
     gui_input_t input;
     gui_input_t prev_input;
+    gui_input_queue_t input_queue;
 
     // State
     gui_id_t hot_item;
     gui_id_t active_item;
     gui_id_t focused_item;
+    float drag_offset; // Mouse offset within the active item's grab when it was pressed
+
+    // Hit testing: rects recorded this frame (z = record order within a layer), and last frame's
+    // rects binned into a grid. hovered_item is the topmost of those under the mouse.
+    gui_hit_item_t *hit_items;
+    uint32_t hit_item_count;
+    uint32_t hit_item_capacity;
+    gui_hit_item_t *prev_hit_items;
+    uint32_t prev_hit_item_count;
+    uint32_t prev_hit_item_capacity;
+    gui_grid_t hit_grid;
+    gui_id_t hovered_item;
+    int layer_stack[CGUI_MAX_LAYER_STACK];
+    int layer_stack_count;
+
+    // Cached blocks being recorded
+    gui_cached_scope_t cached_stack[CGUI_MAX_CACHED_STACK];
+    int cached_stack_count;
+
+    // Cached layer being rendered (see gui_begin_cached_layer)
+    struct gui_cached_layer *layer;
+    gui_id_t layer_id;
+    gui_rect_t layer_rect;
+    gui_rect_t layer_parent_clip;
+    uint32_t layer_hit_start;
+    int layer_layout_index; // Parent layout whose cursor movement is recorded, -1 if none
+    float layer_cursor_x, layer_cursor_y;
+    int layer_nesting;      // Open layers drawn directly (nested, in a flex or out of commands)
+    uint32_t layer_epoch;   // Bumped by gui_invalidate_cached_layers
+
+    // Statistics: counters of the frame being built, published frames, pending backend uploads
+    gui_frame_stats_t stats;
+    gui_frame_stats_t stats_history[CGUI_STATS_HISTORY];
+    uint64_t stats_frame_count;
+    double frame_begin_time;
+    double widgets_begin_time;
+    uint64_t pending_upload_bytes;
+    float pending_upload_ms;
     float time;
     float delta_time;
 
@@ -213,7 +741,8 @@ typedef struct {
 // CORE API
 // =============================================================================
 
-// Context management
+// Context management. Contexts share no state (the trace buffers are per thread), so several
+// can run concurrently, each used by one thread at a time.
 void gui_init(gui_context_t *ctx);
 void gui_shutdown(gui_context_t *ctx);
 
@@ -224,6 +753,63 @@ void gui_end_frame(gui_context_t *ctx);
 // Input handling
 void gui_update_input(gui_context_t *ctx, float mouse_x, float mouse_y, const bool *mouse_buttons,
                       float mouse_wheel, float delta_time);
+void gui_update_time(gui_context_t *ctx, float delta_time);
+
+// Input events (producer side). Safe to call from one thread other than the UI thread; the
+// queue is drained by gui_begin_frame, which applies at most one transition per button and
+// key each frame (the rest trickle into later frames) and coalesces mouse moves. Return false
+// when the queue is full.
+bool gui_input_push_event(gui_context_t *ctx, const gui_input_event_t *event);
+bool gui_input_add_mouse_pos(gui_context_t *ctx, float x, float y, double timestamp);
+bool gui_input_add_mouse_button(gui_context_t *ctx, int button, bool down, double timestamp);
+bool gui_input_add_mouse_wheel(gui_context_t *ctx, float dx, float dy, double timestamp);
+bool gui_input_add_key(gui_context_t *ctx, int key, bool down, double timestamp);
+bool gui_input_add_text(gui_context_t *ctx, uint32_t codepoint, double timestamp);
+
+// =============================================================================
+// STATISTICS API
+// =============================================================================
+
+// Statistics of the last completed frame (zeroed before the first gui_end_frame)
+const gui_frame_stats_t *gui_get_frame_stats(const gui_context_t *ctx);
+
+// Called by backends after uploading draw data or textures; attributed to the next frame
+void gui_report_upload(gui_context_t *ctx, uint64_t bytes, float ms);
+
+// Monotonic clock in nanoseconds (arbitrary origin) behind the frame timings and trace zones;
+// backends time their uploads with it too
+uint64_t gui_time_ns(void);
+
+// Metrics panel: last frame's counters plus CPU and upload time over the last
+// CGUI_STATS_HISTORY frames. Placed through the current layout; width <= 0 uses 300.
+void gui_stats_overlay(gui_context_t *ctx, float width);
+
+// =============================================================================
+// TRACE API
+// =============================================================================
+
+// With CGUI_ENABLE_TRACE defined, the frame, its begin/end phases, every widget call and the GL
+// backend's render record timing zones, and GUI_TRACE_BEGIN/GUI_TRACE_END add user zones (e.g.
+// around a panel). Zones go into a lock-free ring per thread; names are kept by pointer, so they
+// must outlive the dump (string literals). Without the macro the zone macros compile to nothing.
+#ifdef CGUI_ENABLE_TRACE
+void gui_trace_begin(const char *name);
+void gui_trace_end(void);
+
+// Writes the zones recorded by all threads as Chrome trace-event JSON, loadable in Perfetto or
+// chrome://tracing. Safe while other threads record, though a ring wrapping during the dump may
+// yield a few torn zones. Returns false if the file cannot be written.
+bool gui_trace_dump(const char *path);
+
+// Frees every thread's ring; no thread may record afterwards
+void gui_trace_shutdown(void);
+
+#define GUI_TRACE_BEGIN(name) gui_trace_begin(name)
+#define GUI_TRACE_END() gui_trace_end()
+#else
+#define GUI_TRACE_BEGIN(name) ((void)0)
+#define GUI_TRACE_END() ((void)0)
+#endif
 
 // =============================================================================
 // LAYOUT API
@@ -240,6 +826,91 @@ void gui_end_hbox(gui_context_t *ctx);
 void gui_same_line(gui_context_t *ctx);
 void gui_spacing(gui_context_t *ctx, float amount);
 
+// Flex container laid out along `direction`. Children are measured at their intrinsic size and
+// placed with last frame's solve; the solve reruns only when a size, weight or the container
+// changes, and children already emitted this frame are then moved to their new positions.
+// Nested in another layout it takes the parent's next rect (x/y ignored); width/height <= 0
+// size it to its content. gui_spacing inside a flex adds an empty child, which becomes a
+// flexible spacer when preceded by gui_flex_item. Only the first CGUI_MAX_FLEX_CHILDREN children
+// are solved; later ones ignore gui_flex_item and are stacked at their own size after them.
+void gui_begin_flex(gui_context_t *ctx, const char *id, gui_flex_direction_t direction, float x,
+                    float y, float width, float height, float padding, float spacing);
+void gui_end_flex(gui_context_t *ctx);
+
+// Parameters for the next flex child. weight > 0 shares the free main-axis space in proportion
+// to the weight, starting from min_size. max_size <= 0 means unbounded.
+void gui_flex_item(gui_context_t *ctx, float weight, float min_size, float max_size,
+                   gui_align_t align);
+
+// Cached block: the widget and draw calls between gui_begin_cached and gui_end_cached are
+// recorded under `id`. While `version` (e.g. a hash of the shown data) is unchanged, later
+// frames replay the recorded vertices, commands and hit rects, moved by the change of origin,
+// and gui_begin_cached returns false: skip the body and do not call gui_end_cached. The body
+// runs again when the block's widgets are hovered, active or focused, when the clip rect shows
+// what was clipped away while recording, or inside a flex container. Nested in another layout
+// the origin is the layout cursor (x/y ignored) and the recorded cursor movement is replayed.
+bool gui_begin_cached(gui_context_t *ctx, const char *id, uint32_t version, float x, float y);
+void gui_end_cached(gui_context_t *ctx);
+
+// Cached layer: the draw calls between gui_begin_cached_layer and gui_end_cached_layer are
+// rendered by the backend into a width x height texture, which later frames composite as one
+// textured quad at (x, y) while gui_begin_cached_layer returns false (skip the body and do not
+// call gui_end_cached_layer; hit rects are replayed). The body runs again when `version` or the
+// size changes, its widgets are hovered, active or focused, the layer was invalidated, or the
+// backend evicted the texture. Content outside the rect is clipped. Nested in another layout
+// the origin is the layout cursor (x/y ignored); inside a flex container or another cached
+// layer the body just draws directly. Recorders and remote viewers only see the composite on
+// cached frames: invalidate all layers each frame while recording or streaming.
+bool gui_begin_cached_layer(gui_context_t *ctx, const char *id, uint32_t version, float x, float y,
+                            float width, float height);
+void gui_end_cached_layer(gui_context_t *ctx);
+
+// Makes the layer (or all layers, e.g. after a DPI change) run its body on its next use. Backends
+// call the former when they drop a layer's texture.
+void gui_invalidate_cached_layer(gui_context_t *ctx, gui_id_t id);
+void gui_invalidate_cached_layers(gui_context_t *ctx);
+
+// Computes the [display_start, display_end) range of items visible in a view of view_height
+// scrolled by scroll pixels
+void gui_list_clipper_begin(gui_list_clipper_t *clipper, int item_count, float item_height,
+                            float scroll, float view_height);
+
+// =============================================================================
+// HIT TESTING API
+// =============================================================================
+
+// Records an interactive rect (clipped to the current clip rect) for this frame and returns
+// whether it was the topmost item under the mouse according to last frame's records. Items in
+// higher layers win; within a layer, later items win. id 0 blocks hover for items below it
+// (e.g. a panel background) without becoming hovered itself.
+bool gui_add_hit_rect(gui_context_t *ctx, gui_id_t id, float x, float y, float w, float h);
+
+// Layers for hit testing; drawing still follows submission order
+void gui_push_layer(gui_context_t *ctx, int layer);
+void gui_pop_layer(gui_context_t *ctx);
+
+// =============================================================================
+// ID & STATE API
+// =============================================================================
+
+// ID scopes: IDs computed inside a scope are seeded with the scope's ID
+void gui_push_id(gui_context_t *ctx, const char *str_id);
+void gui_push_id_int(gui_context_t *ctx, int int_id);
+void gui_pop_id(gui_context_t *ctx);
+gui_id_t gui_get_id(gui_context_t *ctx, const char *str_id);
+
+// Same as gui_push_id/gui_get_id for a string whose gui_hash_string was computed ahead (e.g. at
+// compile time)
+void gui_push_id_hash(gui_context_t *ctx, gui_id_t hash);
+gui_id_t gui_get_id_hash(gui_context_t *ctx, gui_id_t hash);
+
+// Returns zero-initialized storage that persists across frames for the given ID, or NULL when out
+// of memory. The storage is re-zeroed when a different size is requested and freed by
+// gui_shutdown, or earlier once no frame has requested it for CGUI_STATE_MAX_IDLE_FRAMES frames
+// when that is set (then state that must outlive its widget, e.g. a table in a hidden tab, is
+// reset after that long).
+void *gui_get_state(gui_context_t *ctx, gui_id_t id, size_t size);
+
 // =============================================================================
 // WIDGET API
 // =============================================================================
@@ -249,6 +920,100 @@ bool gui_button(gui_context_t *ctx, const char *label, float width, float height
 bool gui_slider_float(gui_context_t *ctx, const char *label, float *value, float min, float max,
                       float width);
 
+// Variants taking the label's length and gui_hash_string (e.g. computed at compile time), so
+// the label is neither measured nor hashed each frame. Labels need no terminating NUL.
+void gui_label_n(gui_context_t *ctx, const char *text, size_t length);
+bool gui_button_ex(gui_context_t *ctx, gui_id_t label_hash, const char *label, size_t length,
+                   float width, float height);
+bool gui_slider_float_ex(gui_context_t *ctx, gui_id_t label_hash, float *value, float min,
+                         float max, float width);
+
+// Image from a backend texture, sized width x height (<= 0 follows the layout like buttons)
+void gui_image(gui_context_t *ctx, gui_texture_id_t texture, float width, float height,
+               gui_vec2_t uv0, gui_vec2_t uv1, gui_color_t tint);
+
+// Image packed into an atlas (see gui_atlas_add), sized width x height (<= 0 for its own size)
+void gui_atlas_image(gui_context_t *ctx, const gui_atlas_t *atlas, int image, float width,
+                     float height, gui_color_t tint);
+
+// Virtualized table with a frozen header row and resizable columns. Only the rows and columns
+// intersecting the view are visited. Returns the column whose header was clicked, or -1.
+int gui_table(gui_context_t *ctx, const char *id, const gui_table_desc_t *desc, float width,
+              float height);
+
+// Virtualized tree. Children are requested only when a node is expanded, and the visible rows
+// are kept as a flat list that toggling a node splices, so each frame visits only the rows in
+// view. Open nodes are remembered in the state store, also while an ancestor is collapsed.
+// Returns true when a click selected a node, which is written to `selected` (may be NULL).
+bool gui_tree_view(gui_context_t *ctx, const char *id, const gui_tree_desc_t *desc,
+                   uint64_t *selected, float width, float height);
+
+// Pannable, zoomable node graph: drag the background to pan, the wheel zooms around the mouse,
+// dragging a node moves it. Nodes and link bounds are binned in a spatial grid that culls the
+// view and finds the node under the mouse, so a frame costs the visible part of the graph.
+// Below CGUI_GRAPH_LOD_ZOOM nodes are plain boxes and links straight lines; otherwise links are
+// bezier curves tessellated by their length on screen. `selected` (may be NULL, UINT32_MAX for
+// none) follows clicks. Returns true when the selection changed or a node moved.
+bool gui_node_graph(gui_context_t *ctx, const char *id, const gui_graph_desc_t *desc,
+                    uint32_t *selected, float width, float height);
+
+// Line plot of `count` floats spaced `stride` bytes apart (0 = tightly packed), decimated with
+// min/max reduction to about two points per horizontal pixel. The reduction is cached per label
+// and only new samples are processed while the array grows append-only; changing values or
+// stride, or shrinking count, rebuilds it. scale_min >= scale_max auto-scales.
+void gui_plot_lines(gui_context_t *ctx, const char *label, const float *values, size_t count,
+                    size_t stride, float scale_min, float scale_max, float width, float height);
+
+// Same for a ring buffer of `capacity` samples into which `total` samples have been written so
+// far (sample i lives at index i % capacity). The last min(total, capacity) samples are plotted.
+void gui_plot_lines_ring(gui_context_t *ctx, const char *label, const float *ring,
+                         size_t capacity, size_t stride, uint64_t total, float scale_min,
+                         float scale_max, float width, float height);
+
+// Scrolling view of newline-separated text that is read in place, never copied: a memory-mapped
+// file (capacity 0) or a ring buffer of `capacity` bytes into which `total` bytes have been
+// written (byte i lives at index i % capacity). Line starts are indexed incrementally, at most
+// CGUI_LOG_SCAN_BUDGET new bytes per frame, keeping one offset per few hundred lines, so large
+// files show at once and the scrollbar grows as they are scanned. Only visible lines are read;
+// occurrences of `highlight` in them are marked (NULL or "" for none). Scrolled to the bottom,
+// the view follows appended text. Changing text or capacity, or shrinking total, rebuilds it.
+void gui_log_view(gui_context_t *ctx, const char *id, const char *text, size_t capacity,
+                  uint64_t total, const char *highlight, float width, float height);
+
+// Text buffers. gui_text_buffer_init copies `text` (which may be NULL); it and the edits return
+// false when out of memory, leaving the buffer unchanged. Offsets are in bytes; lines end at
+// '\n' and a buffer always has at least one line. gui_text_buffer_read copies up to `length`
+// bytes from `offset` and returns the number copied.
+bool gui_text_buffer_init(gui_text_buffer_t *buf, const char *text, size_t length);
+void gui_text_buffer_free(gui_text_buffer_t *buf);
+size_t gui_text_buffer_length(const gui_text_buffer_t *buf);
+uint32_t gui_text_buffer_line_count(const gui_text_buffer_t *buf);
+size_t gui_text_buffer_line_start(const gui_text_buffer_t *buf, uint32_t line);
+uint32_t gui_text_buffer_line_of(const gui_text_buffer_t *buf, size_t offset);
+size_t gui_text_buffer_read(gui_text_buffer_t *buf, size_t offset, size_t length, char *out);
+bool gui_text_buffer_insert(gui_text_buffer_t *buf, size_t offset, const char *text,
+                            size_t length);
+bool gui_text_buffer_erase(gui_text_buffer_t *buf, size_t offset, size_t length);
+
+// Multiline editor for a text buffer. Click to focus; arrows, Home/End, Page Up/Down (with Shift
+// to select, Ctrl+Home/End for the whole text), Ctrl+A, Backspace, Delete, Enter and Tab (four
+// spaces) edit it. Only visible lines are read, drawn and hit-tested, and their text is cached
+// between frames until an edit reaches them, so a buffer should be shown by one editor at a
+// time. Returns true when the text changed this frame.
+bool gui_text_editor(gui_context_t *ctx, const char *id, gui_text_buffer_t *buf, float width,
+                     float height);
+
+// Image atlas: packs small RGBA8 images (icons, thumbnails) into shared page_width x
+// page_height pages, so drawing them does not switch textures. gui_atlas_add copies a width x
+// height image (rows tightly packed) into the first page with room, opening a new page when
+// none has, and returns its handle, or -1 when it does not fit a page or memory runs out. Each
+// image is surrounded by `padding` pixels repeating its edge pixels, so filtering at its edges,
+// including minified sampling, never blends in a neighbour. Pages record the rows changed since
+// the backend last uploaded them (gui_backend_gl_upload_atlas for the GL backend).
+bool gui_atlas_init(gui_atlas_t *atlas, int page_width, int page_height, int padding);
+void gui_atlas_free(gui_atlas_t *atlas);
+int gui_atlas_add(gui_atlas_t *atlas, int width, int height, const void *pixels);
+
 // =============================================================================
 // DRAW API (Low-Level Primitives)
 // =============================================================================
@@ -263,20 +1028,44 @@ void gui_add_line(gui_context_t *ctx, float x1, float y1, float x2, float y2, gu
                   float thickness);
 void gui_add_triangle_filled(gui_context_t *ctx, float x1, float y1, float x2, float y2, float x3,
                              float y3, gui_color_t color);
+void gui_add_polyline(gui_context_t *ctx, const gui_vec2_t *points, int count, gui_color_t color,
+                      float thickness);
+void gui_add_image(gui_context_t *ctx, gui_texture_id_t texture, float x, float y, float w, float h,
+                   gui_vec2_t uv0, gui_vec2_t uv1, gui_color_t tint);
+void gui_add_atlas_image(gui_context_t *ctx, const gui_atlas_t *atlas, int image, float x, float y,
+                         float w, float h, gui_color_t tint);
 
 void gui_add_text(gui_context_t *ctx, const char *text, float x, float y, gui_color_t color,
                   float font_size);
+void gui_add_text_n(gui_context_t *ctx, const char *text, size_t length, float x, float y,
+                    gui_color_t color, float font_size);
 
 // Clipping
 void gui_push_clip_rect(gui_context_t *ctx, float x, float y, float w, float h,
                         bool intersect_with_current);
 void gui_pop_clip_rect(gui_context_t *ctx);
 
+// Transform stack. gui_push_transform applies `transform` inside the current one. Draw commands
+// carry the current transform and the backend applies it to their vertices, so content recorded
+// in local coordinates (a cached block, say) pans and zooms without being tessellated or
+// uploaded again. Clip rects, hit rects and culling follow the transform, and while one is
+// pushed input.mouse_pos is in local coordinates. Rotated clip rects clip to their bounds.
+void gui_push_transform(gui_context_t *ctx, gui_transform_t transform);
+void gui_pop_transform(gui_context_t *ctx);
+gui_transform_t gui_transform_identity(void);
+gui_transform_t gui_transform_translate(float x, float y);
+gui_transform_t gui_transform_scale(float sx, float sy);
+gui_transform_t gui_transform_rotate(float radians);
+gui_transform_t gui_transform_multiply(gui_transform_t outer, gui_transform_t inner);
+gui_transform_t gui_transform_invert(gui_transform_t transform); // Identity when singular
+gui_vec2_t gui_transform_point(gui_transform_t transform, gui_vec2_t point);
+
 // =============================================================================
 // UTILITY FUNCTIONS
 // =============================================================================
 
 gui_id_t gui_hash_string(const char *str);
+gui_id_t gui_combine_id(gui_id_t seed, gui_id_t id);
 gui_color_t gui_color_from_rgba(uint8_t r, uint8_t g, uint8_t b, uint8_t a);
 bool gui_rect_contains(gui_rect_t rect, float x, float y);
 
@@ -290,6 +1079,40 @@ bool gui_rect_contains(gui_rect_t rect, float x, float y);
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+// Heap hooks: define all four before the implementation to route the library's allocations
+#ifndef CGUI_MALLOC
+#define CGUI_MALLOC(size) malloc(size)
+#define CGUI_CALLOC(count, size) calloc(count, size)
+#define CGUI_REALLOC(ptr, size) realloc(ptr, size)
+#define CGUI_FREE(ptr) free(ptr)
+#endif
+
+// =============================================================================
+// ATOMICS
+// =============================================================================
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+static uint32_t gui_atomic_load_acquire(volatile uint32_t *ptr) {
+    return (uint32_t)_InterlockedOr((volatile long *)ptr, 0);
+}
+static void gui_atomic_store_release(volatile uint32_t *ptr, uint32_t value) {
+    _InterlockedExchange((volatile long *)ptr, (long)value);
+}
+#else
+static uint32_t gui_atomic_load_acquire(volatile uint32_t *ptr) {
+    return __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+}
+static void gui_atomic_store_release(volatile uint32_t *ptr, uint32_t value) {
+    __atomic_store_n(ptr, value, __ATOMIC_RELEASE);
+}
+#endif
 
 // =============================================================================
 // FRAME ALLOCATOR
@@ -297,6 +1120,16 @@ bool gui_rect_contains(gui_rect_t rect, float x, float y);
 
 static void gui_reset_allocator(gui_allocator_t *alloc) { alloc->used = 0; }
 
+// Bump allocation valid until the next gui_begin_frame. Returns NULL when the arena is full.
+static void *gui_alloc(gui_allocator_t *alloc, size_t size) {
+    size_t offset = (alloc->used + 15U) & ~(size_t)15U;
+    if (offset + size > alloc->size) {
+        return NULL;
+    }
+    alloc->used = offset + size;
+    return alloc->buffer + offset;
+}
+
 // =============================================================================
 // UTILITY FUNCTIONS
 // =============================================================================
@@ -310,6 +1143,15 @@ gui_id_t gui_hash_string(const char *str) {
     return hash;
 }
 
+gui_id_t gui_combine_id(gui_id_t seed, gui_id_t id) {
+    gui_id_t hash = seed;
+    for (int i = 0; i < 4; i++) {
+        hash ^= (id >> (i * 8)) & 0xFFU;
+        hash *= 16777619U;
+    }
+    return hash;
+}
+
 gui_color_t gui_color_from_rgba(uint8_t r, uint8_t g, uint8_t b, uint8_t a) {
     gui_color_t col = {r, g, b, a};
     return col;
@@ -329,559 +1171,5684 @@ static gui_rect_t gui_intersect_rects(gui_rect_t a, gui_rect_t b) {
     return result;
 }
 
-static float gui_text_width(const char *text, float font_size) {
+// Smallest rect containing both; empty rects are ignored
+static gui_rect_t gui_union_rects(gui_rect_t a, gui_rect_t b) {
+    if (a.w <= 0.0F || a.h <= 0.0F) {
+        return b;
+    }
+    if (b.w <= 0.0F || b.h <= 0.0F) {
+        return a;
+    }
+    float x1 = fminf(a.x, b.x);
+    float y1 = fminf(a.y, b.y);
+    gui_rect_t result = {x1, y1, fmaxf(a.x + a.w, b.x + b.w) - x1,
+                         fmaxf(a.y + a.h, b.y + b.h) - y1};
+    return result;
+}
+
+static float gui_text_width_n(size_t length, float font_size) {
     // Simple monospace approximation for MVP
-    return (float)strlen(text) * font_size * 0.6F;
+    return (float)length * font_size * 0.6F;
+}
+
+static float gui_clampf(float v, float lo, float hi) { return fminf(fmaxf(v, lo), hi); }
+
+static bool gui_rects_equal(gui_rect_t a, gui_rect_t b) {
+    return a.x == b.x && a.y == b.y && a.w == b.w && a.h == b.h;
 }
 
 // =============================================================================
-// CONTEXT MANAGEMENT
+// TRANSFORMS
 // =============================================================================
 
-void gui_init(gui_context_t *ctx) {
-    memset(ctx, 0, sizeof(gui_context_t));
+gui_transform_t gui_transform_identity(void) {
+    return (gui_transform_t){{1.0F, 0.0F, 0.0F, 1.0F, 0.0F, 0.0F}};
+}
 
-    // Allocate frame buffer
-    ctx->allocator.size = (size_t)CGUI_FRAME_ALLOCATOR_SIZE;
-    ctx->allocator.buffer = (uint8_t *)malloc(ctx->allocator.size);
-    ctx->allocator.used = 0;
+gui_transform_t gui_transform_translate(float x, float y) {
+    return (gui_transform_t){{1.0F, 0.0F, 0.0F, 1.0F, x, y}};
+}
 
-    // Allocate draw buffers
-    ctx->vertices = (gui_vertex_t *)malloc(sizeof(gui_vertex_t) * CGUI_MAX_VERTICES);
-    ctx->indices = (uint32_t *)malloc(sizeof(uint32_t) * CGUI_MAX_INDICES);
-    ctx->draw_commands = (gui_draw_cmd_t *)malloc(sizeof(gui_draw_cmd_t) * CGUI_MAX_DRAW_COMMANDS);
+gui_transform_t gui_transform_scale(float sx, float sy) {
+    return (gui_transform_t){{sx, 0.0F, 0.0F, sy, 0.0F, 0.0F}};
+}
 
-    // Initialize style (modern flat design)
-    ctx->style.button_bg = gui_color_from_rgba(70, 130, 180, 255);
-    ctx->style.button_bg_hovered = gui_color_from_rgba(90, 150, 200, 255);
-    ctx->style.button_bg_active = gui_color_from_rgba(50, 110, 160, 255);
-    ctx->style.button_text = GUI_COLOR_WHITE;
-    ctx->style.text = gui_color_from_rgba(240, 240, 240, 255);
-    ctx->style.slider_bg = gui_color_from_rgba(60, 60, 60, 255);
-    ctx->style.slider_grab = gui_color_from_rgba(70, 130, 180, 255);
-    ctx->style.slider_grab_active = gui_color_from_rgba(90, 150, 200, 255);
-    ctx->style.button_padding = 8.0F;
-    ctx->style.button_rounding = 4.0F;
-    ctx->style.slider_height = 20.0F;
-    ctx->style.slider_grab_size = 16.0F;
-    ctx->style.text_size = 14.0F;
+gui_transform_t gui_transform_rotate(float radians) {
+    float c = cosf(radians);
+    float s = sinf(radians);
+    return (gui_transform_t){{c, s, -s, c, 0.0F, 0.0F}};
+}
 
-    ctx->font_size = 14.0F;
+gui_transform_t gui_transform_multiply(gui_transform_t outer, gui_transform_t inner) {
+    const float *a = outer.m;
+    const float *b = inner.m;
+    return (gui_transform_t){{(a[0] * b[0]) + (a[2] * b[1]), (a[1] * b[0]) + (a[3] * b[1]),
+                              (a[0] * b[2]) + (a[2] * b[3]), (a[1] * b[2]) + (a[3] * b[3]),
+                              (a[0] * b[4]) + (a[2] * b[5]) + a[4],
+                              (a[1] * b[4]) + (a[3] * b[5]) + a[5]}};
 }
 
-void gui_shutdown(gui_context_t *ctx) {
-    if (ctx->allocator.buffer) {
-        free(ctx->allocator.buffer);
+gui_transform_t gui_transform_invert(gui_transform_t transform) {
+    const float *m = transform.m;
+    float det = (m[0] * m[3]) - (m[1] * m[2]);
+    if (det == 0.0F) {
+        return gui_transform_identity();
     }
-    if (ctx->vertices) {
-        free(ctx->vertices);
-    }
-    if (ctx->indices) {
-        free(ctx->indices);
-    }
-    if (ctx->draw_commands) {
-        free(ctx->draw_commands);
-    }
-    memset(ctx, 0, sizeof(gui_context_t));
+    float inv = 1.0F / det;
+    float a = m[3] * inv;
+    float b = -m[1] * inv;
+    float c = -m[2] * inv;
+    float d = m[0] * inv;
+    return (gui_transform_t){{a, b, c, d, -((a * m[4]) + (c * m[5])), -((b * m[4]) + (d * m[5]))}};
 }
 
-void gui_begin_frame(gui_context_t *ctx, float display_width, float display_height) {
-    ctx->display_width = display_width;
-    ctx->display_height = display_height;
+gui_vec2_t gui_transform_point(gui_transform_t transform, gui_vec2_t point) {
+    const float *m = transform.m;
+    return (gui_vec2_t){(m[0] * point.x) + (m[2] * point.y) + m[4],
+                        (m[1] * point.x) + (m[3] * point.y) + m[5]};
+}
 
-    // Reset allocator
-    gui_reset_allocator(&ctx->allocator);
+static bool gui_transforms_equal(const gui_transform_t *a, const gui_transform_t *b) {
+    return memcmp(a->m, b->m, sizeof(a->m)) == 0;
+}
 
-    // Reset draw data
-    ctx->vertex_count = 0;
-    ctx->index_count = 0;
-    ctx->draw_command_count = 0;
+// Bounds of a transformed rect
+static gui_rect_t gui_transform_rect(const gui_transform_t *transform, gui_rect_t rect) {
+    const float *m = transform->m;
+    if (m[0] == 1.0F && m[1] == 0.0F && m[2] == 0.0F && m[3] == 1.0F) {
+        return (gui_rect_t){rect.x + m[4], rect.y + m[5], rect.w, rect.h}; // Exact
+    }
+    gui_vec2_t p = gui_transform_point(*transform, (gui_vec2_t){rect.x, rect.y});
+    float ax = m[0] * rect.w;
+    float ay = m[1] * rect.w;
+    float bx = m[2] * rect.h;
+    float by = m[3] * rect.h;
+    float x0 = p.x + fminf(ax, 0.0F) + fminf(bx, 0.0F);
+    float y0 = p.y + fminf(ay, 0.0F) + fminf(by, 0.0F);
+    return (gui_rect_t){x0, y0, fabsf(ax) + fabsf(bx), fabsf(ay) + fabsf(by)};
+}
 
-    // Reset layout stack
-    ctx->layout_stack_count = 0;
+// =============================================================================
+// ID STACK & STATE STORAGE
+// =============================================================================
 
-    // Reset clip stack
-    ctx->clip_stack_count = 0;
-    gui_rect_t full_screen = {0, 0, display_width, display_height};
-    ctx->clip_stack[ctx->clip_stack_count++] = full_screen;
+void gui_push_id(gui_context_t *ctx, const char *str_id) {
+    if (ctx->id_stack_count >= CGUI_MAX_ID_STACK) {
+        return;
+    }
+    gui_id_t id = gui_get_id(ctx, str_id);
+    ctx->id_stack[ctx->id_stack_count++] = id;
+}
 
-    // Update input state
-    ctx->prev_input = ctx->input;
-    for (int i = 0; i < GUI_MOUSE_BUTTON_COUNT; i++) {
-        ctx->input.mouse_clicked[i] = ctx->input.mouse_down[i] && !ctx->prev_input.mouse_down[i];
-        ctx->input.mouse_released[i] = !ctx->input.mouse_down[i] && ctx->prev_input.mouse_down[i];
+void gui_push_id_hash(gui_context_t *ctx, gui_id_t hash) {
+    if (ctx->id_stack_count >= CGUI_MAX_ID_STACK) {
+        return;
     }
+    gui_id_t id = gui_get_id_hash(ctx, hash);
+    ctx->id_stack[ctx->id_stack_count++] = id;
+}
 
-    // Clear hot item if no active item
-    if (ctx->active_item == 0) {
-        ctx->hot_item = 0;
+void gui_push_id_int(gui_context_t *ctx, int int_id) {
+    if (ctx->id_stack_count >= CGUI_MAX_ID_STACK) {
+        return;
     }
+    gui_id_t seed = (ctx->id_stack_count > 0) ? ctx->id_stack[ctx->id_stack_count - 1] : 0;
+    ctx->id_stack[ctx->id_stack_count++] = gui_combine_id(seed, (gui_id_t)int_id);
 }
 
-void gui_end_frame(gui_context_t *ctx) {
-    // Create a single draw command for all geometry
-    if (ctx->index_count > 0 && ctx->draw_command_count < CGUI_MAX_DRAW_COMMANDS) {
-        gui_draw_cmd_t *cmd = &ctx->draw_commands[ctx->draw_command_count++];
-        cmd->type = GUI_DRAW_CMD_TRIANGLES;
-        cmd->texture = NULL;
-        cmd->idx_offset = 0;
-        cmd->elem_count = ctx->index_count;
-        cmd->clip_rect = ctx->clip_stack[ctx->clip_stack_count - 1];
+void gui_pop_id(gui_context_t *ctx) {
+    if (ctx->id_stack_count > 0) {
+        ctx->id_stack_count--;
     }
 }
 
-void gui_update_input(gui_context_t *ctx, float mouse_x, float mouse_y, const bool *mouse_buttons,
-                      float mouse_wheel, float delta_time) {
-    ctx->input.mouse_pos.x = mouse_x;
-    ctx->input.mouse_pos.y = mouse_y;
+gui_id_t gui_get_id(gui_context_t *ctx, const char *str_id) {
+    return gui_get_id_hash(ctx, gui_hash_string(str_id));
+}
 
-    for (int i = 0; i < GUI_MOUSE_BUTTON_COUNT; i++) {
-        ctx->input.mouse_down[i] = mouse_buttons[i];
+gui_id_t gui_get_id_hash(gui_context_t *ctx, gui_id_t hash) {
+    if (ctx->id_stack_count == 0) {
+        return hash;
+    }
+    return gui_combine_id(ctx->id_stack[ctx->id_stack_count - 1], hash);
+}
+
+// Returns false, keeping the current table, when the larger one cannot be allocated
+static bool gui_state_grow(gui_context_t *ctx) {
+    uint32_t old_capacity = ctx->state_capacity;
+    gui_state_entry_t *old_entries = ctx->state_entries;
+    uint32_t capacity =
+        (old_capacity > 0) ? old_capacity * 2 : (uint32_t)CGUI_STATE_STORAGE_INITIAL_CAPACITY;
+    gui_state_entry_t *entries =
+        (gui_state_entry_t *)CGUI_CALLOC(capacity, sizeof(gui_state_entry_t));
+    if (!entries) {
+        return false;
     }
+    ctx->state_capacity = capacity;
+    ctx->state_entries = entries;
 
-    ctx->input.mouse_wheel = mouse_wheel;
-    ctx->delta_time = delta_time;
-    ctx->time += delta_time;
+    uint32_t mask = ctx->state_capacity - 1;
+    for (uint32_t i = 0; i < old_capacity; i++) {
+        if (old_entries[i].id == 0) {
+            continue;
+        }
+        uint32_t slot = old_entries[i].id & mask;
+        while (ctx->state_entries[slot].id != 0) {
+            slot = (slot + 1) & mask;
+        }
+        ctx->state_entries[slot] = old_entries[i];
+    }
+    CGUI_FREE(old_entries);
+    return true;
 }
 
-// =============================================================================
-// LAYOUT SYSTEM
-// =============================================================================
+static void gui_state_entry_release(gui_state_entry_t *entry) {
+    if (entry->destructor && entry->data) {
+        entry->destructor(entry->data);
+    }
+    CGUI_FREE(entry->data);
+}
 
-static gui_layout_state_t *gui_get_current_layout(gui_context_t *ctx) {
-    if (ctx->layout_stack_count == 0) {
-        return NULL;
+// Slot holding id, or the empty slot where it would go
+static gui_state_entry_t *gui_state_slot(gui_context_t *ctx, gui_id_t id) {
+    uint32_t mask = ctx->state_capacity - 1;
+    uint32_t slot = id & mask;
+    while (ctx->state_entries[slot].id != 0 && ctx->state_entries[slot].id != id) {
+        slot = (slot + 1) & mask;
     }
-    return &ctx->layout_stack[ctx->layout_stack_count - 1];
+    return &ctx->state_entries[slot];
 }
 
-void gui_begin_vbox(gui_context_t *ctx, float x, float y, float width, float padding,
-                    float spacing) {
-    if (ctx->layout_stack_count >= CGUI_MAX_LAYOUT_STACK) {
-        return;
+static void *gui_get_state_ex(gui_context_t *ctx, gui_id_t id, size_t size,
+                              void (*destructor)(void *data)) {
+    if (id == 0) {
+        id = 1; // 0 marks empty slots
     }
 
-    gui_layout_state_t *layout = &ctx->layout_stack[ctx->layout_stack_count++];
-    layout->type = GUI_LAYOUT_VBOX;
-    layout->bounds.x = x;
-    layout->bounds.y = y;
-    layout->bounds.w = width;
-    layout->cursor_x = x + padding;
-    layout->cursor_y = y + padding;
-    layout->padding = padding;
-    layout->spacing = spacing;
-    layout->item_width = width - (padding * 2.0F);
+    gui_state_entry_t *entry = (ctx->state_capacity > 0) ? gui_state_slot(ctx, id) : NULL;
+    if (!entry || entry->id == 0) {
+        // Keep the load factor below 3/4; failing that, probing only needs one slot left empty
+        if ((ctx->state_count + 1) * 4 > ctx->state_capacity * 3) {
+            if (gui_state_grow(ctx)) {
+                entry = gui_state_slot(ctx, id);
+            } else if (ctx->state_count + 1 >= ctx->state_capacity) {
+                return NULL;
+            }
+        }
+        entry->id = id;
+        ctx->state_count++;
+    }
+    if (entry->size != size || !entry->data) {
+        gui_state_entry_release(entry);
+        entry->data = CGUI_CALLOC(1, size);
+        entry->size = size;
+    }
+    entry->destructor = destructor;
+    entry->last_frame = ctx->stats_frame_count;
+    return entry->data;
 }
 
-void gui_end_vbox(gui_context_t *ctx) {
-    if (ctx->layout_stack_count > 0) {
-        ctx->layout_stack_count--;
+void *gui_get_state(gui_context_t *ctx, gui_id_t id, size_t size) {
+    return gui_get_state_ex(ctx, id, size, NULL);
+}
+
+// With CGUI_STATE_MAX_IDLE_FRAMES set, frees the state of IDs no frame requested for that many
+// frames (widgets that are no longer drawn). Called by gui_end_frame; sweeps the table once every
+// that many frames.
+static void gui_state_evict(gui_context_t *ctx) {
+#if CGUI_STATE_MAX_IDLE_FRAMES > 0
+    uint64_t frame = ctx->stats_frame_count;
+    if (ctx->state_count == 0 || frame % CGUI_STATE_MAX_IDLE_FRAMES != 0) {
+        return;
+    }
+    uint32_t evicted = 0;
+    uint32_t empty = 0; // A slot that was empty before the sweep (the load factor leaves one)
+    for (uint32_t i = 0; i < ctx->state_capacity; i++) {
+        gui_state_entry_t *entry = &ctx->state_entries[i];
+        if (entry->id == 0) {
+            empty = i;
+        } else if (frame - entry->last_frame >= CGUI_STATE_MAX_IDLE_FRAMES) {
+            gui_state_entry_release(entry);
+            memset(entry, 0, sizeof(gui_state_entry_t));
+            evicted++;
+        }
+    }
+    if (evicted == 0) {
+        return;
+    }
+    ctx->state_count -= evicted;
+
+    // Reinsert the survivors so that no probe sequence stops at a freed slot. No probe sequence
+    // crossed the slot that was already empty, so starting after it every entry can only move
+    // back toward its home slot, over slots already settled.
+    uint32_t mask = ctx->state_capacity - 1;
+    for (uint32_t n = 1; n < ctx->state_capacity; n++) {
+        uint32_t i = (empty + n) & mask;
+        gui_state_entry_t entry = ctx->state_entries[i];
+        if (entry.id == 0) {
+            continue;
+        }
+        memset(&ctx->state_entries[i], 0, sizeof(gui_state_entry_t));
+        uint32_t slot = entry.id & mask;
+        while (ctx->state_entries[slot].id != 0) {
+            slot = (slot + 1) & mask;
+        }
+        ctx->state_entries[slot] = entry;
     }
+#else
+    (void)ctx;
+#endif
 }
 
-void gui_begin_hbox(gui_context_t *ctx, float x, float y, float height, float padding,
-                    float spacing) {
-    if (ctx->layout_stack_count >= CGUI_MAX_LAYOUT_STACK) {
+static void gui_state_free_all(gui_context_t *ctx) {
+    for (uint32_t i = 0; i < ctx->state_capacity; i++) {
+        gui_state_entry_release(&ctx->state_entries[i]);
+    }
+    CGUI_FREE(ctx->state_entries);
+}
+
+// =============================================================================
+// DRAW COMMANDS
+// =============================================================================
+
+static bool gui_draw_cmd_matches(const gui_draw_cmd_t *cmd, gui_rect_t clip,
+                                 gui_texture_id_t texture, const gui_transform_t *transform) {
+    return cmd->type == GUI_DRAW_CMD_TRIANGLES && cmd->texture == texture &&
+           gui_rects_equal(cmd->clip_rect, clip) &&
+           gui_transforms_equal(&cmd->transform, transform);
+}
+
+// Closes the open command and opens a new one when the clip rect, texture or transform differs
+// from its state. Consecutive primitives sharing the same state are batched into one command.
+static void gui_set_draw_cmd_state(gui_context_t *ctx, gui_rect_t clip, gui_texture_id_t texture,
+                                   const gui_transform_t *transform) {
+    if (ctx->draw_command_count > 0 &&
+        ctx->draw_commands[ctx->draw_command_count - 1].type == GUI_DRAW_CMD_TRIANGLES) {
+        gui_draw_cmd_t *last = &ctx->draw_commands[ctx->draw_command_count - 1];
+        last->elem_count = ctx->index_count - last->idx_offset;
+
+        if (gui_draw_cmd_matches(last, clip, texture, transform)) {
+            return;
+        }
+
+        if (last->elem_count == 0) {
+            // Nothing was drawn with the previous state: drop it, and merge back into the
+            // command before it if the state matches again (e.g. an empty push/pop pair)
+            gui_draw_cmd_t *prev =
+                (ctx->draw_command_count > 1) ? &ctx->draw_commands[ctx->draw_command_count - 2]
+                                              : NULL;
+            if (prev && gui_draw_cmd_matches(prev, clip, texture, transform)) {
+                ctx->draw_command_count--;
+            } else {
+                last->clip_rect = clip;
+                last->texture = texture;
+                last->transform = *transform;
+            }
+            return;
+        }
+    }
+
+    if (ctx->draw_command_count >= CGUI_MAX_DRAW_COMMANDS) {
+        return; // Out of commands: keep appending to the last one
+    }
+
+    gui_draw_cmd_t *cmd = &ctx->draw_commands[ctx->draw_command_count++];
+    cmd->type = GUI_DRAW_CMD_TRIANGLES;
+    cmd->texture = texture;
+    cmd->idx_offset = ctx->index_count;
+    cmd->elem_count = 0;
+    cmd->clip_rect = clip;
+    cmd->transform = *transform;
+}
+
+static void gui_deferred_flush(gui_context_t *ctx);
+
+// Follows the clip stack, the current texture and the transform stack. While deferred draws are
+// pending, their flush builds the commands instead.
+static void gui_update_draw_cmd(gui_context_t *ctx) {
+    if (ctx->deferred_head) {
         return;
     }
+    gui_set_draw_cmd_state(ctx, ctx->clip_stack[ctx->clip_stack_count - 1], ctx->current_texture,
+                           &ctx->transform);
+}
 
-    gui_layout_state_t *layout = &ctx->layout_stack[ctx->layout_stack_count++];
-    layout->type = GUI_LAYOUT_HBOX;
-    layout->bounds.x = x;
-    layout->bounds.y = y;
-    layout->bounds.h = height;
-    layout->cursor_x = x + padding;
-    layout->cursor_y = y + padding;
-    layout->padding = padding;
-    layout->spacing = spacing;
-    layout->item_height = height - (padding * 2.0F);
+// Appends a layer command covering the next `elem_count` indices, which the caller writes
+// next, in screen space. It is never batched: the primitives after it open a new command.
+static bool gui_push_layer_cmd(gui_context_t *ctx, gui_draw_cmd_type_t type, gui_id_t layer,
+                               gui_rect_t clip, uint32_t elem_count) {
+    gui_deferred_flush(ctx);
+    if (ctx->draw_command_count > 0) {
+        gui_draw_cmd_t *last = &ctx->draw_commands[ctx->draw_command_count - 1];
+        if (last->type == GUI_DRAW_CMD_TRIANGLES) {
+            last->elem_count = ctx->index_count - last->idx_offset;
+            if (last->elem_count == 0) {
+                ctx->draw_command_count--; // Reuse the empty command
+            }
+        }
+    }
+    if (ctx->draw_command_count + 1 >= CGUI_MAX_DRAW_COMMANDS) {
+        return false; // Keep room for the command that follows
+    }
+    ctx->draw_commands[ctx->draw_command_count++] =
+        (gui_draw_cmd_t){type, (gui_texture_id_t)(uintptr_t)layer, ctx->index_count, elem_count,
+                         clip, gui_transform_identity()};
+    return true;
 }
 
-void gui_end_hbox(gui_context_t *ctx) {
-    if (ctx->layout_stack_count > 0) {
-        ctx->layout_stack_count--;
+// Depth difference between consecutive primitives: a few steps of a 24-bit depth buffer, so
+// 2^20 primitives fit in [0, 1]
+#define GUI_DEPTH_STEP (1.0F / 1048576.0F)
+
+// Vertex with its depth (when compiled in) left at 0 until the primitive is closed
+static inline gui_vertex_t gui_vertex(float x, float y, float u, float v, gui_color_t col) {
+    gui_vertex_t vertex = {0};
+    vertex.pos = (gui_vec2_t){x, y};
+    vertex.uv = (gui_vec2_t){u, v};
+    vertex.col = col;
+    return vertex;
+}
+
+// Ends the primitive recorded since the last call by stamping its depth (with opaque_pass set),
+// after tessellating any deferred draws. Called by gui_prim_reserve before each primitive starts
+// and by gui_end_frame.
+static inline void gui_prim_close(gui_context_t *ctx) {
+    if (ctx->deferred_head) {
+        gui_deferred_flush(ctx);
+    }
+    uint32_t start = ctx->prim_vertex_start;
+    ctx->prim_vertex_start = ctx->vertex_count;
+    if (ctx->vertex_count == start) {
+        return;
+    }
+    ctx->prim_count++;
+#ifdef CGUI_ENABLE_OPAQUE_PASS
+    if (!ctx->opaque_pass) {
+        return;
+    }
+    float depth = fmaxf(1.0F - ((float)ctx->prim_count * GUI_DEPTH_STEP), 0.0F);
+    for (uint32_t i = start; i < ctx->vertex_count; i++) {
+        ctx->vertices[i].depth = depth;
     }
+#endif
 }
 
-void gui_spacing(gui_context_t *ctx, float amount) {
-    gui_layout_state_t *layout = gui_get_current_layout(ctx);
-    if (!layout) {
+// Collects the opaque pass from the final command list (after layouts moved their children),
+// walking commands and triangles backwards so the nearest come first. Triangles left out
+// (including when the opaque lists are full) are still drawn by the full list, just without
+// hiding what is behind them in advance.
+#ifdef CGUI_ENABLE_OPAQUE_PASS
+static void gui_opaque_build(gui_context_t *ctx) {
+    ctx->opaque_index_count = 0;
+    ctx->opaque_command_count = 0;
+    if (!ctx->opaque_indices) {
+        ctx->opaque_indices = (uint32_t *)CGUI_MALLOC(sizeof(uint32_t) * CGUI_MAX_INDICES);
+        ctx->opaque_commands =
+            (gui_draw_cmd_t *)CGUI_MALLOC(sizeof(gui_draw_cmd_t) * CGUI_MAX_DRAW_COMMANDS);
+    }
+    if (!ctx->opaque_indices || !ctx->opaque_commands) {
+        return; // Retried next frame; the full list still draws everything
+    }
+    bool in_layer = false; // Layer content goes to the layer's texture, not the screen
+    for (uint32_t c = ctx->draw_command_count; c-- > 0;) {
+        const gui_draw_cmd_t *src = &ctx->draw_commands[c];
+        if (src->type == GUI_DRAW_CMD_LAYER_END || src->type == GUI_DRAW_CMD_LAYER_BEGIN) {
+            in_layer = src->type == GUI_DRAW_CMD_LAYER_END;
+        }
+        if (in_layer || src->type != GUI_DRAW_CMD_TRIANGLES || src->texture != NULL) {
+            continue;
+        }
+        gui_draw_cmd_t *cmd = (ctx->opaque_command_count > 0)
+                                  ? &ctx->opaque_commands[ctx->opaque_command_count - 1]
+                                  : NULL;
+        for (uint32_t t = src->elem_count / 3U; t-- > 0;) {
+            const uint32_t *tri = &ctx->indices[src->idx_offset + (t * 3U)];
+            if (ctx->vertices[tri[0]].col.a != 255 || ctx->vertices[tri[1]].col.a != 255 ||
+                ctx->vertices[tri[2]].col.a != 255) {
+                continue;
+            }
+            if (!cmd || !gui_rects_equal(cmd->clip_rect, src->clip_rect) ||
+                !gui_transforms_equal(&cmd->transform, &src->transform)) {
+                if (ctx->opaque_command_count >= CGUI_MAX_DRAW_COMMANDS) {
+                    return;
+                }
+                cmd = &ctx->opaque_commands[ctx->opaque_command_count++];
+                *cmd = (gui_draw_cmd_t){GUI_DRAW_CMD_TRIANGLES, NULL, ctx->opaque_index_count, 0,
+                                        src->clip_rect, src->transform};
+            }
+            memcpy(&ctx->opaque_indices[ctx->opaque_index_count], tri, 3U * sizeof(uint32_t));
+            ctx->opaque_index_count += 3U;
+            cmd->elem_count += 3U;
+        }
+    }
+}
+#endif
+
+// Screen bounds of a triangle command: its vertices (through its transform) within its clip rect
+static gui_rect_t gui_draw_cmd_bounds(const gui_context_t *ctx, const gui_draw_cmd_t *cmd) {
+    if (cmd->elem_count == 0) {
+        return (gui_rect_t){0};
+    }
+    float x0 = INFINITY;
+    float y0 = INFINITY;
+    float x1 = -INFINITY;
+    float y1 = -INFINITY;
+    for (uint32_t i = 0; i < cmd->elem_count; i++) {
+        gui_vec2_t pos = ctx->vertices[ctx->indices[cmd->idx_offset + i]].pos;
+        x0 = fminf(x0, pos.x);
+        y0 = fminf(y0, pos.y);
+        x1 = fmaxf(x1, pos.x);
+        y1 = fmaxf(y1, pos.y);
+    }
+    gui_rect_t rect = {x0, y0, x1 - x0, y1 - y0};
+    gui_transform_t identity = gui_transform_identity();
+    if (!gui_transforms_equal(&cmd->transform, &identity)) {
+        rect = gui_transform_rect(&cmd->transform, rect);
+    }
+    return gui_intersect_rects(rect, cmd->clip_rect);
+}
+
+static bool gui_rects_overlap(gui_rect_t a, gui_rect_t b) {
+    return a.w > 0.0F && a.h > 0.0F && b.w > 0.0F && b.h > 0.0F && a.x < b.x + b.w &&
+           b.x < a.x + a.w && a.y < b.y + b.h && b.y < a.y + a.h;
+}
+
+// Merges triangle commands with the same state across commands they do not overlap (see
+// gui_context_t.reorder_commands), then rewrites the index buffer in the new order. Other
+// command types (layers, clip changes) are not moved over. Scratch comes from the frame arena;
+// the pass is skipped when it does not fit.
+static void gui_reorder_commands(gui_context_t *ctx) {
+    uint32_t count = ctx->draw_command_count;
+    if (count < 3) {
+        return;
+    }
+    // Output commands are chains of source commands: head, tail and next link
+    uint32_t *head = (uint32_t *)gui_alloc(&ctx->allocator, count * sizeof(uint32_t));
+    uint32_t *tail = (uint32_t *)gui_alloc(&ctx->allocator, count * sizeof(uint32_t));
+    uint32_t *next = (uint32_t *)gui_alloc(&ctx->allocator, count * sizeof(uint32_t));
+    gui_rect_t *bounds = (gui_rect_t *)gui_alloc(&ctx->allocator, count * sizeof(gui_rect_t));
+    if (!head || !tail || !next || !bounds) {
         return;
     }
 
-    if (layout->type == GUI_LAYOUT_VBOX) {
-        layout->cursor_y += amount;
-    } else if (layout->type == GUI_LAYOUT_HBOX) {
-        layout->cursor_x += amount;
+    uint32_t out_count = 0;
+    uint32_t barrier = 0; // Output commands before it are not moved over
+    for (uint32_t c = 0; c < count; c++) {
+        const gui_draw_cmd_t *cmd = &ctx->draw_commands[c];
+        next[c] = UINT32_MAX;
+        gui_rect_t rect = {0};
+        if (cmd->type == GUI_DRAW_CMD_TRIANGLES) {
+            rect = gui_draw_cmd_bounds(ctx, cmd);
+            uint32_t stop = (out_count - barrier > CGUI_REORDER_WINDOW)
+                                ? out_count - CGUI_REORDER_WINDOW
+                                : barrier;
+            uint32_t target = UINT32_MAX;
+            for (uint32_t m = out_count; m-- > stop;) {
+                const gui_draw_cmd_t *out = &ctx->draw_commands[head[m]];
+                if (gui_draw_cmd_matches(out, cmd->clip_rect, cmd->texture, &cmd->transform)) {
+                    target = m;
+                    break;
+                }
+                if (gui_rects_overlap(bounds[m], rect)) {
+                    break; // Must stay after it
+                }
+            }
+            if (target != UINT32_MAX) {
+                next[tail[target]] = c;
+                tail[target] = c;
+                bounds[target] = gui_union_rects(bounds[target], rect);
+                continue;
+            }
+        }
+        head[out_count] = c;
+        tail[out_count] = c;
+        bounds[out_count] = rect;
+        out_count++;
+        if (cmd->type != GUI_DRAW_CMD_TRIANGLES) {
+            barrier = out_count;
+        }
     }
+    if (out_count == count) {
+        return;
+    }
+
+    // Indices of each chain become contiguous
+    gui_draw_cmd_t *out_commands =
+        (gui_draw_cmd_t *)gui_alloc(&ctx->allocator, out_count * sizeof(gui_draw_cmd_t));
+    uint32_t *out_indices =
+        (uint32_t *)gui_alloc(&ctx->allocator, ctx->index_count * sizeof(uint32_t));
+    if (!out_commands || !out_indices) {
+        return;
+    }
+    uint32_t index_count = 0;
+    for (uint32_t m = 0; m < out_count; m++) {
+        gui_draw_cmd_t *out = &out_commands[m];
+        *out = ctx->draw_commands[head[m]];
+        out->idx_offset = index_count;
+        for (uint32_t c = head[m]; c != UINT32_MAX; c = next[c]) {
+            const gui_draw_cmd_t *src = &ctx->draw_commands[c];
+            memcpy(&out_indices[index_count], &ctx->indices[src->idx_offset],
+                   src->elem_count * sizeof(uint32_t));
+            index_count += src->elem_count;
+        }
+        out->elem_count = index_count - out->idx_offset;
+    }
+    memcpy(ctx->indices, out_indices, index_count * sizeof(uint32_t));
+    memcpy(ctx->draw_commands, out_commands, out_count * sizeof(gui_draw_cmd_t));
+    ctx->stats.merged_commands = count - out_count;
+    ctx->draw_command_count = out_count;
 }
 
 // =============================================================================
-// DRAWING PRIMITIVES
+// SPATIAL GRID
 // =============================================================================
 
-static void gui_prim_reserve(gui_context_t *ctx, int vtx_count, int idx_count) {
-    if (ctx->vertex_count + vtx_count > CGUI_MAX_VERTICES ||
-        ctx->index_count + idx_count > CGUI_MAX_INDICES) {
-        return; // Out of space
+// Grows a malloc'd array to hold at least `needed` elements (capacity doubles)
+static bool gui_grow_array(void **array, uint32_t *capacity, uint32_t needed, size_t elem_size) {
+    if (needed <= *capacity) {
+        return true;
+    }
+    uint32_t new_capacity = (*capacity > 0) ? *capacity : 64U;
+    while (new_capacity < needed) {
+        new_capacity *= 2U;
+    }
+    void *grown = CGUI_REALLOC(*array, (size_t)new_capacity * elem_size);
+    if (!grown) {
+        return false;
     }
+    *array = grown;
+    *capacity = new_capacity;
+    return true;
 }
 
-static void gui_prim_rect_filled(gui_context_t *ctx, float x, float y, float w, float h,
-                                 gui_color_t color) {
-    gui_prim_reserve(ctx, 4, 6);
+static int gui_grid_clamp_cell(float v, int count) {
+    int cell = (int)floorf(v);
+    return (cell < 0) ? 0 : (cell >= count ? count - 1 : cell);
+}
 
-    uint32_t idx = ctx->vertex_count;
+// Cell coordinates overlapped by rect, clamped to the grid
+static void gui_grid_cell_range(const gui_grid_t *grid, gui_rect_t rect, int *c0, int *r0, int *c1,
+                                int *r1) {
+    *c0 = gui_grid_clamp_cell((rect.x - grid->origin_x) / grid->cell_w, grid->cols);
+    *r0 = gui_grid_clamp_cell((rect.y - grid->origin_y) / grid->cell_h, grid->rows);
+    *c1 = gui_grid_clamp_cell((rect.x + rect.w - grid->origin_x) / grid->cell_w, grid->cols);
+    *r1 = gui_grid_clamp_cell((rect.y + rect.h - grid->origin_y) / grid->cell_h, grid->rows);
+}
 
-    ctx->vertices[ctx->vertex_count++] = (gui_vertex_t){{x, y}, {0, 0}, color};
-    ctx->vertices[ctx->vertex_count++] = (gui_vertex_t){{x + w, y}, {1, 0}, color};
-    ctx->vertices[ctx->vertex_count++] = (gui_vertex_t){{x + w, y + h}, {1, 1}, color};
-    ctx->vertices[ctx->vertex_count++] = (gui_vertex_t){{x, y + h}, {0, 1}, color};
+// Bins `count` rects, each read from the start of a `stride`-byte item, into a grid covering
+// their bounds. Two counting passes, no per-cell allocations.
+static void gui_grid_build(gui_grid_t *grid, const void *items, size_t stride, uint32_t count,
+                           float cell_size) {
+    grid->cols = 0;
+    grid->rows = 0;
+    if (count == 0) {
+        return;
+    }
 
-    ctx->indices[ctx->index_count++] = idx + 0;
-    ctx->indices[ctx->index_count++] = idx + 1;
-    ctx->indices[ctx->index_count++] = idx + 2;
-    ctx->indices[ctx->index_count++] = idx + 0;
-    ctx->indices[ctx->index_count++] = idx + 2;
-    ctx->indices[ctx->index_count++] = idx + 3;
+    float x0 = INFINITY;
+    float y0 = INFINITY;
+    float x1 = -INFINITY;
+    float y1 = -INFINITY;
+    for (uint32_t i = 0; i < count; i++) {
+        const gui_rect_t *rect = (const gui_rect_t *)((const uint8_t *)items + (i * stride));
+        x0 = fminf(x0, rect->x);
+        y0 = fminf(y0, rect->y);
+        x1 = fmaxf(x1, rect->x + rect->w);
+        y1 = fmaxf(y1, rect->y + rect->h);
+    }
+
+    float w = fmaxf(x1 - x0, 1.0F);
+    float h = fmaxf(y1 - y0, 1.0F);
+    grid->origin_x = x0;
+    grid->origin_y = y0;
+    grid->cell_w = fmaxf(cell_size, w / (float)CGUI_GRID_MAX_DIM);
+    grid->cell_h = fmaxf(cell_size, h / (float)CGUI_GRID_MAX_DIM);
+    grid->cols = (int)fminf(ceilf(w / grid->cell_w), (float)CGUI_GRID_MAX_DIM);
+    grid->rows = (int)fminf(ceilf(h / grid->cell_h), (float)CGUI_GRID_MAX_DIM);
+    grid->cols = (grid->cols > 0) ? grid->cols : 1;
+    grid->rows = (grid->rows > 0) ? grid->rows : 1;
+
+    uint32_t cell_count = (uint32_t)(grid->cols * grid->rows);
+    if (!gui_grow_array((void **)&grid->cell_start, &grid->cell_capacity, cell_count + 1,
+                        sizeof(uint32_t))) {
+        grid->cols = 0;
+        grid->rows = 0;
+        return;
+    }
+    memset(grid->cell_start, 0, sizeof(uint32_t) * (cell_count + 1));
+
+    // Count entries per cell
+    uint32_t total = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        const gui_rect_t *rect = (const gui_rect_t *)((const uint8_t *)items + (i * stride));
+        int c0, r0, c1, r1;
+        gui_grid_cell_range(grid, *rect, &c0, &r0, &c1, &r1);
+        for (int r = r0; r <= r1; r++) {
+            for (int c = c0; c <= c1; c++) {
+                grid->cell_start[(r * grid->cols) + c]++;
+            }
+        }
+        total += (uint32_t)((c1 - c0 + 1) * (r1 - r0 + 1));
+    }
+    if (!gui_grow_array((void **)&grid->entries, &grid->entry_capacity, total,
+                        sizeof(uint32_t))) {
+        grid->cols = 0;
+        grid->rows = 0;
+        return;
+    }
+
+    // Inclusive prefix sums give each cell's end; filling backwards leaves each cell's start
+    uint32_t sum = 0;
+    for (uint32_t c = 0; c < cell_count; c++) {
+        sum += grid->cell_start[c];
+        grid->cell_start[c] = sum;
+    }
+    grid->cell_start[cell_count] = total;
+    for (uint32_t i = 0; i < count; i++) {
+        const gui_rect_t *rect = (const gui_rect_t *)((const uint8_t *)items + (i * stride));
+        int c0, r0, c1, r1;
+        gui_grid_cell_range(grid, *rect, &c0, &r0, &c1, &r1);
+        for (int r = r0; r <= r1; r++) {
+            for (int c = c0; c <= c1; c++) {
+                grid->entries[--grid->cell_start[(r * grid->cols) + c]] = i;
+            }
+        }
+    }
 }
 
-void gui_add_rect_filled(gui_context_t *ctx, float x, float y, float w, float h,
-                         gui_color_t color) {
-    gui_prim_rect_filled(ctx, x, y, w, h, color);
+// Entry range of the cell containing (x, y); false outside the grid
+static bool gui_grid_cell_at(const gui_grid_t *grid, float x, float y, uint32_t *begin,
+                             uint32_t *end) {
+    if (grid->cols == 0) {
+        return false;
+    }
+    float fc = (x - grid->origin_x) / grid->cell_w;
+    float fr = (y - grid->origin_y) / grid->cell_h;
+    if (fc < 0.0F || fr < 0.0F || fc > (float)grid->cols || fr > (float)grid->rows) {
+        return false;
+    }
+    int cell = (gui_grid_clamp_cell(fr, grid->rows) * grid->cols) +
+               gui_grid_clamp_cell(fc, grid->cols);
+    *begin = grid->cell_start[cell];
+    *end = grid->cell_start[cell + 1];
+    return true;
 }
 
-void gui_add_rect(gui_context_t *ctx, float x, float y, float w, float h, gui_color_t color,
-                  float thickness) {
-    // Draw four lines to form a rectangle
-    gui_add_line(ctx, x, y, x + w, y, color, thickness);
-    gui_add_line(ctx, x + w, y, x + w, y + h, color, thickness);
-    gui_add_line(ctx, x + w, y + h, x, y + h, color, thickness);
-    gui_add_line(ctx, x, y + h, x, y, color, thickness);
+static void gui_grid_free(gui_grid_t *grid) {
+    CGUI_FREE(grid->cell_start);
+    CGUI_FREE(grid->entries);
+    memset(grid, 0, sizeof(gui_grid_t));
 }
 
-void gui_add_line(gui_context_t *ctx, float x1, float y1, float x2, float y2, gui_color_t color,
-                  float thickness) {
-    float dx = x2 - x1;
-    float dy = y2 - y1;
-    float len = sqrtf((dx * dx) + (dy * dy));
+// =============================================================================
+// HIT TESTING
+// =============================================================================
+
+bool gui_add_hit_rect(gui_context_t *ctx, gui_id_t id, float x, float y, float w, float h) {
+    gui_rect_t rect = {x, y, w, h};
+    if (ctx->transformed) {
+        rect = gui_transform_rect(&ctx->transform, rect);
+    }
+    rect = gui_intersect_rects(rect, ctx->clip_stack[ctx->clip_stack_count - 1]);
+    if (rect.w > 0.0F && rect.h > 0.0F &&
+        gui_grow_array((void **)&ctx->hit_items, &ctx->hit_item_capacity,
+                       ctx->hit_item_count + 1, sizeof(gui_hit_item_t))) {
+        int layer = (ctx->layer_stack_count > 0) ? ctx->layer_stack[ctx->layer_stack_count - 1]
+                                                 : 0;
+        ctx->hit_items[ctx->hit_item_count++] = (gui_hit_item_t){rect, id, layer};
+    }
+    return id != 0 && ctx->hovered_item == id;
+}
+
+void gui_push_layer(gui_context_t *ctx, int layer) {
+    if (ctx->layer_stack_count < CGUI_MAX_LAYER_STACK) {
+        ctx->layer_stack[ctx->layer_stack_count++] = layer;
+    }
+}
+
+void gui_pop_layer(gui_context_t *ctx) {
+    if (ctx->layer_stack_count > 0) {
+        ctx->layer_stack_count--;
+    }
+}
+
+// Indexes this frame's items for the next frame's lookups
+static void gui_hit_end_frame(gui_context_t *ctx) {
+    gui_grid_build(&ctx->hit_grid, ctx->hit_items, sizeof(gui_hit_item_t), ctx->hit_item_count,
+                   CGUI_HIT_GRID_CELL_SIZE);
+
+    gui_hit_item_t *items = ctx->prev_hit_items;
+    uint32_t capacity = ctx->prev_hit_item_capacity;
+    ctx->prev_hit_items = ctx->hit_items;
+    ctx->prev_hit_item_count = ctx->hit_item_count;
+    ctx->prev_hit_item_capacity = ctx->hit_item_capacity;
+    ctx->hit_items = items;
+    ctx->hit_item_capacity = capacity;
+    ctx->hit_item_count = 0;
+}
+
+// Topmost item of last frame under the mouse: one grid cell scan
+static void gui_hit_resolve(gui_context_t *ctx) {
+    ctx->hovered_item = 0;
+    float mx = ctx->input.mouse_pos.x;
+    float my = ctx->input.mouse_pos.y;
 
-    if (len < 0.001F) {
+    uint32_t begin;
+    uint32_t end;
+    if (!gui_grid_cell_at(&ctx->hit_grid, mx, my, &begin, &end)) {
         return;
     }
 
-    float nx = -dy / len * thickness * 0.5F;
-    float ny = dx / len * thickness * 0.5F;
+    const gui_hit_item_t *best = NULL;
+    uint32_t best_index = 0;
+    for (uint32_t e = begin; e < end; e++) {
+        uint32_t i = ctx->hit_grid.entries[e];
+        const gui_hit_item_t *item = &ctx->prev_hit_items[i];
+        if (!gui_rect_contains(item->rect, mx, my)) {
+            continue;
+        }
+        if (!best || item->layer > best->layer || (item->layer == best->layer && i > best_index)) {
+            best = item;
+            best_index = i;
+        }
+    }
+    if (best) {
+        ctx->hovered_item = best->id;
+    }
+}
 
-    gui_prim_reserve(ctx, 4, 6);
-    uint32_t idx = ctx->vertex_count;
+// =============================================================================
+// INPUT EVENTS
+// =============================================================================
 
-    ctx->vertices[ctx->vertex_count++] = (gui_vertex_t){{x1 + nx, y1 + ny}, {0, 0}, color};
-    ctx->vertices[ctx->vertex_count++] = (gui_vertex_t){{x2 + nx, y2 + ny}, {0, 0}, color};
-    ctx->vertices[ctx->vertex_count++] = (gui_vertex_t){{x2 - nx, y2 - ny}, {0, 0}, color};
-    ctx->vertices[ctx->vertex_count++] = (gui_vertex_t){{x1 - nx, y1 - ny}, {0, 0}, color};
+bool gui_input_push_event(gui_context_t *ctx, const gui_input_event_t *event) {
+    gui_input_queue_t *queue = &ctx->input_queue;
+    uint32_t head = queue->head; // Only this thread writes head
+    uint32_t tail = gui_atomic_load_acquire(&queue->tail);
+    if (head - tail >= CGUI_INPUT_QUEUE_SIZE) {
+        queue->dropped++;
+        return false;
+    }
+    queue->events[head & (CGUI_INPUT_QUEUE_SIZE - 1)] = *event;
+    gui_atomic_store_release(&queue->head, head + 1);
+    return true;
+}
 
-    ctx->indices[ctx->index_count++] = idx + 0;
-    ctx->indices[ctx->index_count++] = idx + 1;
-    ctx->indices[ctx->index_count++] = idx + 2;
-    ctx->indices[ctx->index_count++] = idx + 0;
-    ctx->indices[ctx->index_count++] = idx + 2;
-    ctx->indices[ctx->index_count++] = idx + 3;
+bool gui_input_add_mouse_pos(gui_context_t *ctx, float x, float y, double timestamp) {
+    gui_input_event_t event = {.type = GUI_INPUT_EVENT_MOUSE_POS, .timestamp = timestamp};
+    event.mouse_pos = (gui_vec2_t){x, y};
+    return gui_input_push_event(ctx, &event);
+}
+
+bool gui_input_add_mouse_button(gui_context_t *ctx, int button, bool down, double timestamp) {
+    gui_input_event_t event = {.type = GUI_INPUT_EVENT_MOUSE_BUTTON, .timestamp = timestamp};
+    event.mouse_button.button = button;
+    event.mouse_button.down = down;
+    return gui_input_push_event(ctx, &event);
+}
+
+bool gui_input_add_mouse_wheel(gui_context_t *ctx, float dx, float dy, double timestamp) {
+    gui_input_event_t event = {.type = GUI_INPUT_EVENT_MOUSE_WHEEL, .timestamp = timestamp};
+    event.mouse_wheel = (gui_vec2_t){dx, dy};
+    return gui_input_push_event(ctx, &event);
+}
+
+bool gui_input_add_key(gui_context_t *ctx, int key, bool down, double timestamp) {
+    gui_input_event_t event = {.type = GUI_INPUT_EVENT_KEY, .timestamp = timestamp};
+    event.key.key = key;
+    event.key.down = down;
+    return gui_input_push_event(ctx, &event);
+}
+
+bool gui_input_add_text(gui_context_t *ctx, uint32_t codepoint, double timestamp) {
+    gui_input_event_t event = {.type = GUI_INPUT_EVENT_TEXT, .timestamp = timestamp};
+    event.codepoint = codepoint;
+    return gui_input_push_event(ctx, &event);
+}
+
+static size_t gui_utf8_encode(uint32_t c, char *out) {
+    if (c < 0x80) {
+        out[0] = (char)c;
+        return 1;
+    }
+    if (c < 0x800) {
+        out[0] = (char)(0xC0 | (c >> 6));
+        out[1] = (char)(0x80 | (c & 0x3F));
+        return 2;
+    }
+    if (c < 0x10000) {
+        out[0] = (char)(0xE0 | (c >> 12));
+        out[1] = (char)(0x80 | ((c >> 6) & 0x3F));
+        out[2] = (char)(0x80 | (c & 0x3F));
+        return 3;
+    }
+    out[0] = (char)(0xF0 | (c >> 18));
+    out[1] = (char)(0x80 | ((c >> 12) & 0x3F));
+    out[2] = (char)(0x80 | ((c >> 6) & 0x3F));
+    out[3] = (char)(0x80 | (c & 0x3F));
+    return 4;
+}
+
+// Applies queued events to the input state with trickling: a second transition of the same
+// button or key, a mouse move after a button change, or text that does not fit ends the frame's
+// batch and is left for the next frame, so presses and releases inside one frame both register.
+// Mouse moves overwrite each other, so high-rate pointers cost one position update per event.
+static void gui_input_consume_events(gui_context_t *ctx) {
+    gui_input_queue_t *queue = &ctx->input_queue;
+    gui_input_t *input = &ctx->input;
+    uint32_t tail = queue->tail; // Only this thread writes tail
+    uint32_t head = gui_atomic_load_acquire(&queue->head);
+
+    bool button_changed[GUI_MOUSE_BUTTON_COUNT] = {false};
+    bool any_button_changed = false;
+    uint8_t key_changed[GUI_KEY_COUNT / 8] = {0};
+    size_t text_len = strlen(input->text_input);
+
+    for (; tail != head; tail++) {
+        const gui_input_event_t *event = &queue->events[tail & (CGUI_INPUT_QUEUE_SIZE - 1)];
+
+        if (event->type == GUI_INPUT_EVENT_MOUSE_POS) {
+            if (any_button_changed) {
+                break; // Keep the press at the position it happened
+            }
+            input->mouse_pos = event->mouse_pos;
+        } else if (event->type == GUI_INPUT_EVENT_MOUSE_BUTTON) {
+            int button = event->mouse_button.button;
+            if (button < 0 || button >= GUI_MOUSE_BUTTON_COUNT) {
+                continue;
+            }
+            if (button_changed[button]) {
+                break;
+            }
+            button_changed[button] = input->mouse_down[button] != event->mouse_button.down;
+            any_button_changed = any_button_changed || button_changed[button];
+            input->mouse_down[button] = event->mouse_button.down;
+        } else if (event->type == GUI_INPUT_EVENT_MOUSE_WHEEL) {
+            input->mouse_wheel_h += event->mouse_wheel.x;
+            input->mouse_wheel += event->mouse_wheel.y;
+        } else if (event->type == GUI_INPUT_EVENT_KEY) {
+            int key = event->key.key;
+            if (key < 0 || key >= GUI_KEY_COUNT) {
+                continue;
+            }
+            uint8_t bit = (uint8_t)(1U << (key & 7));
+            if (key_changed[key >> 3] & bit) {
+                break;
+            }
+            key_changed[key >> 3] |= bit;
+            input->keys[key] = event->key.down;
+            if (event->key.down) {
+                input->keys_pressed[key] = true;
+            }
+        } else if (event->type == GUI_INPUT_EVENT_TEXT) {
+            char utf8[4];
+            size_t len = gui_utf8_encode(event->codepoint, utf8);
+            if (text_len + len >= sizeof(input->text_input)) {
+                break;
+            }
+            memcpy(&input->text_input[text_len], utf8, len);
+            text_len += len;
+            input->text_input[text_len] = '\0';
+        }
+        input->event_time = event->timestamp;
+    }
+
+    gui_atomic_store_release(&queue->tail, tail);
+}
+
+// =============================================================================
+// STATISTICS
+// =============================================================================
+
+// A wall clock stepped by NTP or by hand would make timings negative or huge. Strict ISO C builds
+// without POSIX fall back to it.
+uint64_t gui_time_ns(void) {
+#if defined(_WIN32)
+    LARGE_INTEGER frequency;
+    LARGE_INTEGER counter;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+    uint64_t freq = (uint64_t)frequency.QuadPart;
+    uint64_t ticks = (uint64_t)counter.QuadPart;
+    // Whole seconds and the remainder separately, so the scaling cannot overflow
+    return ((ticks / freq) * 1000000000U) + (((ticks % freq) * 1000000000U) / freq);
+#else
+    struct timespec ts;
+#if defined(CLOCK_MONOTONIC)
+    if (clock_gettime(CLOCK_MONOTONIC, &ts) != 0) {
+        return 0;
+    }
+#else
+    if (timespec_get(&ts, TIME_UTC) == 0) {
+        return 0;
+    }
+#endif
+    return ((uint64_t)ts.tv_sec * 1000000000U) + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+static double gui_time_ms(void) { return (double)gui_time_ns() / 1000000.0; }
+
+const gui_frame_stats_t *gui_get_frame_stats(const gui_context_t *ctx) {
+    if (ctx->stats_frame_count == 0) {
+        return &ctx->stats_history[0];
+    }
+    return &ctx->stats_history[(ctx->stats_frame_count - 1) % CGUI_STATS_HISTORY];
+}
+
+void gui_report_upload(gui_context_t *ctx, uint64_t bytes, float ms) {
+    ctx->pending_upload_bytes += bytes;
+    ctx->pending_upload_ms += ms;
+}
+
+// Completes the frame's counters (called last in gui_end_frame, after the hit items were
+// handed over) and appends them to the history ring
+static void gui_stats_publish(gui_context_t *ctx) {
+    gui_frame_stats_t *stats = &ctx->stats;
+    const gui_frame_stats_t *prev = gui_get_frame_stats(ctx);
+
+    stats->vertex_count = ctx->vertex_count;
+    stats->index_count = ctx->index_count;
+    stats->draw_command_count = ctx->draw_command_count;
+    for (uint32_t i = 1; i < ctx->draw_command_count; i++) {
+        const gui_draw_cmd_t *cmd = &ctx->draw_commands[i];
+        stats->clip_switches += gui_rects_equal(cmd[-1].clip_rect, cmd->clip_rect) ? 0U : 1U;
+        stats->texture_switches += (cmd[-1].texture == cmd->texture) ? 0U : 1U;
+    }
+    stats->hit_item_count = ctx->prev_hit_item_count;
+    stats->arena_used = ctx->allocator.used;
+    stats->arena_high_water =
+        (prev->arena_high_water > stats->arena_used) ? prev->arena_high_water : stats->arena_used;
+    stats->vertex_high_water = (prev->vertex_high_water > stats->vertex_count)
+                                   ? prev->vertex_high_water
+                                   : stats->vertex_count;
+    stats->index_high_water =
+        (prev->index_high_water > stats->index_count) ? prev->index_high_water : stats->index_count;
+    stats->cpu_ms = stats->begin_ms + stats->widgets_ms + stats->end_ms;
+    stats->upload_bytes = ctx->pending_upload_bytes;
+    stats->upload_ms = ctx->pending_upload_ms;
+    ctx->pending_upload_bytes = 0;
+    ctx->pending_upload_ms = 0.0F;
+
+    ctx->stats_history[ctx->stats_frame_count % CGUI_STATS_HISTORY] = *stats;
+    ctx->stats_frame_count++;
+}
+
+// =============================================================================
+// TRACE
+// =============================================================================
+
+#ifdef CGUI_ENABLE_TRACE
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#define GUI_THREAD_LOCAL __declspec(thread)
+#else
+#define GUI_THREAD_LOCAL _Thread_local
+#endif
+
+typedef struct {
+    const char *name;
+    uint64_t start_ns;
+    uint64_t duration_ns;
+} gui_trace_event_t;
+
+// Written only by its thread; head is published with release so the dumper sees whole events
+typedef struct gui_trace_buffer {
+    struct gui_trace_buffer *next;
+    uint32_t thread_id;
+    volatile uint32_t head;    // Zones completed (wraps; slot = head % capacity)
+    volatile uint32_t wrapped; // Set once the ring has been filled
+    int depth;
+    const char *open_names[CGUI_TRACE_MAX_DEPTH];
+    uint64_t open_start[CGUI_TRACE_MAX_DEPTH];
+    gui_trace_event_t events[CGUI_TRACE_CAPACITY];
+} gui_trace_buffer_t;
+
+static GUI_THREAD_LOCAL gui_trace_buffer_t *gui_trace_local;
+static gui_trace_buffer_t *volatile gui_trace_buffers;
+static volatile uint32_t gui_trace_thread_count;
+
+#if defined(_MSC_VER) && !defined(__clang__)
+static gui_trace_buffer_t *gui_trace_list_head(void) {
+    return (gui_trace_buffer_t *)_InterlockedCompareExchangePointer(
+        (void *volatile *)&gui_trace_buffers, NULL, NULL);
+}
+static bool gui_trace_list_push(gui_trace_buffer_t *buffer, gui_trace_buffer_t *expected) {
+    return _InterlockedCompareExchangePointer((void *volatile *)&gui_trace_buffers, buffer,
+                                              expected) == expected;
+}
+static uint32_t gui_trace_next_thread_id(void) {
+    return (uint32_t)_InterlockedIncrement((volatile long *)&gui_trace_thread_count);
+}
+#else
+static gui_trace_buffer_t *gui_trace_list_head(void) {
+    return __atomic_load_n(&gui_trace_buffers, __ATOMIC_ACQUIRE);
+}
+static bool gui_trace_list_push(gui_trace_buffer_t *buffer, gui_trace_buffer_t *expected) {
+    return __atomic_compare_exchange_n(&gui_trace_buffers, &expected, buffer, false,
+                                       __ATOMIC_RELEASE, __ATOMIC_RELAXED);
+}
+static uint32_t gui_trace_next_thread_id(void) {
+    return __atomic_add_fetch(&gui_trace_thread_count, 1U, __ATOMIC_RELAXED);
+}
+#endif
+
+// First zone on a thread: allocate its ring and link it into the global list
+static gui_trace_buffer_t *gui_trace_register(void) {
+    gui_trace_buffer_t *buffer = (gui_trace_buffer_t *)CGUI_CALLOC(1, sizeof(gui_trace_buffer_t));
+    if (!buffer) {
+        return NULL;
+    }
+    buffer->thread_id = gui_trace_next_thread_id();
+    do {
+        buffer->next = gui_trace_list_head();
+    } while (!gui_trace_list_push(buffer, buffer->next));
+    gui_trace_local = buffer;
+    return buffer;
+}
+
+void gui_trace_begin(const char *name) {
+    gui_trace_buffer_t *buffer = gui_trace_local ? gui_trace_local : gui_trace_register();
+    if (!buffer) {
+        return;
+    }
+    if (buffer->depth < CGUI_TRACE_MAX_DEPTH) {
+        buffer->open_names[buffer->depth] = name;
+        buffer->open_start[buffer->depth] = gui_time_ns();
+    }
+    buffer->depth++;
+}
+
+void gui_trace_end(void) {
+    gui_trace_buffer_t *buffer = gui_trace_local;
+    if (!buffer || buffer->depth == 0) {
+        return;
+    }
+    int depth = --buffer->depth;
+    if (depth >= CGUI_TRACE_MAX_DEPTH) {
+        return;
+    }
+
+    uint32_t head = buffer->head;
+    gui_trace_event_t *event = &buffer->events[head & (CGUI_TRACE_CAPACITY - 1U)];
+    event->name = buffer->open_names[depth];
+    event->start_ns = buffer->open_start[depth];
+    event->duration_ns = gui_time_ns() - event->start_ns;
+    if (head + 1U >= CGUI_TRACE_CAPACITY) {
+        gui_atomic_store_release(&buffer->wrapped, 1U);
+    }
+    gui_atomic_store_release(&buffer->head, head + 1U);
+}
+
+static uint32_t gui_trace_count(gui_trace_buffer_t *buffer, uint32_t *out_head) {
+    uint32_t head = gui_atomic_load_acquire(&buffer->head);
+    *out_head = head;
+    return gui_atomic_load_acquire(&buffer->wrapped) ? CGUI_TRACE_CAPACITY : head;
+}
+
+static void gui_trace_write_string(FILE *file, const char *str) {
+    fputc('"', file);
+    for (const char *c = str ? str : "?"; *c; c++) {
+        if (*c == '"' || *c == '\\') {
+            fputc('\\', file);
+        }
+        if ((unsigned char)*c >= 0x20U) {
+            fputc(*c, file);
+        }
+    }
+    fputc('"', file);
+}
+
+bool gui_trace_dump(const char *path) {
+    FILE *file = fopen(path, "wb");
+    if (!file) {
+        return false;
+    }
+
+    // Timestamps are written relative to the oldest zone to keep the numbers short
+    uint64_t epoch = UINT64_MAX;
+    for (gui_trace_buffer_t *b = gui_trace_list_head(); b; b = b->next) {
+        uint32_t head;
+        uint32_t count = gui_trace_count(b, &head);
+        for (uint32_t i = head - count; i != head; i++) {
+            uint64_t start = b->events[i & (CGUI_TRACE_CAPACITY - 1U)].start_ns;
+            epoch = (start < epoch) ? start : epoch;
+        }
+    }
+
+    fputs("{\"traceEvents\":[", file);
+    const char *separator = "\n";
+    for (gui_trace_buffer_t *b = gui_trace_list_head(); b; b = b->next) {
+        uint32_t head;
+        uint32_t count = gui_trace_count(b, &head);
+        for (uint32_t i = head - count; i != head; i++) {
+            const gui_trace_event_t *event = &b->events[i & (CGUI_TRACE_CAPACITY - 1U)];
+            fputs(separator, file);
+            fputs("{\"name\":", file);
+            gui_trace_write_string(file, event->name);
+            fprintf(file, ",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+                    b->thread_id, (double)(event->start_ns - epoch) / 1000.0,
+                    (double)event->duration_ns / 1000.0);
+            separator = ",\n";
+        }
+    }
+    fputs("\n],\"displayTimeUnit\":\"ns\"}\n", file);
+
+    bool ok = !ferror(file);
+    return (fclose(file) == 0) && ok;
+}
+
+void gui_trace_shutdown(void) {
+    gui_trace_buffer_t *buffer = gui_trace_list_head();
+    while (buffer && !gui_trace_list_push(NULL, buffer)) {
+        buffer = gui_trace_list_head();
+    }
+    while (buffer) {
+        gui_trace_buffer_t *next = buffer->next;
+        CGUI_FREE(buffer);
+        buffer = next;
+    }
+    gui_trace_local = NULL;
+}
+
+#endif // CGUI_ENABLE_TRACE
+
+// =============================================================================
+// CONTEXT MANAGEMENT
+// =============================================================================
+
+void gui_init(gui_context_t *ctx) {
+    memset(ctx, 0, sizeof(gui_context_t));
+
+    // Allocate frame buffer
+    ctx->allocator.size = (size_t)CGUI_FRAME_ALLOCATOR_SIZE;
+    ctx->allocator.buffer = (uint8_t *)CGUI_MALLOC(ctx->allocator.size);
+    ctx->allocator.used = 0;
+
+    // Allocate draw buffers
+    ctx->vertices = (gui_vertex_t *)CGUI_MALLOC(sizeof(gui_vertex_t) * CGUI_MAX_VERTICES);
+    ctx->indices = (uint32_t *)CGUI_MALLOC(sizeof(uint32_t) * CGUI_MAX_INDICES);
+    ctx->draw_commands =
+        (gui_draw_cmd_t *)CGUI_MALLOC(sizeof(gui_draw_cmd_t) * CGUI_MAX_DRAW_COMMANDS);
+
+    // Initialize style (modern flat design)
+    ctx->style.button_bg = gui_color_from_rgba(70, 130, 180, 255);
+    ctx->style.button_bg_hovered = gui_color_from_rgba(90, 150, 200, 255);
+    ctx->style.button_bg_active = gui_color_from_rgba(50, 110, 160, 255);
+    ctx->style.button_text = GUI_COLOR_WHITE;
+    ctx->style.text = gui_color_from_rgba(240, 240, 240, 255);
+    ctx->style.slider_bg = gui_color_from_rgba(60, 60, 60, 255);
+    ctx->style.slider_grab = gui_color_from_rgba(70, 130, 180, 255);
+    ctx->style.slider_grab_active = gui_color_from_rgba(90, 150, 200, 255);
+    ctx->style.scrollbar_bg = gui_color_from_rgba(40, 40, 40, 255);
+    ctx->style.scrollbar_grab = gui_color_from_rgba(90, 90, 90, 255);
+    ctx->style.scrollbar_grab_active = gui_color_from_rgba(120, 120, 120, 255);
+    ctx->style.table_bg = gui_color_from_rgba(35, 35, 40, 255);
+    ctx->style.table_row_alt_bg = gui_color_from_rgba(42, 42, 48, 255);
+    ctx->style.table_header_bg = gui_color_from_rgba(55, 75, 100, 255);
+    ctx->style.table_header_bg_hovered = gui_color_from_rgba(70, 95, 125, 255);
+    ctx->style.table_border = gui_color_from_rgba(80, 80, 90, 255);
+    ctx->style.plot_bg = gui_color_from_rgba(25, 25, 30, 255);
+    ctx->style.plot_line = gui_color_from_rgba(110, 190, 240, 255);
+    ctx->style.text_highlight = gui_color_from_rgba(130, 100, 20, 255);
+    ctx->style.button_padding = 8.0F;
+    ctx->style.button_rounding = 4.0F;
+    ctx->style.slider_height = 20.0F;
+    ctx->style.slider_grab_size = 16.0F;
+    ctx->style.text_size = 14.0F;
+    ctx->style.scrollbar_size = 12.0F;
+    ctx->style.table_cell_padding = 4.0F;
+    ctx->style.table_column_width = 100.0F;
+    ctx->style.anti_aliased_shapes = false;
+
+    ctx->font_size = 14.0F;
+}
+
+void gui_shutdown(gui_context_t *ctx) {
+    if (ctx->allocator.buffer) {
+        CGUI_FREE(ctx->allocator.buffer);
+    }
+    if (ctx->vertices) {
+        CGUI_FREE(ctx->vertices);
+    }
+    if (ctx->indices) {
+        CGUI_FREE(ctx->indices);
+    }
+    if (ctx->draw_commands) {
+        CGUI_FREE(ctx->draw_commands);
+    }
+#ifdef CGUI_ENABLE_OPAQUE_PASS
+    CGUI_FREE(ctx->opaque_indices);
+    CGUI_FREE(ctx->opaque_commands);
+#endif
+    gui_state_free_all(ctx);
+    CGUI_FREE(ctx->hit_items);
+    CGUI_FREE(ctx->prev_hit_items);
+    gui_grid_free(&ctx->hit_grid);
+    memset(ctx, 0, sizeof(gui_context_t));
+}
+
+void gui_begin_frame(gui_context_t *ctx, float display_width, float display_height) {
+    GUI_TRACE_BEGIN("frame"); // Closed by gui_end_frame
+    GUI_TRACE_BEGIN("gui_begin_frame");
+    memset(&ctx->stats, 0, sizeof(gui_frame_stats_t));
+    ctx->frame_begin_time = gui_time_ms();
+
+    ctx->display_width = display_width;
+    ctx->display_height = display_height;
+
+    // Reset allocator
+    gui_reset_allocator(&ctx->allocator);
+
+    // Reset draw data
+    ctx->vertex_count = 0;
+    ctx->index_count = 0;
+    ctx->draw_command_count = 0;
+#ifdef CGUI_ENABLE_OPAQUE_PASS
+    ctx->opaque_index_count = 0;
+    ctx->opaque_command_count = 0;
+#endif
+    ctx->prim_vertex_start = 0;
+    ctx->prim_count = 0;
+    ctx->deferred_head = NULL;
+    ctx->deferred_tail = NULL;
+
+    // Reset layout and ID stacks
+    ctx->layout_stack_count = 0;
+    ctx->id_stack_count = 0;
+    ctx->cached_stack_count = 0;
+    ctx->layer = NULL;
+    ctx->layer_nesting = 0;
+
+    // Reset clip and transform stacks and texture
+    ctx->current_texture = NULL;
+    ctx->clip_stack_count = 0;
+    gui_rect_t full_screen = {0, 0, display_width, display_height};
+    ctx->clip_stack[ctx->clip_stack_count++] = full_screen;
+    ctx->transform_stack_count = 0;
+    ctx->transform = gui_transform_identity();
+    ctx->transformed = false;
+    ctx->cull_rect = full_screen;
+    gui_update_draw_cmd(ctx);
+
+    // Update input state (edges against the previous frame, then remember this frame's state)
+    gui_input_consume_events(ctx);
+    for (int i = 0; i < GUI_MOUSE_BUTTON_COUNT; i++) {
+        ctx->input.mouse_clicked[i] = ctx->input.mouse_down[i] && !ctx->prev_input.mouse_down[i];
+        ctx->input.mouse_released[i] = !ctx->input.mouse_down[i] && ctx->prev_input.mouse_down[i];
+    }
+    ctx->prev_input = ctx->input;
+
+    // Resolve hover against last frame's interactive rects
+    ctx->layer_stack_count = 0;
+    gui_hit_resolve(ctx);
+
+    // Clear hot item if no active item
+    if (ctx->active_item == 0) {
+        ctx->hot_item = 0;
+    }
+
+    ctx->widgets_begin_time = gui_time_ms();
+    ctx->stats.begin_ms = (float)(ctx->widgets_begin_time - ctx->frame_begin_time);
+    GUI_TRACE_END();
+}
+
+void gui_end_frame(gui_context_t *ctx) {
+    GUI_TRACE_BEGIN("gui_end_frame");
+    double end_begin_time = gui_time_ms();
+    ctx->stats.widgets_ms = (float)(end_begin_time - ctx->widgets_begin_time);
+
+    gui_prim_close(ctx);
+    if (ctx->transform_stack_count > 0) {
+        ctx->input.mouse_pos = ctx->screen_mouse_pos; // Unbalanced gui_push_transform
+        ctx->transform_stack_count = 0;
+    }
+
+    // Close the last command and drop it if nothing was drawn into it
+    if (ctx->draw_command_count > 0 &&
+        ctx->draw_commands[ctx->draw_command_count - 1].type == GUI_DRAW_CMD_TRIANGLES) {
+        gui_draw_cmd_t *last = &ctx->draw_commands[ctx->draw_command_count - 1];
+        last->elem_count = ctx->index_count - last->idx_offset;
+        if (last->elem_count == 0) {
+            ctx->draw_command_count--;
+        }
+    }
+    if (ctx->reorder_commands) {
+        gui_reorder_commands(ctx);
+    }
+#ifdef CGUI_ENABLE_OPAQUE_PASS
+    if (ctx->opaque_pass) {
+        gui_opaque_build(ctx);
+    }
+#endif
+
+    gui_hit_end_frame(ctx);
+    gui_state_evict(ctx);
+
+    // Per-frame input is consumed
+    ctx->input.mouse_wheel = 0.0F;
+    ctx->input.mouse_wheel_h = 0.0F;
+    memset(ctx->input.keys_pressed, 0, sizeof(ctx->input.keys_pressed));
+    ctx->input.text_input[0] = '\0';
+
+    ctx->stats.end_ms = (float)(gui_time_ms() - end_begin_time);
+    gui_stats_publish(ctx);
+    GUI_TRACE_END();
+    GUI_TRACE_END(); // frame
+}
+
+void gui_update_input(gui_context_t *ctx, float mouse_x, float mouse_y, const bool *mouse_buttons,
+                      float mouse_wheel, float delta_time) {
+    ctx->input.mouse_pos.x = mouse_x;
+    ctx->input.mouse_pos.y = mouse_y;
+
+    for (int i = 0; i < GUI_MOUSE_BUTTON_COUNT; i++) {
+        ctx->input.mouse_down[i] = mouse_buttons[i];
+    }
+
+    ctx->input.mouse_wheel = mouse_wheel;
+    gui_update_time(ctx, delta_time);
+}
+
+void gui_update_time(gui_context_t *ctx, float delta_time) {
+    ctx->delta_time = delta_time;
+    ctx->time += delta_time;
+}
+
+// =============================================================================
+// LAYOUT SYSTEM
+// =============================================================================
+
+static gui_layout_state_t *gui_get_current_layout(gui_context_t *ctx) {
+    if (ctx->layout_stack_count == 0) {
+        return NULL;
+    }
+    return &ctx->layout_stack[ctx->layout_stack_count - 1];
+}
+
+void gui_begin_vbox(gui_context_t *ctx, float x, float y, float width, float padding,
+                    float spacing) {
+    if (ctx->layout_stack_count >= CGUI_MAX_LAYOUT_STACK) {
+        return;
+    }
+
+    gui_layout_state_t *layout = &ctx->layout_stack[ctx->layout_stack_count++];
+    layout->type = GUI_LAYOUT_VBOX;
+    layout->bounds.x = x;
+    layout->bounds.y = y;
+    layout->bounds.w = width;
+    layout->cursor_x = x + padding;
+    layout->cursor_y = y + padding;
+    layout->padding = padding;
+    layout->spacing = spacing;
+    layout->item_width = width - (padding * 2.0F);
+}
+
+void gui_end_vbox(gui_context_t *ctx) {
+    if (ctx->layout_stack_count > 0) {
+        ctx->layout_stack_count--;
+    }
+}
+
+void gui_begin_hbox(gui_context_t *ctx, float x, float y, float height, float padding,
+                    float spacing) {
+    if (ctx->layout_stack_count >= CGUI_MAX_LAYOUT_STACK) {
+        return;
+    }
+
+    gui_layout_state_t *layout = &ctx->layout_stack[ctx->layout_stack_count++];
+    layout->type = GUI_LAYOUT_HBOX;
+    layout->bounds.x = x;
+    layout->bounds.y = y;
+    layout->bounds.h = height;
+    layout->cursor_x = x + padding;
+    layout->cursor_y = y + padding;
+    layout->padding = padding;
+    layout->spacing = spacing;
+    layout->item_height = height - (padding * 2.0F);
+}
+
+void gui_end_hbox(gui_context_t *ctx) {
+    if (ctx->layout_stack_count > 0) {
+        ctx->layout_stack_count--;
+    }
+}
+
+static gui_rect_t gui_layout_next_rect(gui_context_t *ctx, float width, float height,
+                                       float default_width, float default_height);
+static gui_rect_t gui_flex_next_rect(gui_context_t *ctx, gui_layout_state_t *layout, float width,
+                                     float height, bool fixed_cross);
+
+void gui_spacing(gui_context_t *ctx, float amount) {
+    gui_layout_state_t *layout = gui_get_current_layout(ctx);
+    if (!layout) {
+        return;
+    }
+
+    if (layout->type == GUI_LAYOUT_VBOX) {
+        layout->cursor_y += amount;
+    } else if (layout->type == GUI_LAYOUT_HBOX) {
+        layout->cursor_x += amount;
+    } else if (layout->type == GUI_LAYOUT_FLEX) {
+        bool row = layout->direction == GUI_FLEX_ROW;
+        gui_flex_next_rect(ctx, layout, row ? amount : 0.0F, row ? 0.0F : amount, false);
+    }
+}
+
+// =============================================================================
+// FLEX LAYOUT
+// =============================================================================
+
+// What a child asked for; hashed to detect when the solve must rerun
+typedef struct {
+    float main_size;
+    float cross_size;
+    float weight;
+    float min_size;
+    float max_size;
+    int align;
+} gui_flex_input_t;
+
+// Where a child was placed this frame and where its output starts
+typedef struct {
+    gui_rect_t placed; // Relative to the container origin
+    gui_rect_t clip;
+    uint32_t vertex_start;
+    uint32_t hit_start;
+    uint32_t cmd_start;
+} gui_flex_record_t;
+
+struct gui_flex_cache {
+    gui_id_t hash;
+    int solved_count;
+    float content_w; // Intrinsic size of the container, from the last solve
+    float content_h;
+    gui_flex_input_t inputs[CGUI_MAX_FLEX_CHILDREN];
+    gui_rect_t solved[CGUI_MAX_FLEX_CHILDREN]; // Relative to the container origin
+    gui_flex_record_t records[CGUI_MAX_FLEX_CHILDREN];
+};
+
+static gui_id_t gui_hash_bytes(gui_id_t hash, const void *data, size_t size) {
+    const uint8_t *bytes = (const uint8_t *)data;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 16777619U;
+    }
+    return hash;
+}
+
+void gui_begin_flex(gui_context_t *ctx, const char *id, gui_flex_direction_t direction, float x,
+                    float y, float width, float height, float padding, float spacing) {
+    if (ctx->layout_stack_count >= CGUI_MAX_LAYOUT_STACK) {
+        return;
+    }
+    struct gui_flex_cache *cache = (struct gui_flex_cache *)gui_get_state(
+        ctx, gui_get_id(ctx, id), sizeof(struct gui_flex_cache));
+    if (!cache) {
+        return;
+    }
+
+    gui_rect_t rect = {x, y, (width > 0) ? width : cache->content_w,
+                       (height > 0) ? height : cache->content_h};
+    if (gui_get_current_layout(ctx)) {
+        rect = gui_layout_next_rect(ctx, width, height, cache->content_w, cache->content_h);
+    }
+
+    gui_layout_state_t *layout = &ctx->layout_stack[ctx->layout_stack_count++];
+    memset(layout, 0, sizeof(gui_layout_state_t));
+    layout->type = GUI_LAYOUT_FLEX;
+    layout->bounds = rect;
+    layout->cursor_x = rect.x + padding;
+    layout->cursor_y = rect.y + padding;
+    layout->padding = padding;
+    layout->spacing = spacing;
+    layout->flex = cache;
+    layout->direction = direction;
+}
+
+void gui_flex_item(gui_context_t *ctx, float weight, float min_size, float max_size,
+                   gui_align_t align) {
+    gui_layout_state_t *layout = gui_get_current_layout(ctx);
+    if (!layout || layout->type != GUI_LAYOUT_FLEX) {
+        return;
+    }
+    layout->item_weight = weight;
+    layout->item_min = min_size;
+    layout->item_max = max_size;
+    layout->item_align = align;
+}
+
+// Hands out the child's rect from last frame's solve. Children not solved yet are appended after
+// the previous child at their intrinsic size; gui_end_flex moves them into place.
+static gui_rect_t gui_flex_next_rect(gui_context_t *ctx, gui_layout_state_t *layout, float width,
+                                     float height, bool fixed_cross) {
+    struct gui_flex_cache *cache = layout->flex;
+    bool row = layout->direction == GUI_FLEX_ROW;
+    float padding = layout->padding;
+    int i = layout->child_count++;
+    if (i >= CGUI_MAX_FLEX_CHILDREN) {
+        // Past the limit children are not solved: they are stacked at their own size after the
+        // last solved child, and stay where they are put
+        if (i == CGUI_MAX_FLEX_CHILDREN) {
+            const gui_rect_t *last = &cache->records[i - 1].placed;
+            float after = (row ? last->x + last->w : last->y + last->h) + layout->spacing;
+            layout->cursor_x = layout->bounds.x + (row ? after : padding);
+            layout->cursor_y = layout->bounds.y + (row ? padding : after);
+        }
+        gui_rect_t rect = {layout->cursor_x, layout->cursor_y, width, height};
+        if (row) {
+            layout->cursor_x += width + layout->spacing;
+        } else {
+            layout->cursor_y += height + layout->spacing;
+        }
+        layout->item_weight = 0.0F;
+        layout->item_min = 0.0F;
+        layout->item_max = 0.0F;
+        layout->item_align = GUI_ALIGN_STRETCH;
+        return rect;
+    }
+
+    gui_flex_input_t *input = &cache->inputs[i];
+    input->main_size = row ? width : height;
+    input->cross_size = row ? height : width;
+    input->weight = layout->item_weight;
+    input->min_size = layout->item_min;
+    input->max_size = layout->item_max;
+    input->align = (fixed_cross && layout->item_align == GUI_ALIGN_STRETCH)
+                       ? (int)GUI_ALIGN_START
+                       : (int)layout->item_align;
+    layout->item_weight = 0.0F;
+    layout->item_min = 0.0F;
+    layout->item_max = 0.0F;
+    layout->item_align = GUI_ALIGN_STRETCH;
+
+    gui_rect_t rect;
+    if (i < cache->solved_count) {
+        rect = cache->solved[i];
+    } else {
+        const gui_rect_t *prev = (i > 0) ? &cache->records[i - 1].placed : NULL;
+        float cursor = padding;
+        if (prev) {
+            cursor = (row ? prev->x + prev->w : prev->y + prev->h) + layout->spacing;
+        }
+        rect = row ? (gui_rect_t){cursor, padding, width, height}
+                   : (gui_rect_t){padding, cursor, width, height};
+    }
+
+    gui_deferred_flush(ctx); // The previous child's vertices must exist to be moved
+    gui_flex_record_t *record = &cache->records[i];
+    record->placed = rect;
+    record->clip = ctx->clip_stack[ctx->clip_stack_count - 1];
+    record->vertex_start = ctx->vertex_count;
+    record->hit_start = ctx->hit_item_count;
+    // An empty open command can still be retargeted by the child's first clip push
+    record->cmd_start = ctx->draw_command_count;
+    if (ctx->draw_command_count > 0 &&
+        ctx->draw_commands[ctx->draw_command_count - 1].type == GUI_DRAW_CMD_TRIANGLES &&
+        ctx->draw_commands[ctx->draw_command_count - 1].idx_offset == ctx->index_count) {
+        record->cmd_start--;
+    }
+
+    rect.x += layout->bounds.x;
+    rect.y += layout->bounds.y;
+    return rect;
+}
+
+// Resolves main-axis sizes (weighted children grow from min_size, frozen at max_size with the
+// remainder redistributed) and cross-axis placement into cache->solved
+static void gui_flex_solve(struct gui_flex_cache *cache, int count,
+                           const gui_layout_state_t *layout) {
+    bool row = layout->direction == GUI_FLEX_ROW;
+    float padding = layout->padding;
+    float gaps = layout->spacing * (float)((count > 1) ? count - 1 : 0);
+    float main_avail = (row ? layout->bounds.w : layout->bounds.h) - (padding * 2.0F) - gaps;
+    float cross_avail = (row ? layout->bounds.h : layout->bounds.w) - (padding * 2.0F);
+
+    float sizes[CGUI_MAX_FLEX_CHILDREN];
+    bool frozen[CGUI_MAX_FLEX_CHILDREN];
+    float total_weight = 0.0F;
+    float used = 0.0F;
+    float content_main = 0.0F;
+    float content_cross = 0.0F;
+    for (int i = 0; i < count; i++) {
+        const gui_flex_input_t *input = &cache->inputs[i];
+        float max_size = (input->max_size > 0.0F) ? input->max_size : INFINITY;
+        float intrinsic = gui_clampf(input->main_size, input->min_size, max_size);
+        frozen[i] = input->weight <= 0.0F;
+        sizes[i] = frozen[i] ? intrinsic : input->min_size;
+        total_weight += frozen[i] ? 0.0F : input->weight;
+        used += sizes[i];
+        content_main += intrinsic;
+        content_cross = fmaxf(content_cross, input->cross_size);
+    }
+
+    float free_space = main_avail - used;
+    while (free_space > 0.0F && total_weight > 0.0F) {
+        float unit = free_space / total_weight;
+        bool clamped = false;
+        for (int i = 0; i < count; i++) {
+            if (frozen[i]) {
+                continue;
+            }
+            const gui_flex_input_t *input = &cache->inputs[i];
+            float max_size = (input->max_size > 0.0F) ? input->max_size : INFINITY;
+            float grow = unit * input->weight;
+            if (sizes[i] + grow >= max_size) {
+                grow = max_size - sizes[i];
+                frozen[i] = true;
+                total_weight -= input->weight;
+                clamped = true;
+            }
+            sizes[i] += grow;
+            free_space -= grow;
+        }
+        if (!clamped) {
+            break;
+        }
+    }
+
+    float cursor = padding;
+    for (int i = 0; i < count; i++) {
+        const gui_flex_input_t *input = &cache->inputs[i];
+        float cross = (input->align == GUI_ALIGN_STRETCH) ? cross_avail : input->cross_size;
+        float offset = 0.0F;
+        if (input->align == GUI_ALIGN_CENTER) {
+            offset = (cross_avail - cross) * 0.5F;
+        } else if (input->align == GUI_ALIGN_END) {
+            offset = cross_avail - cross;
+        }
+        cache->solved[i] = row ? (gui_rect_t){cursor, padding + offset, sizes[i], cross}
+                               : (gui_rect_t){padding + offset, cursor, cross, sizes[i]};
+        cursor += sizes[i] + layout->spacing;
+    }
+
+    content_main += gaps + (padding * 2.0F);
+    content_cross += padding * 2.0F;
+    cache->content_w = row ? content_main : content_cross;
+    cache->content_h = row ? content_cross : content_main;
+}
+
+// Moves a child's vertices, hit rects and the clip rects it pushed by (dx, dy), in the
+// coordinates of the current transform; hit and clip rects are in screen space
+static void gui_flex_translate(gui_context_t *ctx, const gui_flex_record_t *record,
+                               const gui_flex_record_t *next, float dx, float dy) {
+    uint32_t vertex_end = next ? next->vertex_start : ctx->vertex_count;
+    uint32_t hit_end = next ? next->hit_start : ctx->hit_item_count;
+    uint32_t cmd_end = next ? next->cmd_start : ctx->draw_command_count;
+    const float *m = ctx->transform.m;
+    float sx = (m[0] * dx) + (m[2] * dy);
+    float sy = (m[1] * dx) + (m[3] * dy);
+
+    for (uint32_t v = record->vertex_start; v < vertex_end; v++) {
+        ctx->vertices[v].pos.x += dx;
+        ctx->vertices[v].pos.y += dy;
+    }
+    for (uint32_t h = record->hit_start; h < hit_end; h++) {
+        ctx->hit_items[h].rect.x += sx;
+        ctx->hit_items[h].rect.y += sy;
+    }
+    for (uint32_t c = record->cmd_start; c < cmd_end; c++) {
+        gui_rect_t *clip = &ctx->draw_commands[c].clip_rect;
+        if (!gui_rects_equal(*clip, record->clip)) {
+            clip->x += sx;
+            clip->y += sy;
+            *clip = gui_intersect_rects(*clip, record->clip);
+        }
+    }
+}
+
+void gui_end_flex(gui_context_t *ctx) {
+    gui_layout_state_t *layout = gui_get_current_layout(ctx);
+    if (!layout || layout->type != GUI_LAYOUT_FLEX) {
+        return;
+    }
+    gui_deferred_flush(ctx);
+    struct gui_flex_cache *cache = layout->flex;
+    int count = (layout->child_count < CGUI_MAX_FLEX_CHILDREN) ? layout->child_count
+                                                               : CGUI_MAX_FLEX_CHILDREN;
+
+    // The container's position is not an input: solved rects are relative to it
+    float key[6] = {layout->bounds.w, layout->bounds.h, (float)layout->direction,
+                    layout->padding,  layout->spacing,  (float)count};
+    gui_id_t hash = gui_hash_bytes(2166136261U, key, sizeof(key));
+    hash = gui_hash_bytes(hash, cache->inputs, sizeof(gui_flex_input_t) * (size_t)count);
+
+    if (hash != cache->hash || count != cache->solved_count) {
+        gui_flex_solve(cache, count, layout);
+        cache->hash = hash;
+        cache->solved_count = count;
+
+        for (int i = 0; i < count; i++) {
+            const gui_flex_record_t *record = &cache->records[i];
+            float dx = cache->solved[i].x - record->placed.x;
+            float dy = cache->solved[i].y - record->placed.y;
+            if (dx != 0.0F || dy != 0.0F) {
+                gui_flex_translate(ctx, record, (i + 1 < count) ? record + 1 : NULL, dx, dy);
+            }
+        }
+    }
+
+    ctx->layout_stack_count--;
+}
+
+// Places the next item in the current layout and advances the cursor. Sizes <= 0 fall back to
+// the layout's item size along its cross axis and to the given defaults otherwise.
+static gui_rect_t gui_layout_next_rect(gui_context_t *ctx, float width, float height,
+                                       float default_width, float default_height) {
+    gui_layout_state_t *layout = gui_get_current_layout(ctx);
+    gui_rect_t rect = {10, 10, (width > 0) ? width : default_width,
+                       (height > 0) ? height : default_height};
+
+    if (layout) {
+        rect.x = layout->cursor_x;
+        rect.y = layout->cursor_y;
+
+        if (layout->type == GUI_LAYOUT_VBOX) {
+            rect.w = (width > 0) ? width : layout->item_width;
+            layout->cursor_y += rect.h + layout->spacing;
+        } else if (layout->type == GUI_LAYOUT_HBOX) {
+            rect.h = (height > 0) ? height : layout->item_height;
+            layout->cursor_x += rect.w + layout->spacing;
+        } else if (layout->type == GUI_LAYOUT_FLEX) {
+            bool fixed_cross = (layout->direction == GUI_FLEX_ROW) ? height > 0 : width > 0;
+            rect = gui_flex_next_rect(ctx, layout, rect.w, rect.h, fixed_cross);
+        }
+    }
+    return rect;
+}
+
+void gui_list_clipper_begin(gui_list_clipper_t *clipper, int item_count, float item_height,
+                            float scroll, float view_height) {
+    clipper->item_count = item_count;
+    clipper->item_height = item_height;
+    clipper->display_start = 0;
+    clipper->display_end = 0;
+
+    if (item_count <= 0 || item_height <= 0.0F) {
+        return;
+    }
+
+    int start = (int)floorf(scroll / item_height);
+    int end = (int)ceilf((scroll + view_height) / item_height);
+    clipper->display_start = (start < 0) ? 0 : (start > item_count ? item_count : start);
+    clipper->display_end = (end < clipper->display_start)
+                               ? clipper->display_start
+                               : (end > item_count ? item_count : end);
+}
+
+// =============================================================================
+// CACHED BLOCKS
+// =============================================================================
+
+// Output of a block's last recorded run. Vertex positions, clip and hit rects are in the
+// coordinates of that run; indices are relative to the block's first vertex and commands to its
+// first index.
+struct gui_cached_block {
+    bool valid;
+    uint32_t version;
+    gui_vec2_t origin;
+    gui_transform_t transform; // Transform at gui_begin_cached
+    gui_rect_t clip;           // Clip rect at gui_begin_cached
+    bool clipped;         // Some output was culled or lies outside `clip`
+    gui_vec2_t advance;   // Movement of the parent layout cursor
+    uint32_t prim_start;  // Primitive number of the first primitive, for rebasing depths
+    uint32_t prim_count;
+    gui_vertex_t *vertices;
+    uint32_t vertex_count;
+    uint32_t vertex_capacity;
+    uint32_t *indices;
+    uint32_t index_count;
+    uint32_t index_capacity;
+    gui_draw_cmd_t *commands;
+    uint32_t command_count;
+    uint32_t command_capacity;
+    gui_hit_item_t *hit_items;
+    uint32_t hit_item_count;
+    uint32_t hit_item_capacity;
+};
+
+static void gui_cached_block_destroy(void *data) {
+    struct gui_cached_block *block = (struct gui_cached_block *)data;
+    CGUI_FREE(block->vertices);
+    CGUI_FREE(block->indices);
+    CGUI_FREE(block->commands);
+    CGUI_FREE(block->hit_items);
+}
+
+// True when one of the block's widgets is hovered, active or focused, so it must run to react
+static bool gui_cached_block_engaged(const gui_context_t *ctx,
+                                     const struct gui_cached_block *block) {
+    for (uint32_t i = 0; i < block->hit_item_count; i++) {
+        gui_id_t id = block->hit_items[i].id;
+        if (id != 0 && (id == ctx->hovered_item || id == ctx->active_item ||
+                        id == ctx->focused_item)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Recorded output covers the clip rect: nothing visible now was clipped away while recording.
+// `moved` maps the screen space of the recording to the current one.
+static bool gui_cached_block_covers(const struct gui_cached_block *block, gui_rect_t clip,
+                                    const gui_transform_t *moved) {
+    gui_rect_t rec = gui_transform_rect(moved, block->clip);
+    return !block->clipped || clip.w <= 0.0F || clip.h <= 0.0F ||
+           (clip.x >= rec.x && clip.y >= rec.y && clip.x + clip.w <= rec.x + rec.w &&
+            clip.y + clip.h <= rec.y + rec.h);
+}
+
+// Appends the recorded output moved by (dx, dy) in local coordinates, drawn with the current
+// transform in place of the one it was recorded with. Clip rects the block pushed move with it
+// (by `moved`, in screen space) and are intersected with the current clip rect, which replaces
+// the one the block started in.
+static void gui_cached_block_replay(gui_context_t *ctx, const struct gui_cached_block *block,
+                                    gui_rect_t clip, float dx, float dy,
+                                    const gui_transform_t *moved) {
+    bool same_transform = gui_transforms_equal(&block->transform, &ctx->transform);
+    gui_transform_t retarget =
+        gui_transform_multiply(ctx->transform, gui_transform_invert(block->transform));
+    if (ctx->vertex_count + block->vertex_count <= CGUI_MAX_VERTICES &&
+        ctx->index_count + block->index_count <= CGUI_MAX_INDICES) {
+        gui_prim_close(ctx);
+        uint32_t base = ctx->vertex_count;
+#ifdef CGUI_ENABLE_OPAQUE_PASS
+        float depth_shift = ((float)ctx->prim_count - (float)block->prim_start) * GUI_DEPTH_STEP;
+#endif
+        for (uint32_t v = 0; v < block->vertex_count; v++) {
+            gui_vertex_t vertex = block->vertices[v];
+            vertex.pos.x += dx;
+            vertex.pos.y += dy;
+#ifdef CGUI_ENABLE_OPAQUE_PASS
+            vertex.depth = fmaxf(vertex.depth - depth_shift, 0.0F);
+#endif
+            ctx->vertices[ctx->vertex_count++] = vertex;
+        }
+        ctx->prim_vertex_start = ctx->vertex_count; // Depths are final
+        ctx->prim_count += block->prim_count;
+
+        for (uint32_t c = 0; c < block->command_count; c++) {
+            const gui_draw_cmd_t *cmd = &block->commands[c];
+            gui_rect_t cmd_clip = clip;
+            if (!gui_rects_equal(cmd->clip_rect, block->clip)) {
+                cmd_clip = gui_intersect_rects(gui_transform_rect(moved, cmd->clip_rect), clip);
+            }
+            gui_transform_t transform =
+                same_transform ? cmd->transform : gui_transform_multiply(retarget, cmd->transform);
+            gui_set_draw_cmd_state(ctx, cmd_clip, cmd->texture, &transform);
+            for (uint32_t i = 0; i < cmd->elem_count; i++) {
+                ctx->indices[ctx->index_count++] = block->indices[cmd->idx_offset + i] + base;
+            }
+        }
+        gui_update_draw_cmd(ctx);
+    }
+
+    if (gui_grow_array((void **)&ctx->hit_items, &ctx->hit_item_capacity,
+                       ctx->hit_item_count + block->hit_item_count, sizeof(gui_hit_item_t))) {
+        for (uint32_t h = 0; h < block->hit_item_count; h++) {
+            gui_hit_item_t item = block->hit_items[h];
+            item.rect = gui_intersect_rects(gui_transform_rect(moved, item.rect), clip);
+            if (item.rect.w > 0.0F && item.rect.h > 0.0F) {
+                ctx->hit_items[ctx->hit_item_count++] = item;
+            }
+        }
+    }
+}
+
+// Whether the clip rect the block started in cut into a recorded command: its geometry reaches
+// outside that rect, or a clip rect the block pushed was trimmed to it (touches its edge)
+static bool gui_cached_command_clipped(const struct gui_cached_block *block,
+                                       const gui_draw_cmd_t *cmd) {
+    gui_rect_t base = block->clip;
+    if (!gui_rects_equal(cmd->clip_rect, base)) {
+        gui_rect_t r = cmd->clip_rect;
+        return r.x <= base.x || r.y <= base.y || r.x + r.w >= base.x + base.w ||
+               r.y + r.h >= base.y + base.h;
+    }
+    for (uint32_t i = 0; i < cmd->elem_count; i++) {
+        gui_vec2_t pos = gui_transform_point(
+            cmd->transform, block->vertices[block->indices[cmd->idx_offset + i]].pos);
+        if (pos.x < base.x || pos.y < base.y || pos.x > base.x + base.w ||
+            pos.y > base.y + base.h) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool gui_begin_cached(gui_context_t *ctx, const char *id, uint32_t version, float x, float y) {
+    int depth = ctx->cached_stack_count++;
+    if (depth >= CGUI_MAX_CACHED_STACK) {
+        return true;
+    }
+    gui_cached_scope_t *scope = &ctx->cached_stack[depth];
+    memset(scope, 0, sizeof(gui_cached_scope_t));
+    scope->layout_index = -1;
+
+    gui_layout_state_t *layout = gui_get_current_layout(ctx);
+    if (layout && layout->type == GUI_LAYOUT_FLEX) {
+        return true; // Flex children are placed after they run
+    }
+    struct gui_cached_block *block = (struct gui_cached_block *)gui_get_state_ex(
+        ctx, gui_get_id(ctx, id), sizeof(struct gui_cached_block), gui_cached_block_destroy);
+    if (!block) {
+        return true;
+    }
+
+    if (layout) {
+        x = layout->cursor_x;
+        y = layout->cursor_y;
+    }
+    gui_rect_t clip = ctx->clip_stack[ctx->clip_stack_count - 1];
+    float dx = x - block->origin.x;
+    float dy = y - block->origin.y;
+    // Screen space of the recording to the current one: back to its local coordinates, moved,
+    // then through the current transform
+    gui_transform_t moved = gui_transform_multiply(
+        gui_transform_multiply(ctx->transform, gui_transform_translate(dx, dy)),
+        gui_transform_invert(block->transform));
+    if (block->valid && block->version == version &&
+        gui_cached_block_covers(block, clip, &moved) && !gui_cached_block_engaged(ctx, block)) {
+        gui_cached_block_replay(ctx, block, clip, dx, dy, &moved);
+        if (layout) {
+            layout->cursor_x += block->advance.x;
+            layout->cursor_y += block->advance.y;
+        }
+        ctx->stats.cached_blocks++;
+        ctx->cached_stack_count--;
+        return false;
+    }
+
+    gui_prim_close(ctx);
+    block->version = version;
+    scope->block = block;
+    scope->origin = (gui_vec2_t){x, y};
+    scope->clip = clip;
+    scope->transform = ctx->transform;
+    scope->vertex_start = ctx->vertex_count;
+    scope->index_start = ctx->index_count;
+    scope->hit_start = ctx->hit_item_count;
+    scope->prim_start = ctx->prim_count;
+    scope->culled_start = ctx->stats.culled_primitives;
+    if (layout) {
+        scope->layout_index = ctx->layout_stack_count - 1;
+        scope->cursor_x = layout->cursor_x;
+        scope->cursor_y = layout->cursor_y;
+    }
+    return true;
+}
+
+void gui_end_cached(gui_context_t *ctx) {
+    if (ctx->cached_stack_count <= 0) {
+        return;
+    }
+    int depth = --ctx->cached_stack_count;
+    if (depth >= CGUI_MAX_CACHED_STACK || !ctx->cached_stack[depth].block) {
+        return;
+    }
+    const gui_cached_scope_t *scope = &ctx->cached_stack[depth];
+    struct gui_cached_block *block = scope->block;
+    gui_prim_close(ctx);
+    if (scope->layered) {
+        block->valid = false;
+        return;
+    }
+
+    uint32_t vertex_count = ctx->vertex_count - scope->vertex_start;
+    uint32_t index_count = ctx->index_count - scope->index_start;
+    uint32_t hit_item_count = ctx->hit_item_count - scope->hit_start;
+    block->valid = false;
+    if (!gui_grow_array((void **)&block->vertices, &block->vertex_capacity, vertex_count,
+                        sizeof(gui_vertex_t)) ||
+        !gui_grow_array((void **)&block->indices, &block->index_capacity, index_count,
+                        sizeof(uint32_t)) ||
+        !gui_grow_array((void **)&block->hit_items, &block->hit_item_capacity, hit_item_count,
+                        sizeof(gui_hit_item_t))) {
+        return;
+    }
+
+    // Commands overlapping the block's indices; the last one is still open
+    block->command_count = 0;
+    for (uint32_t c = 0; c < ctx->draw_command_count; c++) {
+        const gui_draw_cmd_t *cmd = &ctx->draw_commands[c];
+        uint32_t cmd_end = (c == ctx->draw_command_count - 1 && cmd->type == GUI_DRAW_CMD_TRIANGLES)
+                               ? ctx->index_count
+                               : cmd->idx_offset + cmd->elem_count;
+        uint32_t first = (cmd->idx_offset > scope->index_start) ? cmd->idx_offset
+                                                                : scope->index_start;
+        if (cmd_end <= first) {
+            continue;
+        }
+        if (!gui_grow_array((void **)&block->commands, &block->command_capacity,
+                            block->command_count + 1, sizeof(gui_draw_cmd_t))) {
+            return;
+        }
+        block->commands[block->command_count++] =
+            (gui_draw_cmd_t){GUI_DRAW_CMD_TRIANGLES, cmd->texture, first - scope->index_start,
+                             cmd_end - first, cmd->clip_rect, cmd->transform};
+    }
+
+    if (vertex_count > 0) {
+        memcpy(block->vertices, &ctx->vertices[scope->vertex_start],
+               vertex_count * sizeof(gui_vertex_t));
+    }
+    for (uint32_t i = 0; i < index_count; i++) {
+        block->indices[i] = ctx->indices[scope->index_start + i] - scope->vertex_start;
+    }
+    if (hit_item_count > 0) {
+        memcpy(block->hit_items, &ctx->hit_items[scope->hit_start],
+               hit_item_count * sizeof(gui_hit_item_t));
+    }
+    block->vertex_count = vertex_count;
+    block->index_count = index_count;
+    block->hit_item_count = hit_item_count;
+    block->origin = scope->origin;
+    block->transform = scope->transform;
+    block->clip = scope->clip;
+    block->clipped = ctx->stats.culled_primitives != scope->culled_start;
+    for (uint32_t c = 0; c < block->command_count && !block->clipped; c++) {
+        block->clipped = gui_cached_command_clipped(block, &block->commands[c]);
+    }
+    block->prim_start = scope->prim_start;
+    block->prim_count = ctx->prim_count - scope->prim_start;
+    block->advance = (gui_vec2_t){0.0F, 0.0F};
+    if (scope->layout_index >= 0 && scope->layout_index == ctx->layout_stack_count - 1) {
+        const gui_layout_state_t *layout = &ctx->layout_stack[scope->layout_index];
+        block->advance = (gui_vec2_t){layout->cursor_x - scope->cursor_x,
+                                      layout->cursor_y - scope->cursor_y};
+    }
+
+    // Recorded with hover or press visuals: run again once they go away
+    block->valid = !gui_cached_block_engaged(ctx, block);
+}
+
+// =============================================================================
+// CACHED LAYERS
+// =============================================================================
+
+// Last rendering of a layer, which the backend keeps in a texture. Hit rects are relative to the
+// layer's origin.
+struct gui_cached_layer {
+    bool resident; // Rendered since the last invalidation; the backend holds the texture
+    uint32_t version;
+    uint32_t epoch; // ctx->layer_epoch when rendered
+    float width, height;
+    gui_transform_t transform; // Rendered at its scale and rotation; translations just move it
+    gui_vec2_t advance; // Movement of the parent layout cursor
+    gui_hit_item_t *hit_items;
+    uint32_t hit_item_count;
+    uint32_t hit_item_capacity;
+};
+
+static void gui_cached_layer_destroy(void *data) {
+    CGUI_FREE(((struct gui_cached_layer *)data)->hit_items);
+}
+
+static struct gui_cached_layer *gui_cached_layer_get(gui_context_t *ctx, gui_id_t id) {
+    return (struct gui_cached_layer *)gui_get_state_ex(ctx, id, sizeof(struct gui_cached_layer),
+                                                       gui_cached_layer_destroy);
+}
+
+static bool gui_cached_layer_engaged(const gui_context_t *ctx,
+                                     const struct gui_cached_layer *layer) {
+    for (uint32_t i = 0; i < layer->hit_item_count; i++) {
+        gui_id_t id = layer->hit_items[i].id;
+        if (id != 0 && (id == ctx->hovered_item || id == ctx->active_item ||
+                        id == ctx->focused_item)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Layer commands cannot be replayed by a cached block, so blocks around them are not recorded
+static void gui_cached_scopes_mark_layered(gui_context_t *ctx) {
+    int count = (ctx->cached_stack_count < CGUI_MAX_CACHED_STACK) ? ctx->cached_stack_count
+                                                                  : CGUI_MAX_CACHED_STACK;
+    for (int i = 0; i < count; i++) {
+        ctx->cached_stack[i].layered = true;
+    }
+}
+
+// Draws the layer's texture over `rect` (screen space) as a quad of its own command, clipped to
+// `clip`
+static void gui_cached_layer_composite(gui_context_t *ctx, gui_id_t id, gui_rect_t rect,
+                                       gui_rect_t clip) {
+    if (ctx->vertex_count + 4 > CGUI_MAX_VERTICES || ctx->index_count + 6 > CGUI_MAX_INDICES ||
+        !gui_push_layer_cmd(ctx, GUI_DRAW_CMD_LAYER_DRAW, id, clip, 6)) {
+        return;
+    }
+    gui_prim_close(ctx);
+    gui_color_t white = {255, 255, 255, 255};
+    uint32_t idx = ctx->vertex_count;
+    ctx->vertices[ctx->vertex_count++] = gui_vertex(rect.x, rect.y, 0, 0, white);
+    ctx->vertices[ctx->vertex_count++] = gui_vertex(rect.x + rect.w, rect.y, 1, 0, white);
+    ctx->vertices[ctx->vertex_count++] = gui_vertex(rect.x + rect.w, rect.y + rect.h, 1, 1, white);
+    ctx->vertices[ctx->vertex_count++] = gui_vertex(rect.x, rect.y + rect.h, 0, 1, white);
+    ctx->indices[ctx->index_count++] = idx + 0;
+    ctx->indices[ctx->index_count++] = idx + 1;
+    ctx->indices[ctx->index_count++] = idx + 2;
+    ctx->indices[ctx->index_count++] = idx + 0;
+    ctx->indices[ctx->index_count++] = idx + 2;
+    ctx->indices[ctx->index_count++] = idx + 3;
+    gui_update_draw_cmd(ctx); // Following primitives open a new command
+    gui_cached_scopes_mark_layered(ctx);
+}
+
+bool gui_begin_cached_layer(gui_context_t *ctx, const char *id, uint32_t version, float x, float y,
+                            float width, float height) {
+    gui_layout_state_t *layout = gui_get_current_layout(ctx);
+    if (ctx->layer || ctx->layer_nesting > 0 || (layout && layout->type == GUI_LAYOUT_FLEX) ||
+        width <= 0.0F || height <= 0.0F || ctx->clip_stack_count >= CGUI_MAX_CLIP_STACK) {
+        ctx->layer_nesting++;
+        return true;
+    }
+    gui_id_t layer_id = gui_get_id(ctx, id);
+    struct gui_cached_layer *layer = gui_cached_layer_get(ctx, layer_id);
+    if (!layer) {
+        ctx->layer_nesting++;
+        return true;
+    }
+
+    if (layout) {
+        x = layout->cursor_x;
+        y = layout->cursor_y;
+    }
+    // The texture covers the layer's bounds on screen
+    gui_rect_t rect = gui_transform_rect(&ctx->transform, (gui_rect_t){x, y, width, height});
+    gui_rect_t clip = ctx->clip_stack[ctx->clip_stack_count - 1];
+    if (layer->resident && layer->version == version && layer->width == width &&
+        layer->height == height && layer->epoch == ctx->layer_epoch &&
+        memcmp(layer->transform.m, ctx->transform.m, 4 * sizeof(float)) == 0 &&
+        !gui_cached_layer_engaged(ctx, layer)) {
+        gui_cached_layer_composite(ctx, layer_id, rect, clip);
+        if (gui_grow_array((void **)&ctx->hit_items, &ctx->hit_item_capacity,
+                           ctx->hit_item_count + layer->hit_item_count, sizeof(gui_hit_item_t))) {
+            for (uint32_t h = 0; h < layer->hit_item_count; h++) {
+                gui_hit_item_t item = layer->hit_items[h];
+                item.rect.x += rect.x;
+                item.rect.y += rect.y;
+                item.rect = gui_intersect_rects(item.rect, clip);
+                if (item.rect.w > 0.0F && item.rect.h > 0.0F) {
+                    ctx->hit_items[ctx->hit_item_count++] = item;
+                }
+            }
+        }
+        if (layout) {
+            layout->cursor_x += layer->advance.x;
+            layout->cursor_y += layer->advance.y;
+        }
+        ctx->stats.cached_layers++;
+        return false;
+    }
+
+    layer->resident = false;
+    if (!gui_push_layer_cmd(ctx, GUI_DRAW_CMD_LAYER_BEGIN, layer_id, rect, 0)) {
+        ctx->layer_nesting++;
+        return true;
+    }
+    gui_cached_scopes_mark_layered(ctx);
+    layer->version = version;
+    layer->width = width;
+    layer->height = height;
+    layer->transform = ctx->transform;
+    layer->epoch = ctx->layer_epoch;
+    ctx->layer = layer;
+    ctx->layer_id = layer_id;
+    ctx->layer_rect = rect;
+    ctx->layer_parent_clip = clip;
+    ctx->layer_hit_start = ctx->hit_item_count;
+    ctx->layer_layout_index = -1;
+    if (layout) {
+        ctx->layer_layout_index = ctx->layout_stack_count - 1;
+        ctx->layer_cursor_x = layout->cursor_x;
+        ctx->layer_cursor_y = layout->cursor_y;
+    }
+    // The texture holds the whole layer, whatever the parent clips away now
+    gui_push_clip_rect(ctx, x, y, width, height, false);
+    return true;
+}
+
+void gui_end_cached_layer(gui_context_t *ctx) {
+    if (ctx->layer_nesting > 0) {
+        ctx->layer_nesting--;
+        return;
+    }
+    struct gui_cached_layer *layer = ctx->layer;
+    if (!layer) {
+        return;
+    }
+    ctx->layer = NULL;
+    gui_pop_clip_rect(ctx);
+    gui_rect_t rect = ctx->layer_rect;
+    gui_rect_t clip = ctx->layer_parent_clip;
+    if (!gui_push_layer_cmd(ctx, GUI_DRAW_CMD_LAYER_END, ctx->layer_id, rect, 0)) {
+        // Out of commands: turn the layer's BEGIN into an empty draw so its content reaches the
+        // screen directly
+        for (uint32_t c = ctx->draw_command_count; c-- > 0;) {
+            gui_draw_cmd_t *cmd = &ctx->draw_commands[c];
+            if (cmd->type == GUI_DRAW_CMD_LAYER_BEGIN) {
+                *cmd = (gui_draw_cmd_t){GUI_DRAW_CMD_TRIANGLES, NULL, cmd->idx_offset, 0, clip,
+                                        gui_transform_identity()};
+                break;
+            }
+        }
+        return;
+    }
+    gui_update_draw_cmd(ctx);
+
+    // Hit rects were clipped to the layer only
+    uint32_t hit_item_count = ctx->hit_item_count - ctx->layer_hit_start;
+    layer->hit_item_count = 0;
+    if (gui_grow_array((void **)&layer->hit_items, &layer->hit_item_capacity, hit_item_count,
+                       sizeof(gui_hit_item_t))) {
+        for (uint32_t h = ctx->layer_hit_start; h < ctx->hit_item_count; h++) {
+            gui_hit_item_t item = ctx->hit_items[h];
+            item.rect.x -= rect.x;
+            item.rect.y -= rect.y;
+            layer->hit_items[layer->hit_item_count++] = item;
+            ctx->hit_items[h].rect = gui_intersect_rects(ctx->hit_items[h].rect, clip);
+        }
+    }
+    layer->advance = (gui_vec2_t){0.0F, 0.0F};
+    if (ctx->layer_layout_index >= 0 && ctx->layer_layout_index == ctx->layout_stack_count - 1) {
+        const gui_layout_state_t *layout = &ctx->layout_stack[ctx->layer_layout_index];
+        layer->advance = (gui_vec2_t){layout->cursor_x - ctx->layer_cursor_x,
+                                      layout->cursor_y - ctx->layer_cursor_y};
+    }
+
+    gui_cached_layer_composite(ctx, ctx->layer_id, rect, clip);
+    // Rendered with hover or press visuals: render again once they go away
+    layer->resident =
+        layer->hit_item_count == hit_item_count && !gui_cached_layer_engaged(ctx, layer);
+}
+
+void gui_invalidate_cached_layer(gui_context_t *ctx, gui_id_t id) {
+    struct gui_cached_layer *layer = gui_cached_layer_get(ctx, id);
+    if (layer) {
+        layer->resident = false;
+    }
+}
+
+void gui_invalidate_cached_layers(gui_context_t *ctx) { ctx->layer_epoch++; }
+
+// =============================================================================
+// DRAWING PRIMITIVES
+// =============================================================================
+
+// Checks for buffer space and switches the command state to the primitive's texture
+static inline bool gui_prim_reserve_textured(gui_context_t *ctx, gui_texture_id_t texture,
+                                             int vtx_count, int idx_count) {
+    gui_prim_close(ctx);
+    if (ctx->vertex_count + vtx_count > CGUI_MAX_VERTICES ||
+        ctx->index_count + idx_count > CGUI_MAX_INDICES) {
+        return false; // Out of space
+    }
+    if (ctx->current_texture != texture) {
+        ctx->current_texture = texture;
+        gui_update_draw_cmd(ctx);
+    }
+    return true;
+}
+
+static inline bool gui_prim_reserve(gui_context_t *ctx, int vtx_count, int idx_count) {
+    return gui_prim_reserve_textured(ctx, NULL, vtx_count, idx_count);
+}
+
+// Clip rect in the coordinates of the current transform, for culling local bounds
+static void gui_update_cull_rect(gui_context_t *ctx) {
+    gui_rect_t clip = ctx->clip_stack[ctx->clip_stack_count - 1];
+    if (ctx->transformed) {
+        gui_transform_t inverse = gui_transform_invert(ctx->transform);
+        clip = gui_transform_rect(&inverse, clip);
+    }
+    ctx->cull_rect = clip;
+}
+
+// True (and counted) when the bounds lie entirely outside the current clip rect
+static inline bool gui_prim_culled(gui_context_t *ctx, float x, float y, float w, float h) {
+    gui_rect_t clip = ctx->cull_rect;
+    if (x > clip.x + clip.w || y > clip.y + clip.h || x + w < clip.x || y + h < clip.y) {
+        ctx->stats.culled_primitives++;
+        return true;
+    }
+    return false;
+}
+
+// Output of the tessellators, which append from the given counts on. Immediate primitives write
+// at the end of the context's buffers; deferred ones (see gui_deferred_flush) at their offsets.
+typedef struct {
+    gui_vertex_t *vertices;
+    uint32_t *indices;
+    uint32_t vertex_count;
+    uint32_t index_count;
+} gui_mesh_t;
+
+static inline gui_mesh_t gui_prim_mesh(const gui_context_t *ctx) {
+    return (gui_mesh_t){ctx->vertices, ctx->indices, ctx->vertex_count, ctx->index_count};
+}
+
+static inline void gui_prim_commit(gui_context_t *ctx, const gui_mesh_t *mesh) {
+    ctx->vertex_count = mesh->vertex_count;
+    ctx->index_count = mesh->index_count;
+}
+
+static inline void gui_tess_quad(gui_mesh_t *m, float x, float y, float w, float h,
+                                 gui_vec2_t uv0, gui_vec2_t uv1, gui_color_t color) {
+    uint32_t idx = m->vertex_count;
+    gui_vertex_t *vtx = &m->vertices[idx];
+    uint32_t *out = &m->indices[m->index_count];
+
+    vtx[0] = gui_vertex(x, y, uv0.x, uv0.y, color);
+    vtx[1] = gui_vertex(x + w, y, uv1.x, uv0.y, color);
+    vtx[2] = gui_vertex(x + w, y + h, uv1.x, uv1.y, color);
+    vtx[3] = gui_vertex(x, y + h, uv0.x, uv1.y, color);
+
+    out[0] = idx + 0;
+    out[1] = idx + 1;
+    out[2] = idx + 2;
+    out[3] = idx + 0;
+    out[4] = idx + 2;
+    out[5] = idx + 3;
+    m->vertex_count += 4;
+    m->index_count += 6;
+}
+
+static void gui_prim_rect_filled(gui_context_t *ctx, float x, float y, float w, float h,
+                                 gui_color_t color) {
+    if (!gui_prim_reserve(ctx, 4, 6)) {
+        return;
+    }
+    gui_mesh_t mesh = gui_prim_mesh(ctx);
+    gui_tess_quad(&mesh, x, y, w, h, (gui_vec2_t){0, 0}, (gui_vec2_t){1, 1}, color);
+    gui_prim_commit(ctx, &mesh);
+}
+
+// Width of the alpha ramp added around antialiased shapes
+#define GUI_AA_FRINGE 1.0F
+
+static gui_color_t gui_color_transparent(gui_color_t color) {
+    color.a = 0;
+    return color;
+}
+
+// Vertex and index counts of gui_tess_convex (count >= 3)
+static void gui_convex_size(int count, bool aa, int *vtx_count, int *idx_count) {
+    *vtx_count = aa ? count * 2 : count;
+    *idx_count = ((count - 2) * 3) + (aa ? count * 6 : 0);
+}
+
+// Fills a convex polygon as a triangle fan. With antialiasing the outline is pulled in by half
+// the fringe and an outer ring fading to zero alpha is added, so the covered area is unchanged.
+static void gui_tess_convex(gui_mesh_t *m, const gui_vec2_t *points, int count, gui_color_t color,
+                            bool aa) {
+    uint32_t idx = m->vertex_count;
+    if (!aa) {
+        for (int i = 0; i < count; i++) {
+            m->vertices[m->vertex_count++] = gui_vertex(points[i].x, points[i].y, 0, 0, color);
+        }
+        for (int i = 2; i < count; i++) {
+            m->indices[m->index_count++] = idx;
+            m->indices[m->index_count++] = idx + (uint32_t)i - 1U;
+            m->indices[m->index_count++] = idx + (uint32_t)i;
+        }
+        return;
+    }
+
+    // Pick the normal sign from the winding so the fringe always goes outward
+    float area = 0.0F;
+    for (int i = 0; i < count; i++) {
+        const gui_vec2_t *a = &points[i];
+        const gui_vec2_t *b = &points[(i + 1) % count];
+        area += (a->x * b->y) - (b->x * a->y);
+    }
+    float sign = (area < 0.0F) ? -1.0F : 1.0F;
+
+    // Vertex 2i is the inner (opaque) point, 2i + 1 the outer (transparent) one
+    gui_color_t fade = gui_color_transparent(color);
+    float half = GUI_AA_FRINGE * 0.5F;
+    for (int i = 0; i < count; i++) {
+        const gui_vec2_t *prev = &points[(i + count - 1) % count];
+        const gui_vec2_t *cur = &points[i];
+        const gui_vec2_t *next = &points[(i + 1) % count];
+        float d0x = cur->x - prev->x;
+        float d0y = cur->y - prev->y;
+        float d1x = next->x - cur->x;
+        float d1y = next->y - cur->y;
+        float l0 = sqrtf((d0x * d0x) + (d0y * d0y));
+        float l1 = sqrtf((d1x * d1x) + (d1y * d1y));
+        l0 = (l0 > 0.0F) ? sign / l0 : 0.0F;
+        l1 = (l1 > 0.0F) ? sign / l1 : 0.0F;
+
+        // Average the edge normals and scale to keep the fringe width at the corner, limited
+        // to avoid spikes at sharp corners
+        float nx = ((d0y * l0) + (d1y * l1)) * 0.5F;
+        float ny = ((-d0x * l0) + (-d1x * l1)) * 0.5F;
+        float len2 = (nx * nx) + (ny * ny);
+        float scale = half / fmaxf(len2, 0.25F);
+        nx *= scale;
+        ny *= scale;
+
+        m->vertices[m->vertex_count++] = gui_vertex(cur->x - nx, cur->y - ny, 0, 0, color);
+        m->vertices[m->vertex_count++] = gui_vertex(cur->x + nx, cur->y + ny, 0, 0, fade);
+    }
+
+    for (int i = 2; i < count; i++) {
+        m->indices[m->index_count++] = idx;
+        m->indices[m->index_count++] = idx + ((uint32_t)i - 1U) * 2U;
+        m->indices[m->index_count++] = idx + (uint32_t)i * 2U;
+    }
+    for (int i = 0; i < count; i++) {
+        uint32_t a = idx + ((uint32_t)i * 2U);
+        uint32_t b = idx + ((uint32_t)((i + 1) % count) * 2U);
+        m->indices[m->index_count++] = a + 0;
+        m->indices[m->index_count++] = b + 0;
+        m->indices[m->index_count++] = b + 1;
+        m->indices[m->index_count++] = a + 0;
+        m->indices[m->index_count++] = b + 1;
+        m->indices[m->index_count++] = a + 1;
+    }
+}
+
+static void gui_prim_convex_filled(gui_context_t *ctx, const gui_vec2_t *points, int count,
+                                   gui_color_t color) {
+    bool aa = ctx->style.anti_aliased_shapes;
+    int vtx_count;
+    int idx_count;
+    gui_convex_size(count, aa, &vtx_count, &idx_count);
+    if (count < 3 || !gui_prim_reserve(ctx, vtx_count, idx_count)) {
+        return;
+    }
+    gui_mesh_t mesh = gui_prim_mesh(ctx);
+    gui_tess_convex(&mesh, points, count, color, aa);
+    gui_prim_commit(ctx, &mesh);
+}
+
+// Vertex and index counts of gui_tess_stroke (count >= 2)
+static void gui_stroke_size(int count, bool closed, bool aa, int *vtx_count, int *idx_count) {
+    *vtx_count = count * (aa ? 4 : 2);
+    *idx_count = (closed ? count : count - 1) * (aa ? 18 : 6);
+}
+
+// Half width of a stroke's solid core: with antialiasing the fringe takes half a fringe of it,
+// and strokes thinner than the fringe fade the color instead
+static inline float gui_stroke_core(gui_color_t *color, float thickness, bool aa) {
+    if (!aa) {
+        return thickness * 0.5F;
+    }
+    if (thickness < GUI_AA_FRINGE) {
+        color->a = (uint8_t)((float)color->a * (thickness / GUI_AA_FRINGE));
+    }
+    return fmaxf((thickness * 0.5F) - (GUI_AA_FRINGE * 0.5F), 0.0F);
+}
+
+// Writes a stroke point's vertices: the core pair, then (with antialiasing) the fringe pair
+static inline gui_vertex_t *gui_stroke_point(gui_vertex_t *vtx, gui_vec2_t p, float nx, float ny,
+                                             float core, float outer, gui_color_t color,
+                                             gui_color_t fade, bool aa) {
+    *vtx++ = gui_vertex(p.x + (nx * core), p.y + (ny * core), 0, 0, color);
+    *vtx++ = gui_vertex(p.x - (nx * core), p.y - (ny * core), 0, 0, color);
+    if (aa) {
+        *vtx++ = gui_vertex(p.x + (nx * outer), p.y + (ny * outer), 0, 0, fade);
+        *vtx++ = gui_vertex(p.x - (nx * outer), p.y - (ny * outer), 0, 0, fade);
+    }
+    return vtx;
+}
+
+// Writes the quads between two stroke points: the core, then (with antialiasing) the two fringe
+// strips
+static inline uint32_t *gui_stroke_quads(uint32_t *out, uint32_t a, uint32_t b, bool aa) {
+    static const uint8_t strips[3][2] = {{0, 1}, {2, 0}, {1, 3}};
+    for (int s = 0; s < (aa ? 3 : 1); s++) {
+        uint32_t p = strips[s][0];
+        uint32_t q = strips[s][1];
+        *out++ = a + p;
+        *out++ = b + p;
+        *out++ = b + q;
+        *out++ = a + p;
+        *out++ = b + q;
+        *out++ = a + q;
+    }
+    return out;
+}
+
+// Strokes an open or closed polyline. Each point gets a pair of vertices offset along the
+// averaged normal of the adjacent segments so consecutive segments share their joint vertices.
+// With antialiasing every side gains a transparent outer vertex one fringe further out; strokes
+// thinner than the fringe collapse the solid core and fade the color instead.
+static void gui_tess_stroke(gui_mesh_t *m, const gui_vec2_t *points, int count, gui_color_t color,
+                            float thickness, bool closed, bool aa) {
+    int segments = closed ? count : count - 1;
+    uint32_t per_point = aa ? 4U : 2U;
+
+    // Written through locals: the color bytes may alias the mesh counts, which would otherwise
+    // be reloaded after every store
+    uint32_t idx = m->vertex_count;
+    gui_vertex_t *vtx = &m->vertices[m->vertex_count];
+    uint32_t *out = &m->indices[m->index_count];
+    gui_color_t fade = gui_color_transparent(color);
+    float half = gui_stroke_core(&color, thickness, aa);
+
+    for (int i = 0; i < count; i++) {
+        bool joint = closed || (i > 0 && i < count - 1);
+        const gui_vec2_t *prev = &points[(i > 0) ? i - 1 : (closed ? count - 1 : i)];
+        const gui_vec2_t *next = &points[(i < count - 1) ? i + 1 : (closed ? 0 : i)];
+        float dx = next->x - prev->x;
+        float dy = next->y - prev->y;
+        float len = sqrtf((dx * dx) + (dy * dy));
+        float nx = (len > 0.0F) ? -dy / len : 0.0F;
+        float ny = (len > 0.0F) ? dx / len : 0.0F;
+
+        // Widen the joint to keep the stroke width, limited to avoid spikes at sharp turns
+        float miter = 1.0F;
+        if (joint) {
+            float sx = points[i].x - prev->x;
+            float sy = points[i].y - prev->y;
+            float slen = sqrtf((sx * sx) + (sy * sy));
+            if (slen > 0.0F) {
+                float cos_half = fabsf((nx * -sy / slen) + (ny * sx / slen));
+                miter = 1.0F / fmaxf(cos_half, 0.5F);
+            }
+        }
+
+        vtx = gui_stroke_point(vtx, points[i], nx, ny, half * miter,
+                               (half + GUI_AA_FRINGE) * miter, color, fade, aa);
+    }
+
+    // Quads between consecutive points
+    for (int i = 0; i < segments; i++) {
+        uint32_t a = idx + ((uint32_t)i * per_point);
+        uint32_t b = (i + 1 < count) ? a + per_point : idx; // Closed strokes wrap to the start
+        out = gui_stroke_quads(out, a, b, aa);
+    }
+    m->vertex_count = idx + ((uint32_t)count * per_point);
+    m->index_count += (uint32_t)segments * (aa ? 18U : 6U);
+}
+
+// Single segment (gui_add_line): gui_tess_stroke of two points, whose ends share the normal
+static inline void gui_tess_segment(gui_mesh_t *m, gui_vec2_t p0, gui_vec2_t p1,
+                                    gui_color_t color, float thickness, bool aa) {
+    gui_color_t fade = gui_color_transparent(color);
+    float half = gui_stroke_core(&color, thickness, aa);
+    float dx = p1.x - p0.x;
+    float dy = p1.y - p0.y;
+    float len = sqrtf((dx * dx) + (dy * dy));
+    float nx = (len > 0.0F) ? -dy / len : 0.0F;
+    float ny = (len > 0.0F) ? dx / len : 0.0F;
+    float outer = half + GUI_AA_FRINGE;
+
+    uint32_t idx = m->vertex_count;
+    gui_vertex_t *vtx = gui_stroke_point(&m->vertices[idx], p0, nx, ny, half, outer, color, fade,
+                                         aa);
+    gui_stroke_point(vtx, p1, nx, ny, half, outer, color, fade, aa);
+    gui_stroke_quads(&m->indices[m->index_count], idx, idx + (aa ? 4U : 2U), aa);
+    m->vertex_count += aa ? 8U : 4U;
+    m->index_count += aa ? 18U : 6U;
+}
+
+static void gui_prim_stroke(gui_context_t *ctx, const gui_vec2_t *points, int count,
+                            gui_color_t color, float thickness, bool closed, bool aa) {
+    int vtx_count;
+    int idx_count;
+    gui_stroke_size(count, closed, aa, &vtx_count, &idx_count);
+    if (count < 2 || !gui_prim_reserve(ctx, vtx_count, idx_count)) {
+        return;
+    }
+    gui_mesh_t mesh = gui_prim_mesh(ctx);
+    gui_tess_stroke(&mesh, points, count, color, thickness, closed, aa);
+    gui_prim_commit(ctx, &mesh);
+}
+
+// Points on a circle, segment count fixed to match the previous tessellation
+#define GUI_CIRCLE_SEGMENTS 32
+
+static void gui_circle_points(gui_vec2_t *points, float cx, float cy, float radius) {
+    for (int i = 0; i < GUI_CIRCLE_SEGMENTS; i++) {
+        float angle = ((float)i / (float)GUI_CIRCLE_SEGMENTS) * 2.0F * 3.14159265359F;
+        points[i] = (gui_vec2_t){cx + (cosf(angle) * radius), cy + (sinf(angle) * radius)};
+    }
+}
+
+// =============================================================================
+// DEFERRED TESSELLATION
+// =============================================================================
+
+typedef enum {
+    GUI_DEFERRED_CLIP, // Clip rect of the commands that follow
+    GUI_DEFERRED_RECT,
+    GUI_DEFERRED_IMAGE,
+    GUI_DEFERRED_TRIANGLE,
+    GUI_DEFERRED_LINE,
+    GUI_DEFERRED_POLYLINE,
+    GUI_DEFERRED_CIRCLE,
+    GUI_DEFERRED_CIRCLE_FILLED,
+    GUI_DEFERRED_TEXT,
+} gui_deferred_type_t;
+
+typedef struct {
+    gui_vec2_t p[3];
+    uint32_t count;
+    float thickness;
+} gui_deferred_points_t;
+
+typedef struct {
+    const gui_vec2_t *points; // Copy in the frame arena
+    uint32_t count;
+    float thickness;
+} gui_deferred_polyline_t;
+
+typedef struct {
+    float cx, cy, radius;
+    float thickness;
+} gui_deferred_circle_t;
+
+typedef struct {
+    gui_rect_t rect;
+    gui_vec2_t uv0, uv1;
+    gui_texture_id_t texture;
+} gui_deferred_image_t;
+
+typedef struct {
+    const char *chars; // Copy in the frame arena, not terminated
+    uint32_t len;
+    float x, y, size;
+    uint32_t first; // Set when placed: first character inside the clip rect
+    uint32_t quads; // Set when placed: characters drawn from `first` on
+} gui_deferred_text_t;
+
+// One gui_add_* call (or clip change) recorded for tessellation at the next flush
+typedef struct {
+    uint8_t type; // gui_deferred_type_t
+    bool aa;
+    bool placed; // Set by the flush when the output fits the buffers
+    gui_color_t color;
+    uint32_t vertex_offset; // Placement in the context's buffers
+    uint32_t index_offset;
+    uint32_t prim; // Number of the first primitive, for depth
+    union {
+        gui_rect_t clip;
+        gui_rect_t rect;
+        gui_deferred_image_t image;
+        gui_deferred_points_t points; // LINE (2) and TRIANGLE (3)
+        gui_deferred_polyline_t polyline;
+        gui_deferred_circle_t circle;
+        gui_deferred_text_t text;
+    };
+} gui_deferred_cmd_t;
+
+// Commands are stored in arena blocks; each block is one tessellation task
+struct gui_deferred_block {
+    struct gui_deferred_block *next;
+    uint32_t count;
+    gui_deferred_cmd_t commands[CGUI_DEFERRED_BLOCK_SIZE];
+};
+
+static gui_deferred_cmd_t *gui_deferred_append(gui_context_t *ctx, gui_deferred_type_t type) {
+    struct gui_deferred_block *block = ctx->deferred_tail;
+    if (!block || block->count == CGUI_DEFERRED_BLOCK_SIZE) {
+        block = (struct gui_deferred_block *)gui_alloc(&ctx->allocator,
+                                                        sizeof(struct gui_deferred_block));
+        if (!block) {
+            return NULL;
+        }
+        block->next = NULL;
+        block->count = 0;
+        if (ctx->deferred_tail) {
+            ctx->deferred_tail->next = block;
+        } else {
+            ctx->deferred_head = block;
+        }
+        ctx->deferred_tail = block;
+    }
+    gui_deferred_cmd_t *cmd = &block->commands[block->count++];
+    memset(cmd, 0, sizeof(gui_deferred_cmd_t));
+    cmd->type = (uint8_t)type;
+    return cmd;
+}
+
+// Records a command, preceded by a clip change when the clip rect moved since the last one.
+// Returns NULL when the arena is full.
+static gui_deferred_cmd_t *gui_deferred_record(gui_context_t *ctx, gui_deferred_type_t type,
+                                               gui_color_t color) {
+    gui_rect_t clip = ctx->clip_stack[ctx->clip_stack_count - 1];
+    if (!ctx->deferred_tail || !gui_rects_equal(clip, ctx->deferred_clip)) {
+        gui_deferred_cmd_t *change = gui_deferred_append(ctx, GUI_DEFERRED_CLIP);
+        if (!change) {
+            return NULL;
+        }
+        change->clip = clip;
+        ctx->deferred_clip = clip;
+    }
+    gui_deferred_cmd_t *cmd = gui_deferred_append(ctx, type);
+    if (cmd) {
+        cmd->color = color;
+    }
+    return cmd;
+}
+
+// Records a command in deferred mode. Returns NULL when not deferring, under a transform or when
+// the arena is full: the caller then draws immediately, which flushes the recorded commands first
+// to keep the order. Only the mode check is inline, in every gui_add_* call.
+static inline gui_deferred_cmd_t *gui_deferred_push(gui_context_t *ctx, gui_deferred_type_t type,
+                                                    gui_color_t color) {
+    if (!ctx->deferred || ctx->transformed) {
+        return NULL;
+    }
+    return gui_deferred_record(ctx, type, color);
+}
+
+// Sizes a command's output; text runs are culled character by character here, as
+// gui_add_rect_filled does for immediate text
+static void gui_deferred_size(gui_context_t *ctx, gui_deferred_cmd_t *cmd, gui_rect_t clip,
+                              int *vtx_count, int *idx_count) {
+    *vtx_count = 4;
+    *idx_count = 6;
+    switch ((gui_deferred_type_t)cmd->type) {
+    case GUI_DEFERRED_TRIANGLE:
+        gui_convex_size(3, cmd->aa, vtx_count, idx_count);
+        break;
+    case GUI_DEFERRED_CIRCLE_FILLED:
+        gui_convex_size(GUI_CIRCLE_SEGMENTS, cmd->aa, vtx_count, idx_count);
+        break;
+    case GUI_DEFERRED_LINE:
+        gui_stroke_size(2, false, cmd->aa, vtx_count, idx_count);
+        break;
+    case GUI_DEFERRED_POLYLINE:
+        gui_stroke_size((int)cmd->polyline.count, false, cmd->aa, vtx_count, idx_count);
+        break;
+    case GUI_DEFERRED_CIRCLE:
+        gui_stroke_size(GUI_CIRCLE_SEGMENTS, true, cmd->aa, vtx_count, idx_count);
+        break;
+    case GUI_DEFERRED_TEXT: {
+        gui_deferred_text_t *text = &cmd->text;
+        float char_width = text->size * 0.6F;
+        text->first = text->len;
+        text->quads = 0;
+        for (uint32_t i = 0; i < text->len; i++) {
+            if (text->chars[i] == ' ') {
+                continue;
+            }
+            float x = text->x + ((float)i * char_width);
+            if (x > clip.x + clip.w || x + (char_width * 0.8F) < clip.x) {
+                ctx->stats.culled_primitives++;
+                continue;
+            }
+            text->first = (text->quads == 0) ? i : text->first;
+            text->quads++;
+        }
+        *vtx_count = (int)text->quads * 4;
+        *idx_count = (int)text->quads * 6;
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+// Writes a placed command at its offsets, with its final depths (with opaque_pass set)
+static void gui_deferred_tessellate(gui_context_t *ctx, const gui_deferred_cmd_t *cmd) {
+    gui_mesh_t mesh = {ctx->vertices, ctx->indices, cmd->vertex_offset, cmd->index_offset};
+    gui_vec2_t points[GUI_CIRCLE_SEGMENTS];
+    switch ((gui_deferred_type_t)cmd->type) {
+    case GUI_DEFERRED_RECT:
+        gui_tess_quad(&mesh, cmd->rect.x, cmd->rect.y, cmd->rect.w, cmd->rect.h,
+                      (gui_vec2_t){0, 0}, (gui_vec2_t){1, 1}, cmd->color);
+        break;
+    case GUI_DEFERRED_IMAGE:
+        gui_tess_quad(&mesh, cmd->image.rect.x, cmd->image.rect.y, cmd->image.rect.w,
+                      cmd->image.rect.h, cmd->image.uv0, cmd->image.uv1, cmd->color);
+        break;
+    case GUI_DEFERRED_TRIANGLE:
+        gui_tess_convex(&mesh, cmd->points.p, 3, cmd->color, cmd->aa);
+        break;
+    case GUI_DEFERRED_LINE:
+        gui_tess_segment(&mesh, cmd->points.p[0], cmd->points.p[1], cmd->color,
+                         cmd->points.thickness, cmd->aa);
+        break;
+    case GUI_DEFERRED_POLYLINE:
+        gui_tess_stroke(&mesh, cmd->polyline.points, (int)cmd->polyline.count, cmd->color,
+                        cmd->polyline.thickness, false, cmd->aa);
+        break;
+    case GUI_DEFERRED_CIRCLE:
+    case GUI_DEFERRED_CIRCLE_FILLED:
+        gui_circle_points(points, cmd->circle.cx, cmd->circle.cy, cmd->circle.radius);
+        if (cmd->type == GUI_DEFERRED_CIRCLE) {
+            gui_tess_stroke(&mesh, points, GUI_CIRCLE_SEGMENTS, cmd->color,
+                            cmd->circle.thickness, true, cmd->aa);
+        } else {
+            gui_tess_convex(&mesh, points, GUI_CIRCLE_SEGMENTS, cmd->color, cmd->aa);
+        }
+        break;
+    case GUI_DEFERRED_TEXT: {
+        // One primitive per character, as immediate text draws them
+        const gui_deferred_text_t *text = &cmd->text;
+        float char_width = text->size * 0.6F;
+#ifdef CGUI_ENABLE_OPAQUE_PASS
+        uint32_t prim = cmd->prim;
+#endif
+        for (uint32_t i = text->first, drawn = 0; drawn < text->quads; i++) {
+            if (text->chars[i] == ' ') {
+                continue;
+            }
+#ifdef CGUI_ENABLE_OPAQUE_PASS
+            uint32_t start = mesh.vertex_count;
+#endif
+            gui_tess_quad(&mesh, text->x + ((float)i * char_width), text->y, char_width * 0.8F,
+                          text->size, (gui_vec2_t){0, 0}, (gui_vec2_t){1, 1}, cmd->color);
+#ifdef CGUI_ENABLE_OPAQUE_PASS
+            if (ctx->opaque_pass) {
+                float depth = fmaxf(1.0F - ((float)prim++ * GUI_DEPTH_STEP), 0.0F);
+                for (uint32_t v = start; v < mesh.vertex_count; v++) {
+                    ctx->vertices[v].depth = depth;
+                }
+            }
+#endif
+            drawn++;
+        }
+        return;
+    }
+    default:
+        return;
+    }
+#ifdef CGUI_ENABLE_OPAQUE_PASS
+    if (!ctx->opaque_pass) {
+        return;
+    }
+    float depth = fmaxf(1.0F - ((float)cmd->prim * GUI_DEPTH_STEP), 0.0F);
+    for (uint32_t v = cmd->vertex_offset; v < mesh.vertex_count; v++) {
+        ctx->vertices[v].depth = depth;
+    }
+#endif
+}
+
+typedef struct {
+    gui_context_t *ctx;
+    struct gui_deferred_block **blocks;
+} gui_deferred_job_t;
+
+static void gui_deferred_task(void *data, uint32_t index) {
+    const gui_deferred_job_t *job = (const gui_deferred_job_t *)data;
+    const struct gui_deferred_block *block = job->blocks[index];
+    for (uint32_t i = 0; i < block->count; i++) {
+        if (block->commands[i].placed) {
+            gui_deferred_tessellate(job->ctx, &block->commands[i]);
+        }
+    }
+}
+
+// Tessellates the recorded commands. A serial pass sizes each command and hands out vertex,
+// index and primitive offsets in recording order (a prefix sum), building the draw commands as
+// immediate drawing would; the blocks are then tessellated independently, through parallel_for
+// when set, into their reserved ranges, so the output does not depend on the task order.
+static void gui_deferred_flush(gui_context_t *ctx) {
+    struct gui_deferred_block *head = ctx->deferred_head;
+    if (!head) {
+        return;
+    }
+    ctx->deferred_head = NULL;
+    ctx->deferred_tail = NULL;
+    gui_prim_close(ctx); // Ends the immediate primitive drawn before the recorded ones
+
+    uint32_t block_count = 0;
+    gui_rect_t clip = ctx->clip_stack[ctx->clip_stack_count - 1];
+    gui_transform_t identity = gui_transform_identity(); // Only untransformed draws are deferred
+    for (struct gui_deferred_block *block = head; block; block = block->next) {
+        block_count++;
+        for (uint32_t i = 0; i < block->count; i++) {
+            gui_deferred_cmd_t *cmd = &block->commands[i];
+            if (cmd->type == GUI_DEFERRED_CLIP) {
+                clip = cmd->clip;
+                continue;
+            }
+            int vtx_count;
+            int idx_count;
+            gui_deferred_size(ctx, cmd, clip, &vtx_count, &idx_count);
+            if (vtx_count == 0) {
+                continue;
+            }
+            if (ctx->vertex_count + (uint32_t)vtx_count > CGUI_MAX_VERTICES ||
+                ctx->index_count + (uint32_t)idx_count > CGUI_MAX_INDICES) {
+                continue; // Out of space: dropped without opening a command for it
+            }
+            gui_texture_id_t texture =
+                (cmd->type == GUI_DEFERRED_IMAGE) ? cmd->image.texture : NULL;
+            ctx->current_texture = texture;
+            gui_set_draw_cmd_state(ctx, clip, texture, &identity);
+            cmd->placed = true;
+            cmd->vertex_offset = ctx->vertex_count;
+            cmd->index_offset = ctx->index_count;
+            cmd->prim = ctx->prim_count + 1U;
+            ctx->prim_count += (cmd->type == GUI_DEFERRED_TEXT) ? cmd->text.quads : 1U;
+            ctx->vertex_count += (uint32_t)vtx_count;
+            ctx->index_count += (uint32_t)idx_count;
+        }
+    }
+    ctx->prim_vertex_start = ctx->vertex_count; // The tasks write the depths
+
+    gui_deferred_job_t job = {ctx, (struct gui_deferred_block **)gui_alloc(
+                                       &ctx->allocator, block_count * sizeof(void *))};
+    if (job.blocks && ctx->parallel_for && block_count > 1) {
+        uint32_t b = 0;
+        for (struct gui_deferred_block *block = head; block; block = block->next) {
+            job.blocks[b++] = block;
+        }
+        ctx->parallel_for(ctx->parallel_pool, block_count, gui_deferred_task, &job);
+    } else {
+        for (struct gui_deferred_block *block = head; block; block = block->next) {
+            job.blocks = &block;
+            gui_deferred_task(&job, 0);
+        }
+    }
+    gui_update_draw_cmd(ctx); // Back to the clip stack and current texture
+}
+
+// =============================================================================
+// DRAW API
+// =============================================================================
+
+void gui_add_rect_filled(gui_context_t *ctx, float x, float y, float w, float h,
+                         gui_color_t color) {
+    if (gui_prim_culled(ctx, x, y, w, h)) {
+        return;
+    }
+    gui_deferred_cmd_t *cmd = gui_deferred_push(ctx, GUI_DEFERRED_RECT, color);
+    if (cmd) {
+        cmd->rect = (gui_rect_t){x, y, w, h};
+        return;
+    }
+    gui_prim_rect_filled(ctx, x, y, w, h, color);
+}
+
+void gui_add_rect(gui_context_t *ctx, float x, float y, float w, float h, gui_color_t color,
+                  float thickness) {
+    float half = thickness * 0.5F;
+    if (gui_prim_culled(ctx, x - half, y - half, w + thickness, h + thickness)) {
+        return;
+    }
+
+    // Draw four lines to form a rectangle
+    gui_add_line(ctx, x, y, x + w, y, color, thickness);
+    gui_add_line(ctx, x + w, y, x + w, y + h, color, thickness);
+    gui_add_line(ctx, x + w, y + h, x, y + h, color, thickness);
+    gui_add_line(ctx, x, y + h, x, y, color, thickness);
+}
+
+void gui_add_line(gui_context_t *ctx, float x1, float y1, float x2, float y2, gui_color_t color,
+                  float thickness) {
+    float dx = x2 - x1;
+    float dy = y2 - y1;
+    if (sqrtf((dx * dx) + (dy * dy)) < 0.001F) {
+        return;
+    }
+
+    bool aa = ctx->style.anti_aliased_shapes;
+    gui_deferred_cmd_t *cmd = gui_deferred_push(ctx, GUI_DEFERRED_LINE, color);
+    if (cmd) {
+        cmd->aa = aa;
+        cmd->points = (gui_deferred_points_t){{{x1, y1}, {x2, y2}}, 2, thickness};
+        return;
+    }
+    int vtx_count;
+    int idx_count;
+    gui_stroke_size(2, false, aa, &vtx_count, &idx_count);
+    if (!gui_prim_reserve(ctx, vtx_count, idx_count)) {
+        return;
+    }
+    gui_mesh_t mesh = gui_prim_mesh(ctx);
+    gui_tess_segment(&mesh, (gui_vec2_t){x1, y1}, (gui_vec2_t){x2, y2}, color, thickness, aa);
+    gui_prim_commit(ctx, &mesh);
+}
+
+void gui_add_circle_filled(gui_context_t *ctx, float cx, float cy, float radius,
+                           gui_color_t color) {
+    if (gui_prim_culled(ctx, cx - radius, cy - radius, radius * 2.0F, radius * 2.0F)) {
+        return;
+    }
+    gui_deferred_cmd_t *cmd = gui_deferred_push(ctx, GUI_DEFERRED_CIRCLE_FILLED, color);
+    if (cmd) {
+        cmd->aa = ctx->style.anti_aliased_shapes;
+        cmd->circle = (gui_deferred_circle_t){cx, cy, radius, 0.0F};
+        return;
+    }
+
+    gui_vec2_t points[GUI_CIRCLE_SEGMENTS];
+    gui_circle_points(points, cx, cy, radius);
+    gui_prim_convex_filled(ctx, points, GUI_CIRCLE_SEGMENTS, color);
+}
+
+void gui_add_circle(gui_context_t *ctx, float cx, float cy, float radius, gui_color_t color,
+                    float thickness) {
+    float outer = radius + (thickness * 0.5F) + GUI_AA_FRINGE;
+    if (gui_prim_culled(ctx, cx - outer, cy - outer, outer * 2.0F, outer * 2.0F)) {
+        return;
+    }
+    gui_deferred_cmd_t *cmd = gui_deferred_push(ctx, GUI_DEFERRED_CIRCLE, color);
+    if (cmd) {
+        cmd->aa = ctx->style.anti_aliased_shapes;
+        cmd->circle = (gui_deferred_circle_t){cx, cy, radius, thickness};
+        return;
+    }
+
+    gui_vec2_t points[GUI_CIRCLE_SEGMENTS];
+    gui_circle_points(points, cx, cy, radius);
+    gui_prim_stroke(ctx, points, GUI_CIRCLE_SEGMENTS, color, thickness, true,
+                    ctx->style.anti_aliased_shapes);
+}
+
+void gui_add_triangle_filled(gui_context_t *ctx, float x1, float y1, float x2, float y2, float x3,
+                             float y3, gui_color_t color) {
+    gui_deferred_cmd_t *cmd = gui_deferred_push(ctx, GUI_DEFERRED_TRIANGLE, color);
+    if (cmd) {
+        cmd->aa = ctx->style.anti_aliased_shapes;
+        cmd->points = (gui_deferred_points_t){{{x1, y1}, {x2, y2}, {x3, y3}}, 3, 0.0F};
+        return;
+    }
+    gui_vec2_t points[3] = {{x1, y1}, {x2, y2}, {x3, y3}};
+    gui_prim_convex_filled(ctx, points, 3, color);
+}
+
+void gui_add_polyline(gui_context_t *ctx, const gui_vec2_t *points, int count, gui_color_t color,
+                      float thickness) {
+    if (count < 2) {
+        return;
+    }
+    // The points are copied: the caller's array may be gone when the command is tessellated
+    gui_vec2_t *copy = ctx->deferred ? (gui_vec2_t *)gui_alloc(&ctx->allocator,
+                                                                (size_t)count * sizeof(gui_vec2_t))
+                                     : NULL;
+    gui_deferred_cmd_t *cmd = copy ? gui_deferred_push(ctx, GUI_DEFERRED_POLYLINE, color) : NULL;
+    if (cmd) {
+        memcpy(copy, points, (size_t)count * sizeof(gui_vec2_t));
+        cmd->aa = ctx->style.anti_aliased_shapes;
+        cmd->polyline = (gui_deferred_polyline_t){copy, (uint32_t)count, thickness};
+        return;
+    }
+    gui_prim_stroke(ctx, points, count, color, thickness, false, ctx->style.anti_aliased_shapes);
+}
+
+void gui_add_image(gui_context_t *ctx, gui_texture_id_t texture, float x, float y, float w, float h,
+                   gui_vec2_t uv0, gui_vec2_t uv1, gui_color_t tint) {
+    if (gui_prim_culled(ctx, x, y, w, h)) {
+        return;
+    }
+    gui_deferred_cmd_t *cmd = gui_deferred_push(ctx, GUI_DEFERRED_IMAGE, tint);
+    if (cmd) {
+        cmd->image = (gui_deferred_image_t){{x, y, w, h}, uv0, uv1, texture};
+        return;
+    }
+    if (!gui_prim_reserve_textured(ctx, texture, 4, 6)) {
+        return;
+    }
+    gui_mesh_t mesh = gui_prim_mesh(ctx);
+    gui_tess_quad(&mesh, x, y, w, h, uv0, uv1, tint);
+    gui_prim_commit(ctx, &mesh);
+}
+
+void gui_add_text_n(gui_context_t *ctx, const char *text, size_t len, float x, float y,
+                    gui_color_t color, float font_size) {
+    // MVP: Simple text rendering using rectangles (placeholder for actual font rendering)
+    float char_width = font_size * 0.6F;
+    float char_height = font_size;
+
+    // Whole lines above or below the clip rect are skipped without walking the string
+    if (gui_prim_culled(ctx, x, y, INFINITY, char_height)) {
+        return;
+    }
+
+    // Deferred runs keep a copy of the text; characters are culled when the run is placed
+    size_t n = 0;
+    while (ctx->deferred && n < len && text[n]) {
+        n++;
+    }
+    char *copy = (n > 0) ? (char *)gui_alloc(&ctx->allocator, n) : NULL;
+    gui_deferred_cmd_t *cmd = copy ? gui_deferred_push(ctx, GUI_DEFERRED_TEXT, color) : NULL;
+    if (cmd) {
+        memcpy(copy, text, n);
+        cmd->text = (gui_deferred_text_t){copy, (uint32_t)n, x, y, font_size, 0, 0};
+        return;
+    }
+
+    for (size_t i = 0; i < len && text[i]; i++) {
+        if (text[i] != ' ') {
+            // Draw a simple rectangle representing each character
+            float cursor_x = x + ((float)i * char_width);
+            gui_add_rect_filled(ctx, cursor_x, y, char_width * 0.8F, char_height, color);
+        }
+    }
+}
+
+void gui_add_text(gui_context_t *ctx, const char *text, float x, float y, gui_color_t color,
+                  float font_size) {
+    gui_add_text_n(ctx, text, SIZE_MAX, x, y, color, font_size);
+}
+
+void gui_push_clip_rect(gui_context_t *ctx, float x, float y, float w, float h,
+                        bool intersect_with_current) {
+    if (ctx->clip_stack_count >= CGUI_MAX_CLIP_STACK) {
+        return;
+    }
+
+    gui_rect_t clip = {x, y, w, h};
+    if (ctx->transformed) {
+        clip = gui_transform_rect(&ctx->transform, clip);
+    }
+
+    if (intersect_with_current && ctx->clip_stack_count > 0) {
+        gui_rect_t current = ctx->clip_stack[ctx->clip_stack_count - 1];
+        clip = gui_intersect_rects(current, clip);
+    }
+
+    ctx->clip_stack[ctx->clip_stack_count++] = clip;
+    gui_update_cull_rect(ctx);
+    gui_update_draw_cmd(ctx);
+}
+
+void gui_pop_clip_rect(gui_context_t *ctx) {
+    if (ctx->clip_stack_count > 1) {
+        ctx->clip_stack_count--;
+        gui_update_cull_rect(ctx);
+        gui_update_draw_cmd(ctx);
+    }
+}
+
+// Makes `transform` current: drawing, culling and the mouse position follow it
+static void gui_set_transform(gui_context_t *ctx, gui_transform_t transform) {
+    gui_deferred_flush(ctx);
+    ctx->transform = transform;
+    gui_transform_t identity = gui_transform_identity();
+    ctx->transformed = !gui_transforms_equal(&transform, &identity);
+    ctx->input.mouse_pos = ctx->transformed
+                               ? gui_transform_point(gui_transform_invert(transform),
+                                                     ctx->screen_mouse_pos)
+                               : ctx->screen_mouse_pos;
+    gui_update_cull_rect(ctx);
+    gui_update_draw_cmd(ctx);
+}
+
+void gui_push_transform(gui_context_t *ctx, gui_transform_t transform) {
+    if (ctx->transform_stack_count >= CGUI_MAX_TRANSFORM_STACK) {
+        return;
+    }
+    if (ctx->transform_stack_count == 0) {
+        ctx->screen_mouse_pos = ctx->input.mouse_pos;
+    }
+    ctx->transform_stack[ctx->transform_stack_count++] = ctx->transform;
+    gui_set_transform(ctx, gui_transform_multiply(ctx->transform, transform));
+}
+
+void gui_pop_transform(gui_context_t *ctx) {
+    if (ctx->transform_stack_count > 0) {
+        gui_set_transform(ctx, ctx->transform_stack[--ctx->transform_stack_count]);
+    }
+}
+
+// =============================================================================
+// IMAGE ATLAS
+// =============================================================================
+
+bool gui_atlas_init(gui_atlas_t *atlas, int page_width, int page_height, int padding) {
+    memset(atlas, 0, sizeof(gui_atlas_t));
+    if (page_width <= 0 || page_height <= 0 || padding < 0) {
+        return false;
+    }
+    atlas->page_width = page_width;
+    atlas->page_height = page_height;
+    atlas->padding = padding;
+    return true;
+}
+
+void gui_atlas_free(gui_atlas_t *atlas) {
+    for (uint32_t i = 0; i < atlas->page_count; i++) {
+        CGUI_FREE(atlas->pages[i].pixels);
+        CGUI_FREE(atlas->pages[i].skyline);
+    }
+    CGUI_FREE(atlas->pages);
+    CGUI_FREE(atlas->images);
+    memset(atlas, 0, sizeof(gui_atlas_t));
+}
+
+// Top row at which a w x h rectangle placed at skyline segment i rests on every segment it spans,
+// or -1 when it runs off the page
+static int gui_atlas_fit(const gui_atlas_t *atlas, const gui_atlas_page_t *page, uint32_t i, int w,
+                         int h) {
+    int x = page->skyline[i].x;
+    if (x + w > atlas->page_width) {
+        return -1;
+    }
+    int y = 0;
+    for (int left = w; left > 0; i++) {
+        y = (page->skyline[i].y > y) ? page->skyline[i].y : y;
+        left -= page->skyline[i].width;
+    }
+    return (y + h <= atlas->page_height) ? y : -1;
+}
+
+// Bottom-left skyline placement: the segment giving the lowest top, then the narrowest one.
+// Returns false when the page has no room.
+static bool gui_atlas_page_pack(gui_atlas_t *atlas, gui_atlas_page_t *page, int w, int h, int *x,
+                                int *y) {
+    uint32_t best = UINT32_MAX;
+    int best_y = INT32_MAX;
+    int best_width = INT32_MAX;
+    for (uint32_t i = 0; i < page->skyline_count; i++) {
+        int top = gui_atlas_fit(atlas, page, i, w, h);
+        if (top >= 0 && (top < best_y || (top == best_y && page->skyline[i].width < best_width))) {
+            best = i;
+            best_y = top;
+            best_width = page->skyline[i].width;
+        }
+    }
+    if (best == UINT32_MAX || !gui_grow_array((void **)&page->skyline, &page->skyline_capacity,
+                                              page->skyline_count + 1,
+                                              sizeof(gui_atlas_skyline_t))) {
+        return false;
+    }
+
+    // Insert the new segment, then trim or drop the segments it now shadows
+    gui_atlas_skyline_t *sky = page->skyline;
+    memmove(&sky[best + 1], &sky[best], (page->skyline_count - best) * sizeof(*sky));
+    sky[best] = (gui_atlas_skyline_t){sky[best + 1].x, best_y + h, w};
+    page->skyline_count++;
+    *x = sky[best].x;
+    *y = best_y;
+    int end = *x + w;
+    uint32_t next = best + 1;
+    while (next < page->skyline_count && sky[next].x < end) {
+        int shrink = end - sky[next].x;
+        if (shrink < sky[next].width) {
+            sky[next].x += shrink;
+            sky[next].width -= shrink;
+            break;
+        }
+        memmove(&sky[next], &sky[next + 1], (page->skyline_count - next - 1) * sizeof(*sky));
+        page->skyline_count--;
+    }
+
+    // Merge neighbours of equal height
+    for (uint32_t i = 0; i + 1 < page->skyline_count;) {
+        if (sky[i].y == sky[i + 1].y) {
+            sky[i].width += sky[i + 1].width;
+            memmove(&sky[i + 1], &sky[i + 2], (page->skyline_count - i - 2) * sizeof(*sky));
+            page->skyline_count--;
+        } else {
+            i++;
+        }
+    }
+    return true;
+}
+
+static gui_atlas_page_t *gui_atlas_add_page(gui_atlas_t *atlas) {
+    if (!gui_grow_array((void **)&atlas->pages, &atlas->page_capacity, atlas->page_count + 1,
+                        sizeof(gui_atlas_page_t))) {
+        return NULL;
+    }
+    gui_atlas_page_t page = {0};
+    size_t bytes = (size_t)atlas->page_width * (size_t)atlas->page_height * 4U;
+    page.pixels = (uint8_t *)CGUI_MALLOC(bytes);
+    if (!page.pixels || !gui_grow_array((void **)&page.skyline, &page.skyline_capacity, 1,
+                                        sizeof(gui_atlas_skyline_t))) {
+        CGUI_FREE(page.pixels);
+        return NULL;
+    }
+    memset(page.pixels, 0, bytes);
+    page.skyline[page.skyline_count++] = (gui_atlas_skyline_t){0, 0, atlas->page_width};
+    atlas->pages[atlas->page_count] = page;
+    return &atlas->pages[atlas->page_count++];
+}
+
+// Copies the image with its edge pixels repeated over the padding around it; (x, y) is the
+// corner of the padded area
+static void gui_atlas_blit(const gui_atlas_t *atlas, gui_atlas_page_t *page, int x, int y,
+                           int width, int height, const uint8_t *pixels) {
+    int pad = atlas->padding;
+    for (int row = 0; row < height + (2 * pad); row++) {
+        int src_row = row - pad;
+        src_row = (src_row < 0) ? 0 : ((src_row >= height) ? height - 1 : src_row);
+        const uint8_t *src = pixels + ((size_t)src_row * (size_t)width * 4U);
+        uint8_t *dst = page->pixels + ((((size_t)(y + row) * (size_t)atlas->page_width) +
+                                        (size_t)x) *
+                                       4U);
+        for (int col = 0; col < pad; col++) {
+            memcpy(dst + ((size_t)col * 4U), src, 4U);
+            memcpy(dst + ((size_t)(pad + width + col) * 4U), src + ((size_t)(width - 1) * 4U), 4U);
+        }
+        memcpy(dst + ((size_t)pad * 4U), src, (size_t)width * 4U);
+    }
+    int y1 = y + height + (2 * pad);
+    if (page->dirty_y0 >= page->dirty_y1) {
+        page->dirty_y0 = y;
+        page->dirty_y1 = y1;
+    } else {
+        page->dirty_y0 = (y < page->dirty_y0) ? y : page->dirty_y0;
+        page->dirty_y1 = (y1 > page->dirty_y1) ? y1 : page->dirty_y1;
+    }
+}
+
+int gui_atlas_add(gui_atlas_t *atlas, int width, int height, const void *pixels) {
+    int w = width + (2 * atlas->padding);
+    int h = height + (2 * atlas->padding);
+    if (width <= 0 || height <= 0 || w > atlas->page_width || h > atlas->page_height ||
+        !gui_grow_array((void **)&atlas->images, &atlas->image_capacity, atlas->image_count + 1,
+                        sizeof(gui_atlas_image_t))) {
+        return -1;
+    }
+
+    // Earlier pages first, so they fill up before the new ones
+    gui_atlas_page_t *page = NULL;
+    int x = 0;
+    int y = 0;
+    for (uint32_t i = 0; i < atlas->page_count && !page; i++) {
+        if (gui_atlas_page_pack(atlas, &atlas->pages[i], w, h, &x, &y)) {
+            page = &atlas->pages[i];
+        }
+    }
+    if (!page) {
+        page = gui_atlas_add_page(atlas);
+        if (!page || !gui_atlas_page_pack(atlas, page, w, h, &x, &y)) {
+            return -1;
+        }
+    }
+    gui_atlas_blit(atlas, page, x, y, width, height, (const uint8_t *)pixels);
+
+    float inv_w = 1.0F / (float)atlas->page_width;
+    float inv_h = 1.0F / (float)atlas->page_height;
+    x += atlas->padding;
+    y += atlas->padding;
+    atlas->images[atlas->image_count] = (gui_atlas_image_t){
+        (uint32_t)(page - atlas->pages),
+        {(float)x * inv_w, (float)y * inv_h},
+        {(float)(x + width) * inv_w, (float)(y + height) * inv_h},
+        (float)width,
+        (float)height,
+    };
+    return (int)atlas->image_count++;
+}
+
+void gui_add_atlas_image(gui_context_t *ctx, const gui_atlas_t *atlas, int image, float x, float y,
+                         float w, float h, gui_color_t tint) {
+    if (image < 0 || (uint32_t)image >= atlas->image_count) {
+        return;
+    }
+    const gui_atlas_image_t *img = &atlas->images[image];
+    gui_add_image(ctx, atlas->pages[img->page].texture, x, y, w, h, img->uv0, img->uv1, tint);
+}
+
+// =============================================================================
+// WIDGETS
+// =============================================================================
+
+void gui_label(gui_context_t *ctx, const char *text) { gui_label_n(ctx, text, strlen(text)); }
+
+void gui_label_n(gui_context_t *ctx, const char *text, size_t length) {
+    GUI_TRACE_BEGIN("gui_label");
+    ctx->stats.widget_count++;
+    float text_w = gui_text_width_n(length, ctx->style.text_size);
+    float text_h = ctx->style.text_size;
+    gui_rect_t rect = gui_layout_next_rect(ctx, text_w, text_h, text_w, text_h);
+
+    gui_add_text_n(ctx, text, length, rect.x, rect.y, ctx->style.text, ctx->style.text_size);
+    GUI_TRACE_END();
+}
+
+// Shared press/release logic: the item becomes active when pressed while hovered and reports a
+// click when released over itself. Returns true on click.
+static bool gui_button_behavior(gui_context_t *ctx, gui_id_t id, gui_rect_t rect, bool *out_hovered,
+                                bool *out_held) {
+    bool hovered = gui_add_hit_rect(ctx, id, rect.x, rect.y, rect.w, rect.h);
+    bool clicked = false;
+
+    if (hovered) {
+        ctx->hot_item = id;
+        if (ctx->active_item == 0 && ctx->input.mouse_clicked[GUI_MOUSE_BUTTON_LEFT]) {
+            ctx->active_item = id;
+        }
+    }
+
+    bool held = ctx->active_item == id;
+    if (held && ctx->input.mouse_released[GUI_MOUSE_BUTTON_LEFT]) {
+        if (hovered) {
+            clicked = true;
+        }
+        ctx->active_item = 0;
+    }
+
+    if (out_hovered) {
+        *out_hovered = hovered;
+    }
+    if (out_held) {
+        *out_held = held;
+    }
+    return clicked;
+}
+
+bool gui_button(gui_context_t *ctx, const char *label, float width, float height) {
+    return gui_button_ex(ctx, gui_hash_string(label), label, strlen(label), width, height);
+}
+
+bool gui_button_ex(gui_context_t *ctx, gui_id_t label_hash, const char *label, size_t length,
+                   float width, float height) {
+    GUI_TRACE_BEGIN("gui_button");
+    ctx->stats.widget_count++;
+
+    // Calculate button position and size
+    gui_rect_t rect = gui_layout_next_rect(ctx, width, height, 100.0F, 30.0F);
+    float x = rect.x;
+    float y = rect.y;
+    float w = rect.w;
+    float h = rect.h;
+
+    // Generate unique ID
+    gui_id_t id = gui_get_id_hash(ctx, label_hash);
+
+    // Check interaction
+    bool clicked = gui_button_behavior(ctx, id, rect, NULL, NULL);
+
+    // Determine color based on state
+    gui_color_t bg_color;
+    if (ctx->active_item == id) {
+        bg_color = ctx->style.button_bg_active;
+    } else if (ctx->hot_item == id) {
+        bg_color = ctx->style.button_bg_hovered;
+    } else {
+        bg_color = ctx->style.button_bg;
+    }
+
+    // Draw button
+    gui_add_rect_filled(ctx, x, y, w, h, bg_color);
+    gui_add_rect(ctx, x, y, w, h, GUI_COLOR_BLACK, 1.0F);
+
+    // Draw label (centered)
+    float text_w = gui_text_width_n(length, ctx->style.text_size);
+    float text_x = x + ((w - text_w) * 0.5F);
+    float text_y = y + ((h - ctx->style.text_size) * 0.5F);
+    gui_add_text_n(ctx, label, length, text_x, text_y, ctx->style.button_text,
+                   ctx->style.text_size);
+
+    GUI_TRACE_END();
+    return clicked;
+}
+
+bool gui_slider_float(gui_context_t *ctx, const char *label, float *value, float min, float max,
+                      float width) {
+    return gui_slider_float_ex(ctx, gui_hash_string(label), value, min, max, width);
+}
+
+bool gui_slider_float_ex(gui_context_t *ctx, gui_id_t label_hash, float *value, float min,
+                         float max, float width) {
+    GUI_TRACE_BEGIN("gui_slider_float");
+    ctx->stats.widget_count++;
+
+    // Calculate slider position and size
+    float slider_h = ctx->style.slider_height;
+    gui_rect_t rect = gui_layout_next_rect(ctx, width, slider_h, 200.0F, slider_h);
+    float x = rect.x;
+    float y = rect.y;
+    float w = rect.w;
+    float h = rect.h;
+
+    // Generate unique ID
+    gui_id_t id = gui_get_id_hash(ctx, label_hash);
+
+    // Calculate grab position
+    float normalized = (*value - min) / (max - min);
+    if (normalized < 0.0F) {
+        normalized = 0.0F;
+    }
+    if (normalized > 1.0F) {
+        normalized = 1.0F;
+    }
+
+    float grab_w = ctx->style.slider_grab_size;
+    float grab_x = x + ((w - grab_w) * normalized);
+    float grab_y = y + ((h - grab_w) * 0.5F);
+
+    // One hit rect spanning the track and the grab, which may overhang it vertically
+    float hit_y = fminf(y, grab_y);
+    float hit_h = fmaxf(y + h, grab_y + grab_w) - hit_y;
+    bool hovered = gui_add_hit_rect(ctx, id, x, hit_y, w, hit_h);
+    bool changed = false;
+
+    if (hovered) {
+        ctx->hot_item = id;
+        if (ctx->active_item == 0 && ctx->input.mouse_clicked[GUI_MOUSE_BUTTON_LEFT]) {
+            ctx->active_item = id;
+        }
+    }
+
+    if (ctx->active_item == id) {
+        if (ctx->input.mouse_down[GUI_MOUSE_BUTTON_LEFT]) {
+            // Update value based on mouse position
+            float mouse_norm = (ctx->input.mouse_pos.x - x) / w;
+            if (mouse_norm < 0.0F) {
+                mouse_norm = 0.0F;
+            }
+            if (mouse_norm > 1.0F) {
+                mouse_norm = 1.0F;
+            }
+
+            float new_value = min + (mouse_norm * (max - min));
+            if (new_value != *value) {
+                *value = new_value;
+                changed = true;
+            }
+        } else {
+            ctx->active_item = 0;
+        }
+    }
+
+    // Draw slider track
+    gui_add_rect_filled(ctx, x, y, w, h, ctx->style.slider_bg);
+
+    // Draw slider grab
+    gui_color_t grab_color =
+        (ctx->active_item == id) ? ctx->style.slider_grab_active : ctx->style.slider_grab;
+    gui_add_circle_filled(ctx, grab_x + (grab_w * 0.5F), grab_y + (grab_w * 0.5F), grab_w * 0.5F,
+                          grab_color);
+
+    GUI_TRACE_END();
+    return changed;
+}
+
+void gui_image(gui_context_t *ctx, gui_texture_id_t texture, float width, float height,
+               gui_vec2_t uv0, gui_vec2_t uv1, gui_color_t tint) {
+    GUI_TRACE_BEGIN("gui_image");
+    ctx->stats.widget_count++;
+    gui_rect_t rect = gui_layout_next_rect(ctx, width, height, 100.0F, 100.0F);
+    gui_add_image(ctx, texture, rect.x, rect.y, rect.w, rect.h, uv0, uv1, tint);
+    GUI_TRACE_END();
+}
+
+void gui_atlas_image(gui_context_t *ctx, const gui_atlas_t *atlas, int image, float width,
+                     float height, gui_color_t tint) {
+    if (image < 0 || (uint32_t)image >= atlas->image_count) {
+        return;
+    }
+    GUI_TRACE_BEGIN("gui_atlas_image");
+    ctx->stats.widget_count++;
+    const gui_atlas_image_t *img = &atlas->images[image];
+    gui_rect_t rect = gui_layout_next_rect(ctx, (width > 0) ? width : img->width,
+                                           (height > 0) ? height : img->height, 0, 0);
+    gui_add_image(ctx, atlas->pages[img->page].texture, rect.x, rect.y, rect.w, rect.h, img->uv0,
+                  img->uv1, tint);
+    GUI_TRACE_END();
+}
+
+// Scrollbar along one axis of rect. Dragging the grab or clicking the track updates *scroll.
+static void gui_scrollbar(gui_context_t *ctx, gui_id_t id, gui_rect_t rect, bool vertical,
+                          float *scroll, float content_size, float view_size) {
+    float max_scroll = fmaxf(0.0F, content_size - view_size);
+    float track_start = vertical ? rect.y : rect.x;
+    float track_size = vertical ? rect.h : rect.w;
+    float grab_size = (content_size > 0.0F) ? track_size * (view_size / content_size) : track_size;
+    grab_size = gui_clampf(grab_size, fminf(ctx->style.scrollbar_size, track_size), track_size);
+    float travel = track_size - grab_size;
+
+    bool held;
+    gui_button_behavior(ctx, id, rect, NULL, &held);
+
+    float mouse = vertical ? ctx->input.mouse_pos.y : ctx->input.mouse_pos.x;
+    float grab_pos = track_start + ((max_scroll > 0.0F) ? travel * (*scroll / max_scroll) : 0.0F);
+
+    if (held && ctx->input.mouse_down[GUI_MOUSE_BUTTON_LEFT]) {
+        if (ctx->input.mouse_clicked[GUI_MOUSE_BUTTON_LEFT]) {
+            // Pressing the track (outside the grab) centers the grab under the mouse
+            bool on_grab = mouse >= grab_pos && mouse <= grab_pos + grab_size;
+            ctx->drag_offset = on_grab ? mouse - grab_pos : grab_size * 0.5F;
+        }
+        float t = (travel > 0.0F) ? (mouse - ctx->drag_offset - track_start) / travel : 0.0F;
+        *scroll = gui_clampf(t, 0.0F, 1.0F) * max_scroll;
+        grab_pos = track_start + ((max_scroll > 0.0F) ? travel * (*scroll / max_scroll) : 0.0F);
+    }
+
+    gui_color_t grab_color = ctx->style.scrollbar_grab;
+    if (ctx->active_item == id) {
+        grab_color = ctx->style.scrollbar_grab_active;
+    }
+
+    gui_add_rect_filled(ctx, rect.x, rect.y, rect.w, rect.h, ctx->style.scrollbar_bg);
+    if (vertical) {
+        gui_add_rect_filled(ctx, rect.x + 2.0F, grab_pos, rect.w - 4.0F, grab_size, grab_color);
+    } else {
+        gui_add_rect_filled(ctx, grab_pos, rect.y + 2.0F, grab_size, rect.h - 4.0F, grab_color);
+    }
+}
+
+// =============================================================================
+// TABLE
+// =============================================================================
+
+typedef struct {
+    float scroll_x;
+    float scroll_y;
+    int column_count;
+    float widths[]; // One per column
+} gui_table_state_t;
+
+// Sub-item IDs within a table
+#define GUI_TABLE_ID_SCROLL_X 0x7FFFFFF0U
+#define GUI_TABLE_ID_SCROLL_Y 0x7FFFFFF1U
+#define GUI_TABLE_ID_GRIP_BIT 0x80000000U
+
+int gui_table(gui_context_t *ctx, const char *id, const gui_table_desc_t *desc, float width,
+              float height) {
+    GUI_TRACE_BEGIN("gui_table");
+    ctx->stats.widget_count++;
+    gui_rect_t rect = gui_layout_next_rect(ctx, width, height, 400.0F, 300.0F);
+    gui_id_t table_id = gui_get_id(ctx, id);
+    const gui_style_t *style = &ctx->style;
+    int column_count = (desc->column_count > 0) ? desc->column_count : 0;
+    int header_clicked = -1;
+
+    // Column widths and scroll offsets persist across frames; a column count change resets them
+    gui_table_state_t *state = (gui_table_state_t *)gui_get_state(
+        ctx, table_id, sizeof(gui_table_state_t) + (sizeof(float) * (size_t)column_count));
+    if (!state) {
+        GUI_TRACE_END();
+        return -1;
+    }
+    if (state->column_count != column_count) {
+        state->column_count = column_count;
+        for (int c = 0; c < column_count; c++) {
+            const gui_table_column_t *column = &desc->columns[c];
+            float w = (column->width > 0.0F) ? column->width : style->table_column_width;
+            state->widths[c] = fmaxf(w, column->min_width);
+        }
+    }
+
+    float pad = style->table_cell_padding;
+    float char_w = style->text_size * 0.6F;
+    float row_h = style->text_size + (pad * 2.0F);
+    float header_h = row_h;
+    float bar = style->scrollbar_size;
+
+    float content_w = 0.0F;
+    for (int c = 0; c < column_count; c++) {
+        content_w += state->widths[c];
+    }
+    float content_h = (float)desc->row_count * row_h;
+
+    // Scrollbars take space from the view, which can in turn require the other scrollbar
+    bool need_v = content_h > rect.h - header_h;
+    bool need_h = content_w > rect.w - (need_v ? bar : 0.0F);
+    if (need_h && !need_v) {
+        need_v = content_h > rect.h - header_h - bar;
+    }
+    gui_rect_t view = {rect.x, rect.y + header_h, fmaxf(0.0F, rect.w - (need_v ? bar : 0.0F)),
+                       fmaxf(0.0F, rect.h - header_h - (need_h ? bar : 0.0F))};
+
+    // The table area is recorded first so its headers, grips and scrollbars sit on top of it
+    gui_id_t scroll_y_id = gui_combine_id(table_id, GUI_TABLE_ID_SCROLL_Y);
+    bool hovered = gui_add_hit_rect(ctx, table_id, rect.x, rect.y, rect.w, rect.h);
+    if (ctx->input.mouse_wheel != 0.0F && (hovered || ctx->hovered_item == scroll_y_id)) {
+        state->scroll_y -= ctx->input.mouse_wheel * row_h * 3.0F;
+    }
+    state->scroll_x = gui_clampf(state->scroll_x, 0.0F, fmaxf(0.0F, content_w - view.w));
+    state->scroll_y = gui_clampf(state->scroll_y, 0.0F, fmaxf(0.0F, content_h - view.h));
+
+    gui_push_clip_rect(ctx, rect.x, rect.y, rect.w, rect.h, true);
+    gui_add_rect_filled(ctx, rect.x, rect.y, rect.w, rect.h, style->table_bg);
+
+    if (need_v) {
+        gui_rect_t bar_rect = {view.x + view.w, view.y, bar, view.h};
+        gui_scrollbar(ctx, scroll_y_id, bar_rect, true, &state->scroll_y, content_h, view.h);
+    }
+    if (need_h) {
+        gui_rect_t bar_rect = {view.x, view.y + view.h, view.w, bar};
+        gui_scrollbar(ctx, gui_combine_id(table_id, GUI_TABLE_ID_SCROLL_X), bar_rect, false,
+                      &state->scroll_x, content_w, view.w);
+    }
+
+    // Column resize grips. Resizing shifts the columns after it, so positions are accumulated
+    // after each width update.
+    gui_rect_t header_rect = {view.x, rect.y, view.w, header_h};
+    float col_x = view.x - state->scroll_x;
+    for (int c = 0; c < column_count && col_x < view.x + view.w; c++) {
+        float right = col_x + state->widths[c];
+        if (right > view.x) {
+            gui_rect_t grip = gui_intersect_rects(
+                (gui_rect_t){right - 3.0F, rect.y, 6.0F, header_h}, header_rect);
+            gui_id_t grip_id = gui_combine_id(table_id, GUI_TABLE_ID_GRIP_BIT | (gui_id_t)c);
+            bool held;
+            gui_button_behavior(ctx, grip_id, grip, NULL, &held);
+            if (held && ctx->input.mouse_down[GUI_MOUSE_BUTTON_LEFT]) {
+                float min_w = fmaxf(desc->columns[c].min_width, pad * 2.0F);
+                state->widths[c] = fmaxf(ctx->input.mouse_pos.x - col_x, min_w);
+            }
+        }
+        col_x += state->widths[c];
+    }
+
+    // Row culling
+    gui_list_clipper_t clipper;
+    gui_list_clipper_begin(&clipper, desc->row_count, row_h, state->scroll_y, view.h);
+    float rows_y = view.y - state->scroll_y;
+
+    for (int r = clipper.display_start; r < clipper.display_end; r++) {
+        if (r & 1) {
+            gui_add_rect_filled(ctx, view.x, rows_y + ((float)r * row_h), view.w, row_h,
+                                style->table_row_alt_bg);
+        }
+    }
+
+    // Visible columns: the cells and header of a column share one clip rect, so each column
+    // costs a single draw command regardless of the number of rows
+    gui_rect_t columns_rect = {view.x, rect.y, view.w, header_h + view.h};
+    char buf[256];
+    col_x = view.x - state->scroll_x;
+    for (int c = 0; c < column_count && col_x < view.x + view.w; c++) {
+        float col_w = state->widths[c];
+        if (col_x + col_w <= view.x) {
+            col_x += col_w;
+            continue;
+        }
+
+        gui_rect_t clip = gui_intersect_rects((gui_rect_t){col_x, rect.y, col_w, columns_rect.h},
+                                              columns_rect);
+        gui_push_clip_rect(ctx, clip.x, clip.y, clip.w, clip.h, true);
+
+        // Only characters that can land inside the column are emitted
+        size_t max_chars = (size_t)fmaxf(0.0F, ((col_w - pad) / char_w) + 1.0F);
+
+        if (desc->cell_text) {
+            for (int r = clipper.display_start; r < clipper.display_end; r++) {
+                int data_row = desc->row_order ? desc->row_order[r] : r;
+                const char *text = desc->cell_text(desc->user_data, data_row, c, buf, sizeof(buf));
+                if (text) {
+                    gui_add_text_n(ctx, text, max_chars, col_x + pad,
+                                   rows_y + ((float)r * row_h) + pad, style->text,
+                                   style->text_size);
+                }
+            }
+        }
+
+        // Frozen header, drawn over any partially scrolled row. Its hit rect leaves out the
+        // grips on both edges: recorded later, it would otherwise win where they overlap.
+        float grip_left = (c > 0) ? 3.0F : 0.0F;
+        gui_rect_t header_hit = gui_intersect_rects(
+            (gui_rect_t){col_x + grip_left, rect.y, col_w - grip_left - 3.0F, header_h},
+            header_rect);
+        bool header_hovered;
+        if (gui_button_behavior(ctx, gui_combine_id(table_id, (gui_id_t)c + 1U), header_hit,
+                                &header_hovered, NULL)) {
+            header_clicked = c;
+        }
+        gui_add_rect_filled(ctx, col_x, rect.y, col_w, header_h,
+                            header_hovered ? style->table_header_bg_hovered
+                                           : style->table_header_bg);
+        const char *label = desc->columns[c].label;
+        if (label) {
+            gui_add_text_n(ctx, label, max_chars, col_x + pad, rect.y + pad, style->button_text,
+                           style->text_size);
+        }
+
+        gui_pop_clip_rect(ctx);
+        col_x += col_w;
+    }
+
+    // Column separators and header underline
+    col_x = view.x - state->scroll_x;
+    for (int c = 0; c < column_count && col_x < view.x + view.w; c++) {
+        col_x += state->widths[c];
+        if (col_x > view.x && col_x < view.x + view.w) {
+            gui_add_line(ctx, col_x, rect.y, col_x, view.y + view.h, style->table_border, 1.0F);
+        }
+    }
+    gui_add_line(ctx, view.x, view.y, view.x + view.w, view.y, style->table_border, 1.0F);
+    gui_add_rect(ctx, rect.x, rect.y, rect.w, rect.h, style->table_border, 1.0F);
+
+    gui_pop_clip_rect(ctx);
+    GUI_TRACE_END();
+    return header_clicked;
+}
+
+// =============================================================================
+// PLOT
+// =============================================================================
+
+// Min/max pyramid: level L holds one entry per block of (GUI_PLOT_BLOCK << L) samples, indexed
+// by absolute block number (modulo the level capacity for ring sources)
+#define GUI_PLOT_BLOCK 16U
+#define GUI_PLOT_MAX_LEVELS 40
+
+typedef struct {
+    float min;
+    float max;
+} gui_minmax_t;
+
+typedef struct {
+    const float *values;
+    size_t stride;
+    size_t capacity; // Ring size, 0 for linear sources
+    uint64_t total;  // Samples available when last updated
+    int level_count;
+    uint64_t next_block[GUI_PLOT_MAX_LEVELS]; // First block not yet reduced, per level
+    size_t level_capacity[GUI_PLOT_MAX_LEVELS];
+    gui_minmax_t *levels[GUI_PLOT_MAX_LEVELS];
+} gui_plot_cache_t;
+
+static void gui_plot_cache_reset(gui_plot_cache_t *cache) {
+    for (int l = 0; l < GUI_PLOT_MAX_LEVELS; l++) {
+        CGUI_FREE(cache->levels[l]);
+    }
+    memset(cache, 0, sizeof(gui_plot_cache_t));
+}
+
+static void gui_plot_cache_destroy(void *data) { gui_plot_cache_reset((gui_plot_cache_t *)data); }
+
+static float gui_plot_sample(const gui_plot_cache_t *cache, uint64_t i) {
+    uint64_t slot = cache->capacity ? i % cache->capacity : i;
+    return *(const float *)((const uint8_t *)cache->values + (slot * cache->stride));
+}
+
+static gui_minmax_t *gui_plot_block(const gui_plot_cache_t *cache, int level, uint64_t block) {
+    uint64_t slot = cache->capacity ? block % cache->level_capacity[level] : block;
+    return &cache->levels[level][slot];
+}
+
+static uint64_t gui_plot_first_sample(const gui_plot_cache_t *cache) {
+    return (cache->capacity && cache->total > cache->capacity) ? cache->total - cache->capacity
+                                                                 : 0;
+}
+
+// Folds samples appended since the last update into every pyramid level. Blocks are only
+// reduced once complete; for ring sources, blocks overlapping overwritten samples are skipped.
+static void gui_plot_cache_update(gui_plot_cache_t *cache, const float *values, size_t stride,
+                                  size_t capacity, uint64_t total) {
+    if (cache->values != values || cache->stride != stride || cache->capacity != capacity ||
+        total < cache->total) {
+        gui_plot_cache_reset(cache);
+        cache->values = values;
+        cache->stride = stride;
+        cache->capacity = capacity;
+    }
+    cache->total = total;
+    uint64_t first = gui_plot_first_sample(cache);
+    uint64_t span = capacity ? capacity : total; // Largest range a block ever needs to cover
+
+    for (int l = 0; l < GUI_PLOT_MAX_LEVELS; l++) {
+        uint64_t block_size = (uint64_t)GUI_PLOT_BLOCK << l;
+        if (block_size > span) {
+            break;
+        }
+        uint64_t end_block = total / block_size;
+
+        // Make room: rings keep a fixed window of blocks, linear sources grow
+        size_t needed = capacity ? (size_t)((capacity / block_size) + 2U) : (size_t)end_block;
+        if (needed > cache->level_capacity[l]) {
+            size_t new_capacity = capacity ? needed : needed * 2U;
+            gui_minmax_t *grown = (gui_minmax_t *)CGUI_REALLOC(
+                capacity ? NULL : cache->levels[l], new_capacity * sizeof(gui_minmax_t));
+            if (!grown) {
+                break;
+            }
+            if (capacity) {
+                CGUI_FREE(cache->levels[l]);
+                cache->next_block[l] = 0; // Ring slots moved: reduce the window again
+            }
+            cache->levels[l] = grown;
+            cache->level_capacity[l] = new_capacity;
+        }
+        if (l >= cache->level_count) {
+            cache->level_count = l + 1;
+        }
+
+        uint64_t first_block = (first + block_size - 1) / block_size;
+        uint64_t block = (cache->next_block[l] > first_block) ? cache->next_block[l] : first_block;
+        for (; block < end_block; block++) {
+            gui_minmax_t mm;
+            if (l == 0) {
+                uint64_t i = block * GUI_PLOT_BLOCK;
+                mm.min = mm.max = gui_plot_sample(cache, i);
+                for (uint64_t end = i + GUI_PLOT_BLOCK, j = i + 1; j < end; j++) {
+                    float v = gui_plot_sample(cache, j);
+                    mm.min = fminf(mm.min, v);
+                    mm.max = fmaxf(mm.max, v);
+                }
+            } else {
+                const gui_minmax_t *a = gui_plot_block(cache, l - 1, block * 2U);
+                const gui_minmax_t *b = gui_plot_block(cache, l - 1, (block * 2U) + 1U);
+                mm.min = fminf(a->min, b->min);
+                mm.max = fmaxf(a->max, b->max);
+            }
+            *gui_plot_block(cache, l, block) = mm;
+        }
+        cache->next_block[l] = end_block;
+    }
+}
+
+// Min/max over samples [begin, end) using the largest aligned blocks available, falling back to
+// raw samples at unaligned edges: O(GUI_PLOT_BLOCK + log n) per query
+static gui_minmax_t gui_plot_query(const gui_plot_cache_t *cache, uint64_t begin, uint64_t end) {
+    gui_minmax_t mm = {INFINITY, -INFINITY};
+    uint64_t i = begin;
+    while (i < end) {
+        int level = -1;
+        for (int l = 0; l < cache->level_count; l++) {
+            uint64_t block_size = (uint64_t)GUI_PLOT_BLOCK << l;
+            if (i % block_size != 0 || i + block_size > end ||
+                i / block_size >= cache->next_block[l]) {
+                break;
+            }
+            level = l;
+        }
+
+        if (level < 0) {
+            float v = gui_plot_sample(cache, i);
+            mm.min = fminf(mm.min, v);
+            mm.max = fmaxf(mm.max, v);
+            i++;
+        } else {
+            uint64_t block_size = (uint64_t)GUI_PLOT_BLOCK << level;
+            const gui_minmax_t *block = gui_plot_block(cache, level, i / block_size);
+            mm.min = fminf(mm.min, block->min);
+            mm.max = fmaxf(mm.max, block->max);
+            i += block_size;
+        }
+    }
+    return mm;
+}
+
+static void gui_plot_draw(gui_context_t *ctx, const char *label, const float *values,
+                          size_t capacity, size_t stride, uint64_t total, float scale_min,
+                          float scale_max, float width, float height) {
+    GUI_TRACE_BEGIN("gui_plot_lines");
+    ctx->stats.widget_count++;
+    gui_rect_t rect = gui_layout_next_rect(ctx, width, height, 300.0F, 100.0F);
+    gui_id_t id = gui_get_id(ctx, label);
+    gui_plot_cache_t *cache = (gui_plot_cache_t *)gui_get_state_ex(
+        ctx, id, sizeof(gui_plot_cache_t), gui_plot_cache_destroy);
+    if (!cache) {
+        GUI_TRACE_END();
+        return;
+    }
+
+    gui_add_rect_filled(ctx, rect.x, rect.y, rect.w, rect.h, ctx->style.plot_bg);
+
+    if (values && total > 0) {
+        gui_plot_cache_update(cache, values, stride ? stride : sizeof(float), capacity, total);
+
+        uint64_t first = gui_plot_first_sample(cache);
+        uint64_t sample_count = total - first;
+        if (scale_min >= scale_max) {
+            gui_minmax_t range = gui_plot_query(cache, first, total);
+            scale_min = range.min;
+            scale_max = (range.max > range.min) ? range.max : range.min + 1.0F;
+        }
+
+        gui_rect_t inner = {rect.x + 1.0F, rect.y + 1.0F, rect.w - 2.0F, rect.h - 2.0F};
+        float scale_y = inner.h / (scale_max - scale_min);
+        int columns = (int)inner.w;
+
+        // Small sources are drawn as-is; larger ones emit the min and max of each pixel column,
+        // ordered to continue from the previous point
+        bool decimate = sample_count > (uint64_t)columns * 2U;
+        int max_points = decimate ? columns * 2 : (int)sample_count;
+        gui_vec2_t *points =
+            (gui_vec2_t *)gui_alloc(&ctx->allocator, sizeof(gui_vec2_t) * (size_t)max_points);
+        int point_count = 0;
+
+        if (points && decimate) {
+            float prev_y = inner.y + inner.h;
+            for (int px = 0; px < columns; px++) {
+                uint64_t begin = first + ((sample_count * (uint64_t)px) / (uint64_t)columns);
+                uint64_t end = first + ((sample_count * (uint64_t)(px + 1)) / (uint64_t)columns);
+                gui_minmax_t mm = gui_plot_query(cache, begin, end);
+                float x = inner.x + (float)px + 0.5F;
+                float y_min = inner.y + inner.h - ((mm.min - scale_min) * scale_y);
+                float y_max = inner.y + inner.h - ((mm.max - scale_min) * scale_y);
+                bool min_first = fabsf(prev_y - y_min) < fabsf(prev_y - y_max);
+                points[point_count++] = (gui_vec2_t){x, min_first ? y_min : y_max};
+                points[point_count++] = (gui_vec2_t){x, min_first ? y_max : y_min};
+                prev_y = points[point_count - 1].y;
+            }
+        } else if (points) {
+            float step = (sample_count > 1) ? inner.w / (float)(sample_count - 1) : 0.0F;
+            for (uint64_t i = 0; i < sample_count; i++) {
+                float v = gui_plot_sample(cache, first + i);
+                points[point_count++] = (gui_vec2_t){
+                    inner.x + ((float)i * step), inner.y + inner.h - ((v - scale_min) * scale_y)};
+            }
+        }
+
+        for (int i = 0; i < point_count; i++) {
+            points[i].y = gui_clampf(points[i].y, inner.y, inner.y + inner.h);
+        }
+        gui_add_polyline(ctx, points, point_count, ctx->style.plot_line, 1.0F);
+    }
+
+    gui_add_rect(ctx, rect.x, rect.y, rect.w, rect.h, ctx->style.table_border, 1.0F);
+    gui_add_text(ctx, label, rect.x + 4.0F, rect.y + 4.0F, ctx->style.text,
+                 ctx->style.text_size);
+    GUI_TRACE_END();
+}
+
+void gui_plot_lines(gui_context_t *ctx, const char *label, const float *values, size_t count,
+                    size_t stride, float scale_min, float scale_max, float width, float height) {
+    gui_plot_draw(ctx, label, values, 0, stride, (uint64_t)count, scale_min, scale_max, width,
+                  height);
+}
+
+void gui_plot_lines_ring(gui_context_t *ctx, const char *label, const float *ring,
+                         size_t capacity, size_t stride, uint64_t total, float scale_min,
+                         float scale_max, float width, float height) {
+    if (capacity == 0) {
+        return;
+    }
+    gui_plot_draw(ctx, label, ring, capacity, stride, total, scale_min, scale_max, width, height);
+}
+
+// =============================================================================
+// LOG VIEW
+// =============================================================================
+
+// Every GUI_LOG_MARK_STRIDE-th line start is indexed, so finding a line reads at most that many
+// lines from the closest mark
+#define GUI_LOG_MARK_STRIDE 256U
+#define GUI_LOG_MAX_LINE 512 // Characters of a line read for drawing and search
+
+typedef struct {
+    uint64_t line;
+    uint64_t offset;
+} gui_log_mark_t;
+
+typedef struct {
+    const char *text;
+    size_t capacity;      // Ring size, 0 for flat sources
+    uint64_t total;       // Bytes available when last updated
+    uint64_t scanned;     // Bytes searched for line starts
+    uint64_t scan_line;   // Last line start found, and its offset
+    uint64_t scan_offset;
+    bool synced;          // False while looking for a line start after losing track
+    uint64_t first_line;  // Oldest line whose start is still available
+    uint64_t first_offset;
+    gui_log_mark_t *marks; // Ascending; rings drop the ones overwritten
+    uint32_t mark_count;
+    uint32_t mark_capacity;
+    double scroll;        // Line at the top of the view, with the fraction scrolled into it
+    bool follow;          // Keep the last line in view as text is appended
+} gui_log_state_t;
+
+static void gui_log_state_reset(gui_log_state_t *state) {
+    CGUI_FREE(state->marks);
+    memset(state, 0, sizeof(gui_log_state_t));
+}
+
+static void gui_log_state_destroy(void *data) { gui_log_state_reset((gui_log_state_t *)data); }
+
+// Bytes from stream offset `offset` up to `end` that are contiguous in memory (a ring wraps)
+static const char *gui_log_span(const gui_log_state_t *state, uint64_t offset, uint64_t end,
+                                size_t *size) {
+    uint64_t slot = state->capacity ? offset % state->capacity : offset;
+    uint64_t n = end - offset;
+    if (state->capacity && n > state->capacity - slot) {
+        n = state->capacity - slot;
+    }
+    *size = (size_t)n;
+    return state->text + slot;
+}
+
+// Offset of the first newline in [offset, end), or end
+static uint64_t gui_log_find_newline(const gui_log_state_t *state, uint64_t offset,
+                                     uint64_t end) {
+    while (offset < end) {
+        size_t size;
+        const char *span = gui_log_span(state, offset, end, &size);
+        const char *newline = (const char *)memchr(span, '\n', size);
+        if (newline) {
+            return offset + (uint64_t)(newline - span);
+        }
+        offset += size;
+    }
+    return end;
+}
+
+static size_t gui_log_copy(const gui_log_state_t *state, uint64_t offset, uint64_t end, char *out,
+                           size_t max) {
+    size_t n = 0;
+    end = (end - offset > max) ? offset + max : end;
+    while (offset < end) {
+        size_t size;
+        const char *span = gui_log_span(state, offset, end, &size);
+        memcpy(out + n, span, size);
+        n += size;
+        offset += size;
+    }
+    return n;
+}
+
+static void gui_log_mark(gui_log_state_t *state, uint64_t line, uint64_t offset) {
+    if (gui_grow_array((void **)&state->marks, &state->mark_capacity, state->mark_count + 1,
+                       sizeof(gui_log_mark_t))) {
+        state->marks[state->mark_count++] = (gui_log_mark_t){line, offset};
+    }
+}
+
+static uint64_t gui_log_line_count(const gui_log_state_t *state) {
+    if (!state->synced) {
+        return 0;
+    }
+    // The text after the last newline is a line once it is not empty
+    return state->scan_line - state->first_line + (state->scanned > state->scan_offset ? 1U : 0U);
+}
+
+// Indexes at most `budget` new bytes and, for rings, moves the first line past overwritten text
+static void gui_log_update(gui_log_state_t *state, const char *text, size_t capacity,
+                           uint64_t total, uint64_t budget) {
+    if (state->text != text || state->capacity != capacity || total < state->total ||
+        !state->marks) {
+        gui_log_state_reset(state);
+        state->text = text;
+        state->capacity = capacity;
+        state->synced = true;
+        state->follow = capacity > 0; // Rings are live logs: start at the newest line
+        gui_log_mark(state, 0, 0);
+    }
+    state->total = total;
+    uint64_t oldest = (capacity && total > capacity) ? total - capacity : 0;
+
+    if (state->scanned < oldest) {
+        state->scanned = oldest; // Overwritten before it was indexed
+        state->synced = false;
+    }
+    uint64_t end = (total - state->scanned > budget) ? state->scanned + budget : total;
+    while (state->scanned < end) {
+        uint64_t newline = gui_log_find_newline(state, state->scanned, end);
+        state->scanned = (newline < end) ? newline + 1U : end;
+        if (newline == end) {
+            break;
+        }
+        state->scan_line++;
+        state->scan_offset = newline + 1U;
+        if (!state->synced) {
+            // Numbering restarts here; only later lines are shown
+            state->synced = true;
+            state->mark_count = 0;
+            state->first_line = state->scan_line;
+            state->first_offset = state->scan_offset;
+            gui_log_mark(state, state->scan_line, state->scan_offset);
+        } else if (state->scan_line % GUI_LOG_MARK_STRIDE == 0) {
+            gui_log_mark(state, state->scan_line, state->scan_offset);
+        }
+    }
+
+    if (!state->synced || state->first_offset >= oldest) {
+        return;
+    }
+    uint32_t dropped = 0;
+    while (dropped < state->mark_count && state->marks[dropped].offset < oldest) {
+        dropped++;
+    }
+    state->mark_count -= dropped;
+    memmove(state->marks, state->marks + dropped, state->mark_count * sizeof(gui_log_mark_t));
+    gui_log_mark_t next = (state->mark_count > 0)
+                              ? state->marks[0]
+                              : (gui_log_mark_t){state->scan_line, state->scan_offset};
+    if (next.offset < oldest) {
+        state->synced = false; // The last line started before the oldest byte
+        return;
+    }
+
+    // The new first line starts after the first newline still available; lines are numbered
+    // back from the next known start
+    uint64_t first_offset = next.offset;
+    uint64_t lines_before = 0;
+    for (uint64_t at = oldest; next.offset > 0 && at < next.offset - 1U;) {
+        uint64_t newline = gui_log_find_newline(state, at, next.offset - 1U);
+        if (newline == next.offset - 1U) {
+            break;
+        }
+        first_offset = (lines_before++ == 0) ? newline + 1U : first_offset;
+        at = newline + 1U;
+    }
+    state->first_line = next.line - lines_before;
+    state->first_offset = first_offset;
+}
+
+// Start offset of an indexed line (first_line <= line <= scan_line)
+static uint64_t gui_log_line_offset(const gui_log_state_t *state, uint64_t line) {
+    gui_log_mark_t from = {state->first_line, state->first_offset};
+    uint32_t lo = 0;
+    uint32_t hi = state->mark_count;
+    while (lo < hi) {
+        uint32_t mid = lo + ((hi - lo) / 2U);
+        if (state->marks[mid].line <= line) {
+            lo = mid + 1U;
+        } else {
+            hi = mid;
+        }
+    }
+    if (lo > 0 && state->marks[lo - 1U].line > from.line) {
+        from = state->marks[lo - 1U];
+    }
+    uint64_t offset = from.offset;
+    for (uint64_t l = from.line; l < line; l++) {
+        offset = gui_log_find_newline(state, offset, state->scanned) + 1U;
+    }
+    return offset;
+}
+
+void gui_log_view(gui_context_t *ctx, const char *id, const char *text, size_t capacity,
+                  uint64_t total, const char *highlight, float width, float height) {
+    GUI_TRACE_BEGIN("gui_log_view");
+    ctx->stats.widget_count++;
+    gui_rect_t rect = gui_layout_next_rect(ctx, width, height, 400.0F, 300.0F);
+    gui_id_t view_id = gui_get_id(ctx, id);
+    const gui_style_t *style = &ctx->style;
+    gui_log_state_t *state = (gui_log_state_t *)gui_get_state_ex(
+        ctx, view_id, sizeof(gui_log_state_t), gui_log_state_destroy);
+    if (!state) {
+        GUI_TRACE_END();
+        return;
+    }
+    gui_log_update(state, text, capacity, text ? total : 0, CGUI_LOG_SCAN_BUDGET);
+
+    float pad = style->table_cell_padding;
+    float char_w = style->text_size * 0.6F;
+    float line_h = style->text_size + pad;
+    uint64_t line_count = gui_log_line_count(state);
+    float view_lines = rect.h / line_h;
+    bool need_v = (double)line_count > (double)view_lines;
+    float bar_w = need_v ? style->scrollbar_size : 0.0F;
+    gui_rect_t view = {rect.x, rect.y, fmaxf(0.0F, rect.w - bar_w), rect.h};
+
+    // Scrolling works in lines: a float pixel offset cannot address every line of a large file
+    double first = (double)state->first_line;
+    double max_scroll = first + fmax(0.0, (double)line_count - (double)view_lines);
+    double scroll = state->follow ? max_scroll : state->scroll;
+    gui_id_t bar_id = gui_combine_id(view_id, 1U);
+    bool hovered = gui_add_hit_rect(ctx, view_id, rect.x, rect.y, rect.w, rect.h);
+    bool scrolled = false;
+    if (ctx->input.mouse_wheel != 0.0F && (hovered || ctx->hovered_item == bar_id)) {
+        scroll -= (double)ctx->input.mouse_wheel * 3.0;
+        scrolled = true;
+    }
+
+    gui_push_clip_rect(ctx, rect.x, rect.y, rect.w, rect.h, true);
+    gui_add_rect_filled(ctx, rect.x, rect.y, rect.w, rect.h, style->table_bg);
+    if (need_v) {
+        gui_rect_t bar_rect = {view.x + view.w, view.y, bar_w, view.h};
+        float bar_scroll = (float)(scroll - first);
+        float before = bar_scroll;
+        gui_scrollbar(ctx, bar_id, bar_rect, true, &bar_scroll, (float)line_count, view_lines);
+        if (bar_scroll != before) {
+            scroll = first + (double)bar_scroll;
+            scrolled = true;
+        }
+    }
+    scroll = fmin(fmax(scroll, first), max_scroll);
+    state->scroll = scroll;
+    state->follow = scrolled ? scroll >= max_scroll : state->follow;
+
+    // Visible lines, from the line at the top of the view
+    uint64_t top = (uint64_t)scroll;
+    uint64_t below = state->first_line + line_count - top;
+    gui_list_clipper_t clipper;
+    gui_list_clipper_begin(&clipper, (below > INT32_MAX) ? INT32_MAX : (int)below, line_h,
+                           (float)(scroll - (double)top) * line_h, view.h);
+    float rows_y = view.y - ((float)(scroll - (double)top) * line_h);
+
+    gui_push_clip_rect(ctx, view.x, view.y, view.w, view.h, true);
+    size_t max_chars = (size_t)fmaxf(0.0F, ((view.w - pad) / char_w) + 1.0F);
+    size_t query_len = highlight ? strlen(highlight) : 0;
+    size_t read_max = max_chars + (query_len > 0 ? query_len - 1U : 0U);
+    read_max = (read_max < GUI_LOG_MAX_LINE) ? read_max : GUI_LOG_MAX_LINE;
+    char buf[GUI_LOG_MAX_LINE];
+    uint64_t offset = (clipper.display_start < clipper.display_end)
+                          ? gui_log_line_offset(state, top + (uint64_t)clipper.display_start)
+                          : 0;
+    for (int r = clipper.display_start; r < clipper.display_end; r++) {
+        uint64_t line_end = gui_log_find_newline(state, offset, state->scanned);
+        size_t n = gui_log_copy(state, offset, line_end, buf, read_max);
+        if (n > 0 && offset + n == line_end && buf[n - 1] == '\r') {
+            n--;
+        }
+        float y = rows_y + ((float)r * line_h);
+
+        // Matches are searched in the characters read, which cover the visible ones
+        for (size_t i = 0; query_len > 0 && i + query_len <= n; i++) {
+            if (memcmp(buf + i, highlight, query_len) == 0) {
+                gui_add_rect_filled(ctx, view.x + pad + ((float)i * char_w), y,
+                                    (float)query_len * char_w, line_h, style->text_highlight);
+                i += query_len - 1U;
+            }
+        }
+        gui_add_text_n(ctx, buf, (n < max_chars) ? n : max_chars, view.x + pad, y + (pad * 0.5F),
+                       style->text, style->text_size);
+        offset = line_end + 1U;
+    }
+    gui_pop_clip_rect(ctx);
+
+    gui_add_rect(ctx, rect.x, rect.y, rect.w, rect.h, style->table_border, 1.0F);
+    gui_pop_clip_rect(ctx);
+    GUI_TRACE_END();
+}
+
+// =============================================================================
+// TEXT BUFFER
+// =============================================================================
+
+static size_t gui_text_line_start_at(const gui_text_buffer_t *buf, uint32_t line) {
+    return buf->line_starts[line] + ((line >= buf->line_shift_from) ? buf->line_shift : 0U);
+}
+
+// Moves the first lazily shifted line to `from`, settling or unsettling the lines in between
+static void gui_text_lines_rebase(gui_text_buffer_t *buf, uint32_t from) {
+    for (uint32_t i = buf->line_shift_from; i < from; i++) {
+        buf->line_starts[i] += buf->line_shift;
+    }
+    for (uint32_t i = from; i < buf->line_shift_from; i++) {
+        buf->line_starts[i] -= buf->line_shift;
+    }
+    buf->line_shift_from = from;
+}
+
+static bool gui_text_insert_pieces(gui_text_buffer_t *buf, uint32_t at, uint32_t count) {
+    if (!gui_grow_array((void **)&buf->pieces, &buf->piece_capacity, buf->piece_count + count,
+                        sizeof(gui_text_piece_t))) {
+        return false;
+    }
+    memmove(&buf->pieces[at + count], &buf->pieces[at],
+            (buf->piece_count - at) * sizeof(gui_text_piece_t));
+    buf->piece_count += count;
+    return true;
+}
+
+// Piece containing `offset` (the end of the text gives piece_count) and its start, searched from
+// the last piece found so sequential accesses cost O(1)
+static uint32_t gui_text_find_piece(gui_text_buffer_t *buf, size_t offset, size_t *piece_start) {
+    uint32_t i = buf->cached_piece;
+    size_t start = buf->cached_start;
+    if (i > buf->piece_count) {
+        i = 0;
+        start = 0;
+    }
+    while (i > 0 && offset < start) {
+        i--;
+        start -= buf->pieces[i].length;
+    }
+    while (i < buf->piece_count && offset >= start + buf->pieces[i].length) {
+        start += buf->pieces[i].length;
+        i++;
+    }
+    buf->cached_piece = i;
+    buf->cached_start = start;
+    *piece_start = start;
+    return i;
+}
+
+bool gui_text_buffer_init(gui_text_buffer_t *buf, const char *text, size_t length) {
+    memset(buf, 0, sizeof(gui_text_buffer_t));
+    if (!gui_grow_array((void **)&buf->line_starts, &buf->line_capacity, 1, sizeof(size_t))) {
+        return false;
+    }
+    buf->line_starts[buf->line_count++] = 0;
+
+    if (text && length > 0) {
+        buf->original = (char *)CGUI_MALLOC(length);
+        if (!buf->original || !gui_text_insert_pieces(buf, 0, 1)) {
+            gui_text_buffer_free(buf);
+            return false;
+        }
+        memcpy(buf->original, text, length);
+        buf->pieces[0] = (gui_text_piece_t){false, 0, length};
+        buf->length = length;
+
+        const char *end = buf->original + length;
+        for (const char *p = memchr(buf->original, '\n', length); p;
+             p = memchr(p, '\n', (size_t)(end - p))) {
+            p++;
+            if (!gui_grow_array((void **)&buf->line_starts, &buf->line_capacity,
+                                buf->line_count + 1, sizeof(size_t))) {
+                gui_text_buffer_free(buf);
+                return false;
+            }
+            buf->line_starts[buf->line_count++] = (size_t)(p - buf->original);
+        }
+    }
+    buf->line_shift_from = buf->line_count;
+    return true;
+}
+
+void gui_text_buffer_free(gui_text_buffer_t *buf) {
+    CGUI_FREE(buf->original);
+    CGUI_FREE(buf->added);
+    CGUI_FREE(buf->pieces);
+    CGUI_FREE(buf->line_starts);
+    memset(buf, 0, sizeof(gui_text_buffer_t));
+}
+
+size_t gui_text_buffer_length(const gui_text_buffer_t *buf) { return buf->length; }
+
+uint32_t gui_text_buffer_line_count(const gui_text_buffer_t *buf) { return buf->line_count; }
+
+size_t gui_text_buffer_line_start(const gui_text_buffer_t *buf, uint32_t line) {
+    return (line < buf->line_count) ? gui_text_line_start_at(buf, line) : buf->length;
+}
+
+uint32_t gui_text_buffer_line_of(const gui_text_buffer_t *buf, size_t offset) {
+    // Last line starting at or before offset; line 0 starts at 0
+    uint32_t lo = 1;
+    uint32_t hi = buf->line_count;
+    while (lo < hi) {
+        uint32_t mid = lo + ((hi - lo) / 2U);
+        if (gui_text_line_start_at(buf, mid) <= offset) {
+            lo = mid + 1U;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo - 1U;
+}
+
+size_t gui_text_buffer_read(gui_text_buffer_t *buf, size_t offset, size_t length, char *out) {
+    if (offset >= buf->length) {
+        return 0;
+    }
+    length = (length < buf->length - offset) ? length : buf->length - offset;
+    size_t start;
+    uint32_t i = gui_text_find_piece(buf, offset, &start);
+    size_t copied = 0;
+    while (copied < length) {
+        const gui_text_piece_t *piece = &buf->pieces[i];
+        size_t skip = offset + copied - start;
+        size_t n = piece->length - skip;
+        n = (n < length - copied) ? n : length - copied;
+        memcpy(out + copied, (piece->added ? buf->added : buf->original) + piece->start + skip,
+               n);
+        copied += n;
+        if (skip + n == piece->length) {
+            start += piece->length;
+            i++;
+        }
+    }
+    buf->cached_piece = i;
+    buf->cached_start = start;
+    return copied;
+}
+
+bool gui_text_buffer_insert(gui_text_buffer_t *buf, size_t offset, const char *text,
+                            size_t length) {
+    if (!text || length == 0) {
+        return true;
+    }
+    offset = (offset < buf->length) ? offset : buf->length;
+    const char *text_end = text + length;
+    uint32_t new_lines = 0;
+    for (const char *p = memchr(text, '\n', length); p;
+         p = memchr(p + 1, '\n', (size_t)(text_end - p - 1))) {
+        new_lines++;
+    }
+
+    // Everything is reserved first, so running out of memory leaves the buffer unchanged
+    if (buf->added_length + length > buf->added_capacity) {
+        size_t capacity = (buf->added_capacity > 0) ? buf->added_capacity * 2U : 4096U;
+        capacity = (capacity > buf->added_length + length) ? capacity : buf->added_length + length;
+        char *grown = (char *)CGUI_REALLOC(buf->added, capacity);
+        if (!grown) {
+            return false;
+        }
+        buf->added = grown;
+        buf->added_capacity = capacity;
+    }
+    if (!gui_grow_array((void **)&buf->pieces, &buf->piece_capacity, buf->piece_count + 2U,
+                        sizeof(gui_text_piece_t)) ||
+        !gui_grow_array((void **)&buf->line_starts, &buf->line_capacity,
+                        buf->line_count + new_lines, sizeof(size_t))) {
+        return false;
+    }
+    uint32_t line = gui_text_buffer_line_of(buf, offset);
+
+    size_t added_start = buf->added_length;
+    memcpy(buf->added + added_start, text, length);
+    buf->added_length += length;
+
+    size_t start;
+    uint32_t i = gui_text_find_piece(buf, offset, &start);
+    gui_text_piece_t *prev = (i > 0) ? &buf->pieces[i - 1U] : NULL;
+    if (offset == start && prev && prev->added && prev->start + prev->length == added_start) {
+        // Continues the previous insertion (typing): the piece grows in place
+        buf->cached_piece = i - 1U;
+        buf->cached_start = start - prev->length;
+        prev->length += length;
+    } else if (offset == start) {
+        gui_text_insert_pieces(buf, i, 1);
+        buf->pieces[i] = (gui_text_piece_t){true, added_start, length};
+    } else {
+        // Split the piece around the insertion
+        gui_text_piece_t right = buf->pieces[i];
+        right.start += offset - start;
+        right.length -= offset - start;
+        buf->pieces[i].length = offset - start;
+        gui_text_insert_pieces(buf, i + 1U, 2);
+        buf->pieces[i + 1U] = (gui_text_piece_t){true, added_start, length};
+        buf->pieces[i + 2U] = right;
+    }
+    buf->length += length;
+
+    // The lines after the edited one move by `length`, after the lines the text adds
+    gui_text_lines_rebase(buf, line + 1U);
+    buf->line_shift += length;
+    memmove(&buf->line_starts[line + 1U + new_lines], &buf->line_starts[line + 1U],
+            (buf->line_count - line - 1U) * sizeof(size_t));
+    uint32_t at = line + 1U;
+    for (const char *p = memchr(text, '\n', length); p;
+         p = memchr(p + 1, '\n', (size_t)(text_end - p - 1))) {
+        buf->line_starts[at++] = offset + (size_t)(p - text) + 1U - buf->line_shift;
+    }
+    buf->line_count += new_lines;
+    buf->dirty_line = (line < buf->dirty_line) ? line : buf->dirty_line;
+    return true;
+}
+
+bool gui_text_buffer_erase(gui_text_buffer_t *buf, size_t offset, size_t length) {
+    if (offset >= buf->length || length == 0) {
+        return true;
+    }
+    length = (length < buf->length - offset) ? length : buf->length - offset;
+    uint32_t first_line = gui_text_buffer_line_of(buf, offset);
+    uint32_t last_line = gui_text_buffer_line_of(buf, offset + length);
+
+    size_t start;
+    uint32_t i = gui_text_find_piece(buf, offset, &start);
+    if (offset > start) {
+        // Keep the part of the first piece before the range as a piece of its own
+        if (!gui_text_insert_pieces(buf, i + 1U, 1)) {
+            return false;
+        }
+        buf->pieces[i + 1U] = buf->pieces[i];
+        buf->pieces[i].length = offset - start;
+        buf->pieces[i + 1U].start += offset - start;
+        buf->pieces[i + 1U].length -= offset - start;
+        i++;
+    }
+    uint32_t end = i;
+    size_t remaining = length;
+    while (remaining > 0 && remaining >= buf->pieces[end].length) {
+        remaining -= buf->pieces[end].length;
+        end++;
+    }
+    if (remaining > 0) {
+        buf->pieces[end].start += remaining;
+        buf->pieces[end].length -= remaining;
+    }
+    memmove(&buf->pieces[i], &buf->pieces[end],
+            (buf->piece_count - end) * sizeof(gui_text_piece_t));
+    buf->piece_count -= end - i;
+    buf->length -= length;
+    buf->cached_piece = i;
+    buf->cached_start = offset;
+
+    // Lines starting inside the range are gone; the lines after it move back by `length`
+    gui_text_lines_rebase(buf, first_line + 1U);
+    memmove(&buf->line_starts[first_line + 1U], &buf->line_starts[last_line + 1U],
+            (buf->line_count - last_line - 1U) * sizeof(size_t));
+    buf->line_count -= last_line - first_line;
+    buf->line_shift -= length;
+    buf->dirty_line = (first_line < buf->dirty_line) ? first_line : buf->dirty_line;
+    return true;
 }
 
-void gui_add_circle_filled(gui_context_t *ctx, float cx, float cy, float radius,
-                           gui_color_t color) {
-    const int segments = 32;
-    gui_prim_reserve(ctx, segments + 1, segments * 3);
+// =============================================================================
+// TEXT EDITOR
+// =============================================================================
 
-    uint32_t center_idx = ctx->vertex_count;
-    ctx->vertices[ctx->vertex_count++] = (gui_vertex_t){{cx, cy}, {0.5F, 0.5F}, color};
+// Text of a visible line, kept between frames
+typedef struct {
+    uint32_t line;
+    bool valid;
+    size_t length;
+    size_t capacity;
+    char *text;
+} gui_editor_line_t;
 
-    for (int i = 0; i <= segments; i++) {
-        float angle = ((float)i / (float)segments) * 2.0F * 3.14159265359F;
-        float x = cx + (cosf(angle) * radius);
-        float y = cy + (sinf(angle) * radius);
-        ctx->vertices[ctx->vertex_count++] = (gui_vertex_t){{x, y}, {0, 0}, color};
+typedef struct {
+    const gui_text_buffer_t *buffer; // Buffer the cached lines were read from
+    size_t cursor;
+    size_t anchor;      // Other end of the selection; equal to cursor when nothing is selected
+    size_t goal_column; // Column kept by vertical moves, SIZE_MAX when unset
+    double scroll;      // Line at the top of the view, with the fraction scrolled into it
+    float scroll_x;
+    gui_editor_line_t *lines; // Line l is cached in slot l % line_slots
+    uint32_t line_slots;
+} gui_editor_state_t;
+
+static void gui_editor_state_destroy(void *data) {
+    gui_editor_state_t *state = (gui_editor_state_t *)data;
+    for (uint32_t i = 0; i < state->line_slots; i++) {
+        CGUI_FREE(state->lines[i].text);
     }
+    CGUI_FREE(state->lines);
+}
 
-    for (int i = 0; i < segments; i++) {
-        ctx->indices[ctx->index_count++] = center_idx;
-        ctx->indices[ctx->index_count++] = center_idx + i + 1;
-        ctx->indices[ctx->index_count++] = center_idx + i + 2;
-    }
+// Offset of the line's newline, or the end of the text for the last line
+static size_t gui_editor_line_end(const gui_text_buffer_t *buf, uint32_t line) {
+    return (line + 1U < buf->line_count) ? gui_text_line_start_at(buf, line + 1U) - 1U
+                                         : buf->length;
 }
 
-void gui_add_circle(gui_context_t *ctx, float cx, float cy, float radius, gui_color_t color,
-                    float thickness) {
-    const int segments = 32;
-    for (int i = 0; i < segments; i++) {
-        float angle1 = ((float)i / (float)segments) * 2.0F * 3.14159265359F;
-        float angle2 = ((float)(i + 1) / (float)segments) * 2.0F * 3.14159265359F;
-        float x1 = cx + (cosf(angle1) * radius);
-        float y1 = cy + (sinf(angle1) * radius);
-        float x2 = cx + (cosf(angle2) * radius);
-        float y2 = cy + (sinf(angle2) * radius);
-        gui_add_line(ctx, x1, y1, x2, y2, color, thickness);
+static const gui_editor_line_t *gui_editor_line(gui_editor_state_t *state, gui_text_buffer_t *buf,
+                                                uint32_t line) {
+    gui_editor_line_t *slot = &state->lines[line % state->line_slots];
+    if (slot->valid && slot->line == line) {
+        return slot;
+    }
+    size_t start = gui_text_line_start_at(buf, line);
+    size_t length = gui_editor_line_end(buf, line) - start;
+    if (length > slot->capacity) {
+        char *grown = (char *)CGUI_REALLOC(slot->text, length);
+        if (grown) {
+            slot->text = grown;
+            slot->capacity = length;
+        }
     }
+    length = (length < slot->capacity) ? length : slot->capacity;
+    slot->length = gui_text_buffer_read(buf, start, length, slot->text);
+    slot->line = line;
+    slot->valid = true;
+    return slot;
 }
 
-void gui_add_triangle_filled(gui_context_t *ctx, float x1, float y1, float x2, float y2, float x3,
-                             float y3, gui_color_t color) {
-    gui_prim_reserve(ctx, 3, 3);
-    uint32_t idx = ctx->vertex_count;
+static bool gui_editor_continuation(gui_text_buffer_t *buf, size_t offset) {
+    char c = 0;
+    gui_text_buffer_read(buf, offset, 1, &c);
+    return ((unsigned char)c & 0xC0U) == 0x80U;
+}
 
-    ctx->vertices[ctx->vertex_count++] = (gui_vertex_t){{x1, y1}, {0, 0}, color};
-    ctx->vertices[ctx->vertex_count++] = (gui_vertex_t){{x2, y2}, {0, 0}, color};
-    ctx->vertices[ctx->vertex_count++] = (gui_vertex_t){{x3, y3}, {0, 0}, color};
+// Next or previous character boundary, stepping over UTF-8 sequences
+static size_t gui_editor_step(gui_text_buffer_t *buf, size_t offset, bool forward) {
+    if (forward) {
+        offset += (offset < buf->length) ? 1U : 0U;
+        while (offset < buf->length && gui_editor_continuation(buf, offset)) {
+            offset++;
+        }
+    } else {
+        offset -= (offset > 0) ? 1U : 0U;
+        while (offset > 0 && gui_editor_continuation(buf, offset)) {
+            offset--;
+        }
+    }
+    return offset;
+}
 
-    ctx->indices[ctx->index_count++] = idx + 0;
-    ctx->indices[ctx->index_count++] = idx + 1;
-    ctx->indices[ctx->index_count++] = idx + 2;
+// Offset of a column (one cell per byte, as gui_add_text draws), clamped to the line
+static size_t gui_editor_offset_at(gui_text_buffer_t *buf, uint32_t line, size_t column) {
+    size_t start = gui_text_line_start_at(buf, line);
+    size_t end = gui_editor_line_end(buf, line);
+    size_t offset = (column < end - start) ? start + column : end;
+    while (offset > start && gui_editor_continuation(buf, offset)) {
+        offset--;
+    }
+    return offset;
 }
 
-void gui_add_text(gui_context_t *ctx, const char *text, float x, float y, gui_color_t color,
-                  float font_size) {
-    // MVP: Simple text rendering using rectangles (placeholder for actual font rendering)
-    float cursor_x = x;
-    float char_width = font_size * 0.6F;
-    float char_height = font_size;
+bool gui_text_editor(gui_context_t *ctx, const char *id, gui_text_buffer_t *buf, float width,
+                     float height) {
+    GUI_TRACE_BEGIN("gui_text_editor");
+    ctx->stats.widget_count++;
+    gui_rect_t rect = gui_layout_next_rect(ctx, width, height, 400.0F, 300.0F);
+    gui_id_t editor_id = gui_get_id(ctx, id);
+    const gui_style_t *style = &ctx->style;
+    const gui_input_t *input = &ctx->input;
+    gui_editor_state_t *state = (gui_editor_state_t *)gui_get_state_ex(
+        ctx, editor_id, sizeof(gui_editor_state_t), gui_editor_state_destroy);
+    if (!state || buf->line_count == 0) {
+        GUI_TRACE_END();
+        return false; // Out of memory or not initialized
+    }
 
-    while (*text) {
-        if (*text == ' ') {
-            cursor_x += char_width;
-        } else {
-            // Draw a simple rectangle representing each character
-            gui_add_rect_filled(ctx, cursor_x, y, char_width * 0.8F, char_height, color);
-            cursor_x += char_width;
+    float pad = style->table_cell_padding;
+    float char_w = style->text_size * 0.6F;
+    float line_h = style->text_size + pad;
+    float bar_w = style->scrollbar_size;
+    gui_rect_t view = {rect.x, rect.y, fmaxf(0.0F, rect.w - bar_w), rect.h};
+    float view_lines = view.h / line_h;
+
+    // One cache slot per visible line; a different buffer drops them all
+    uint32_t slots = (uint32_t)fmaxf(ceilf(view_lines), 0.0F) + 1U;
+    if (slots > state->line_slots) {
+        gui_editor_line_t *grown =
+            (gui_editor_line_t *)CGUI_REALLOC(state->lines, slots * sizeof(gui_editor_line_t));
+        if (!grown) {
+            GUI_TRACE_END();
+            return false;
         }
-        text++;
+        memset(&grown[state->line_slots], 0, (slots - state->line_slots) * sizeof(*grown));
+        state->lines = grown;
+        state->line_slots = slots;
+        state->buffer = NULL; // Slots are assigned by line number modulo their count
     }
-}
-
-void gui_push_clip_rect(gui_context_t *ctx, float x, float y, float w, float h,
-                        bool intersect_with_current) {
-    if (ctx->clip_stack_count >= CGUI_MAX_CLIP_STACK) {
-        return;
+    if (state->buffer != buf) {
+        state->buffer = buf;
+        state->goal_column = SIZE_MAX;
+        buf->dirty_line = 0;
+    }
+    state->cursor = (state->cursor < buf->length) ? state->cursor : buf->length;
+    state->anchor = (state->anchor < buf->length) ? state->anchor : buf->length;
+
+    // Focus follows clicks; dragging moves the cursor and extends the selection
+    gui_id_t bar_id = gui_combine_id(editor_id, 1U);
+    bool hovered;
+    bool held;
+    gui_button_behavior(ctx, editor_id, view, &hovered, &held);
+    bool bar_hovered = ctx->hovered_item == bar_id;
+    if (input->mouse_clicked[GUI_MOUSE_BUTTON_LEFT] && !bar_hovered) {
+        if (hovered) {
+            ctx->focused_item = editor_id;
+        } else if (ctx->focused_item == editor_id) {
+            ctx->focused_item = 0;
+        }
+    }
+    bool shift = input->keys[GUI_KEY_LEFT_SHIFT] || input->keys[GUI_KEY_RIGHT_SHIFT];
+    bool ctrl = input->keys[GUI_KEY_LEFT_CONTROL] || input->keys[GUI_KEY_RIGHT_CONTROL];
+    bool moved = false;
+    if (held && input->mouse_down[GUI_MOUSE_BUTTON_LEFT]) {
+        double row = state->scroll + (double)((input->mouse_pos.y - view.y) / line_h);
+        uint32_t line = (row <= 0.0) ? 0U
+                        : (row >= (double)buf->line_count) ? buf->line_count - 1U
+                                                            : (uint32_t)row;
+        float column = ((input->mouse_pos.x - view.x - pad + state->scroll_x) / char_w) + 0.5F;
+        state->cursor = gui_editor_offset_at(buf, line, (size_t)fmaxf(column, 0.0F));
+        if (input->mouse_clicked[GUI_MOUSE_BUTTON_LEFT] && !shift) {
+            state->anchor = state->cursor;
+        }
+        state->goal_column = SIZE_MAX;
+        moved = true;
     }
 
-    gui_rect_t clip = {x, y, w, h};
+    bool changed = false;
+    if (ctx->focused_item == editor_id) {
+        const bool *pressed = input->keys_pressed;
+        uint32_t line = gui_text_buffer_line_of(buf, state->cursor);
+        size_t line_start = gui_text_line_start_at(buf, line);
+        size_t sel_lo = (state->cursor < state->anchor) ? state->cursor : state->anchor;
+        size_t sel_hi = (state->cursor < state->anchor) ? state->anchor : state->cursor;
+        size_t to = SIZE_MAX;
+        int64_t line_delta = 0;
+        if (pressed[GUI_KEY_LEFT]) {
+            to = (!shift && sel_lo < sel_hi) ? sel_lo : gui_editor_step(buf, state->cursor, false);
+        } else if (pressed[GUI_KEY_RIGHT]) {
+            to = (!shift && sel_lo < sel_hi) ? sel_hi : gui_editor_step(buf, state->cursor, true);
+        } else if (pressed[GUI_KEY_HOME]) {
+            to = ctrl ? 0 : line_start;
+        } else if (pressed[GUI_KEY_END]) {
+            to = ctrl ? buf->length : gui_editor_line_end(buf, line);
+        } else if (pressed[GUI_KEY_UP] || pressed[GUI_KEY_DOWN]) {
+            line_delta = pressed[GUI_KEY_UP] ? -1 : 1;
+        } else if (pressed[GUI_KEY_PAGE_UP] || pressed[GUI_KEY_PAGE_DOWN]) {
+            int64_t page = (int64_t)fmaxf(floorf(view_lines) - 1.0F, 1.0F);
+            line_delta = pressed[GUI_KEY_PAGE_UP] ? -page : page;
+        }
+        if (line_delta != 0) {
+            int64_t target = (int64_t)line + line_delta;
+            target = (target < 0) ? 0 : target;
+            target = (target >= (int64_t)buf->line_count) ? (int64_t)buf->line_count - 1 : target;
+            size_t column = (state->goal_column != SIZE_MAX) ? state->goal_column
+                                                             : state->cursor - line_start;
+            to = gui_editor_offset_at(buf, (uint32_t)target, column);
+            state->goal_column = column;
+        } else if (to != SIZE_MAX) {
+            state->goal_column = SIZE_MAX;
+        }
+        if (to != SIZE_MAX) {
+            state->cursor = to;
+            state->anchor = shift ? state->anchor : to;
+            moved = true;
+        }
+        if (ctrl && pressed[GUI_KEY_A]) {
+            state->anchor = 0;
+            state->cursor = buf->length;
+        }
 
-    if (intersect_with_current && ctx->clip_stack_count > 0) {
-        gui_rect_t current = ctx->clip_stack[ctx->clip_stack_count - 1];
-        clip = gui_intersect_rects(current, clip);
+        // Typing replaces the selection; Backspace and Delete without one erase a character
+        const char *insert = NULL;
+        if (pressed[GUI_KEY_ENTER]) {
+            insert = "\n";
+        } else if (pressed[GUI_KEY_TAB]) {
+            insert = "    ";
+        } else if (input->text_input[0] != '\0' && !ctrl) {
+            insert = input->text_input;
+        }
+        bool erase_prev = pressed[GUI_KEY_BACKSPACE];
+        bool erase_next = pressed[GUI_KEY_DELETE];
+        if (insert || erase_prev || erase_next) {
+            sel_lo = (state->cursor < state->anchor) ? state->cursor : state->anchor;
+            sel_hi = (state->cursor < state->anchor) ? state->anchor : state->cursor;
+            if (sel_lo == sel_hi && !insert) {
+                sel_lo = erase_prev ? gui_editor_step(buf, sel_lo, false) : sel_lo;
+                sel_hi = erase_next ? gui_editor_step(buf, sel_hi, true) : sel_hi;
+            }
+            if (gui_text_buffer_erase(buf, sel_lo, sel_hi - sel_lo)) {
+                changed = sel_hi > sel_lo;
+                state->cursor = sel_lo;
+                size_t insert_len = insert ? strlen(insert) : 0;
+                if (insert_len > 0 && gui_text_buffer_insert(buf, sel_lo, insert, insert_len)) {
+                    state->cursor += insert_len;
+                    changed = true;
+                }
+            }
+            state->anchor = state->cursor;
+            state->goal_column = SIZE_MAX;
+            moved = true;
+        }
     }
 
-    ctx->clip_stack[ctx->clip_stack_count++] = clip;
-}
+    // Edits invalidate the cached lines from the first edited one on
+    for (uint32_t i = 0; buf->dirty_line != UINT32_MAX && i < state->line_slots; i++) {
+        if (state->lines[i].line >= buf->dirty_line) {
+            state->lines[i].valid = false;
+        }
+    }
+    buf->dirty_line = UINT32_MAX;
 
-void gui_pop_clip_rect(gui_context_t *ctx) {
-    if (ctx->clip_stack_count > 1) {
-        ctx->clip_stack_count--;
+    // Scrolling, in lines as for gui_log_view; cursor moves scroll it into view
+    double max_scroll = fmax(0.0, (double)buf->line_count - (double)view_lines);
+    double scroll = state->scroll;
+    if (input->mouse_wheel != 0.0F && (hovered || bar_hovered)) {
+        scroll -= (double)input->mouse_wheel * 3.0;
+    }
+    uint32_t cursor_line = gui_text_buffer_line_of(buf, state->cursor);
+    if (moved) {
+        float text_w = view.w - (pad * 2.0F);
+        float cursor_x =
+            (float)(state->cursor - gui_text_line_start_at(buf, cursor_line)) * char_w;
+        scroll = fmin(scroll, (double)cursor_line);
+        scroll = fmax(scroll, (double)cursor_line + 1.0 - (double)view_lines);
+        state->scroll_x = fminf(state->scroll_x, cursor_x);
+        state->scroll_x = fmaxf(state->scroll_x, cursor_x + char_w - text_w);
     }
+    state->scroll_x = fmaxf(state->scroll_x, 0.0F);
+
+    gui_push_clip_rect(ctx, rect.x, rect.y, rect.w, rect.h, true);
+    gui_add_rect_filled(ctx, rect.x, rect.y, rect.w, rect.h, style->table_bg);
+    gui_rect_t bar_rect = {view.x + view.w, view.y, bar_w, view.h};
+    float bar_scroll = (float)scroll;
+    float before = bar_scroll;
+    gui_scrollbar(ctx, bar_id, bar_rect, true, &bar_scroll, (float)buf->line_count, view_lines);
+    scroll = (bar_scroll != before) ? (double)bar_scroll : scroll;
+    scroll = fmin(fmax(scroll, 0.0), max_scroll);
+    state->scroll = scroll;
+
+    // Visible lines: selection, text, cursor
+    uint32_t top = (uint32_t)scroll;
+    float top_offset = (float)(scroll - (double)top) * line_h;
+    uint32_t below = buf->line_count - top;
+    gui_list_clipper_t clipper;
+    gui_list_clipper_begin(&clipper, (below > INT32_MAX) ? INT32_MAX : (int)below, line_h,
+                           top_offset, view.h);
+    float rows_y = view.y - top_offset;
+    float text_x = view.x + pad - state->scroll_x;
+    size_t first_column = (size_t)(state->scroll_x / char_w);
+    size_t max_chars = (size_t)fmaxf(0.0F, (view.w / char_w) + 2.0F);
+    size_t sel_lo = (state->cursor < state->anchor) ? state->cursor : state->anchor;
+    size_t sel_hi = (state->cursor < state->anchor) ? state->anchor : state->cursor;
+    bool focused = ctx->focused_item == editor_id;
+
+    gui_push_clip_rect(ctx, view.x, view.y, view.w, view.h, true);
+    for (int r = clipper.display_start; r < clipper.display_end; r++) {
+        uint32_t line = top + (uint32_t)r;
+        float y = rows_y + ((float)r * line_h);
+        size_t start = gui_text_line_start_at(buf, line);
+        const gui_editor_line_t *text = gui_editor_line(state, buf, line);
+
+        // A selected line break shows as one selected cell
+        size_t a = (sel_lo > start) ? sel_lo - start : 0;
+        size_t b = (sel_hi > start) ? sel_hi - start : 0;
+        b = (b < text->length + 1U) ? b : text->length + 1U;
+        if (b > a) {
+            gui_add_rect_filled(ctx, text_x + ((float)a * char_w), y, (float)(b - a) * char_w,
+                                line_h, style->text_highlight);
+        }
+        if (text->length > first_column) {
+            size_t n = text->length - first_column;
+            gui_add_text_n(ctx, text->text + first_column, (n < max_chars) ? n : max_chars,
+                           text_x + ((float)first_column * char_w), y + (pad * 0.5F),
+                           style->text, style->text_size);
+        }
+        if (focused && line == cursor_line) {
+            gui_add_rect_filled(ctx, text_x + ((float)(state->cursor - start) * char_w), y, 1.0F,
+                                line_h, style->text);
+        }
+    }
+    gui_pop_clip_rect(ctx);
+
+    gui_add_rect(ctx, rect.x, rect.y, rect.w, rect.h,
+                 focused ? style->slider_grab_active : style->table_border, 1.0F);
+    gui_pop_clip_rect(ctx);
+    GUI_TRACE_END();
+    return changed;
 }
 
 // =============================================================================
-// WIDGETS
+// TREE VIEW
 // =============================================================================
 
-void gui_label(gui_context_t *ctx, const char *text) {
-    gui_layout_state_t *layout = gui_get_current_layout(ctx);
+typedef struct {
+    uint64_t node;
+    uint32_t depth;
+    bool open;
+} gui_tree_row_t;
 
-    float x;
-    float y;
-    if (layout) {
-        x = layout->cursor_x;
-        y = layout->cursor_y;
+// Children of one node during a walk: ids[next, end) are still to be emitted
+typedef struct {
+    uint32_t next;
+    uint32_t end;
+    uint32_t depth;
+} gui_tree_walk_t;
 
-        float text_h = ctx->style.text_size;
+typedef struct {
+    uint64_t root;
+    uint32_t version;
+    bool built;
+    gui_tree_row_t *rows; // Visible rows in display order
+    uint32_t row_count;
+    uint32_t row_capacity;
+    gui_tree_row_t *scratch; // Rows collected for splicing in
+    uint32_t scratch_count;
+    uint32_t scratch_capacity;
+    uint64_t *ids;
+    uint32_t id_count;
+    uint32_t id_capacity;
+    gui_tree_walk_t *walk;
+    uint32_t walk_count;
+    uint32_t walk_capacity;
+    uint64_t *open_nodes; // Sorted
+    uint32_t open_count;
+    uint32_t open_capacity;
+    double scroll; // In rows
+} gui_tree_state_t;
+
+static void gui_tree_state_destroy(void *data) {
+    gui_tree_state_t *state = (gui_tree_state_t *)data;
+    CGUI_FREE(state->rows);
+    CGUI_FREE(state->scratch);
+    CGUI_FREE(state->ids);
+    CGUI_FREE(state->walk);
+    CGUI_FREE(state->open_nodes);
+}
 
-        if (layout->type == GUI_LAYOUT_VBOX) {
-            layout->cursor_y += text_h + layout->spacing;
-        } else if (layout->type == GUI_LAYOUT_HBOX) {
-            float text_w = gui_text_width(text, ctx->style.text_size);
-            layout->cursor_x += text_w + layout->spacing;
+// Index of the first open node not below node
+static uint32_t gui_tree_open_lower_bound(const gui_tree_state_t *state, uint64_t node) {
+    uint32_t lo = 0;
+    uint32_t hi = state->open_count;
+    while (lo < hi) {
+        uint32_t mid = lo + ((hi - lo) / 2U);
+        if (state->open_nodes[mid] < node) {
+            lo = mid + 1U;
+        } else {
+            hi = mid;
         }
-    } else {
-        x = 10;
-        y = 10;
     }
+    return lo;
+}
 
-    gui_add_text(ctx, text, x, y, ctx->style.text, ctx->style.text_size);
+static bool gui_tree_is_open(const gui_tree_state_t *state, uint64_t node) {
+    uint32_t i = gui_tree_open_lower_bound(state, node);
+    return i < state->open_count && state->open_nodes[i] == node;
 }
 
-bool gui_button(gui_context_t *ctx, const char *label, float width, float height) {
-    gui_layout_state_t *layout = gui_get_current_layout(ctx);
+// Open flags are kept with the tree's state, so they last exactly as long as the tree does
+static bool gui_tree_set_open(gui_tree_state_t *state, uint64_t node, bool open) {
+    uint32_t i = gui_tree_open_lower_bound(state, node);
+    bool found = i < state->open_count && state->open_nodes[i] == node;
+    if (open && !found) {
+        if (!gui_grow_array((void **)&state->open_nodes, &state->open_capacity,
+                            state->open_count + 1U, sizeof(uint64_t))) {
+            return false;
+        }
+        memmove(&state->open_nodes[i + 1U], &state->open_nodes[i],
+                (state->open_count - i) * sizeof(uint64_t));
+        state->open_nodes[i] = node;
+        state->open_count++;
+    } else if (!open && found) {
+        memmove(&state->open_nodes[i], &state->open_nodes[i + 1U],
+                (state->open_count - i - 1U) * sizeof(uint64_t));
+        state->open_count--;
+    }
+    return true;
+}
 
-    // Calculate button position and size
-    float x;
-    float y;
-    float w;
-    float h;
-    if (layout) {
-        x = layout->cursor_x;
-        y = layout->cursor_y;
+// Appends the children of a node to ids and pushes them as the next level of the walk
+static bool gui_tree_push_children(gui_tree_state_t *state, const gui_tree_desc_t *desc,
+                                   uint64_t node, uint32_t depth) {
+    if (!gui_grow_array((void **)&state->walk, &state->walk_capacity, state->walk_count + 1U,
+                        sizeof(gui_tree_walk_t))) {
+        return false;
+    }
+    uint32_t room = state->id_capacity - state->id_count;
+    uint32_t count = desc->children(desc->user_data, node, state->ids + state->id_count, room);
+    if (count > room) {
+        if (!gui_grow_array((void **)&state->ids, &state->id_capacity, state->id_count + count,
+                            sizeof(uint64_t))) {
+            return false;
+        }
+        room = state->id_capacity - state->id_count;
+        count = desc->children(desc->user_data, node, state->ids + state->id_count, room);
+        count = (count < room) ? count : room;
+    }
+    state->walk[state->walk_count++] =
+        (gui_tree_walk_t){state->id_count, state->id_count + count, depth};
+    state->id_count += count;
+    return true;
+}
 
-        if (layout->type == GUI_LAYOUT_VBOX) {
-            w = (width > 0) ? width : layout->item_width;
-            h = (height > 0) ? height : 30.0F;
-            layout->cursor_y += h + layout->spacing;
-        } else if (layout->type == GUI_LAYOUT_HBOX) {
-            w = (width > 0) ? width : 100.0F;
-            h = (height > 0) ? height : layout->item_height;
-            layout->cursor_x += w + layout->spacing;
-        } else {
-            w = (width > 0) ? width : 100.0F;
-            h = (height > 0) ? height : 30.0F;
+// Collects the visible descendants of an open node into scratch, walking only open subtrees
+static bool gui_tree_collect(gui_tree_state_t *state, const gui_tree_desc_t *desc, uint64_t node,
+                             uint32_t depth) {
+    state->scratch_count = 0;
+    state->id_count = 0;
+    state->walk_count = 0;
+    if (!desc->children || !gui_tree_push_children(state, desc, node, depth)) {
+        return false;
+    }
+    while (state->walk_count > 0) {
+        gui_tree_walk_t *level = &state->walk[state->walk_count - 1U];
+        if (level->next == level->end) {
+            // The ids of a finished level are the last ones appended
+            state->walk_count--;
+            state->id_count = (state->walk_count > 0) ? state->walk[state->walk_count - 1U].end : 0;
+            continue;
+        }
+        uint64_t child = state->ids[level->next++];
+        uint32_t child_depth = level->depth;
+        bool open = gui_tree_is_open(state, child);
+        if (!gui_grow_array((void **)&state->scratch, &state->scratch_capacity,
+                            state->scratch_count + 1U, sizeof(gui_tree_row_t))) {
+            return false;
+        }
+        state->scratch[state->scratch_count++] = (gui_tree_row_t){child, child_depth, open};
+        if (open && !gui_tree_push_children(state, desc, child, child_depth + 1U)) {
+            return false;
         }
-    } else {
-        x = 10;
-        y = 10;
-        w = (width > 0) ? width : 100.0F;
-        h = (height > 0) ? height : 30.0F;
     }
+    return true;
+}
 
-    // Generate unique ID
-    gui_id_t id = gui_hash_string(label);
+// Splices the rows below row r in or out after it was toggled
+static bool gui_tree_toggle(gui_tree_state_t *state, const gui_tree_desc_t *desc, uint32_t r) {
+    gui_tree_row_t *row = &state->rows[r];
+    if (row->open) {
+        uint32_t end = r + 1U;
+        while (end < state->row_count && state->rows[end].depth > row->depth) {
+            end++;
+        }
+        memmove(&state->rows[r + 1U], &state->rows[end],
+                (state->row_count - end) * sizeof(gui_tree_row_t));
+        state->row_count -= end - r - 1U;
+    } else {
+        if (!gui_tree_collect(state, desc, row->node, row->depth + 1U) ||
+            !gui_grow_array((void **)&state->rows, &state->row_capacity,
+                            state->row_count + state->scratch_count, sizeof(gui_tree_row_t))) {
+            return false;
+        }
+        row = &state->rows[r];
+        memmove(&state->rows[r + 1U + state->scratch_count], &state->rows[r + 1U],
+                (state->row_count - r - 1U) * sizeof(gui_tree_row_t));
+        memcpy(&state->rows[r + 1U], state->scratch,
+               state->scratch_count * sizeof(gui_tree_row_t));
+        state->row_count += state->scratch_count;
+    }
+    row->open = !row->open;
+    return gui_tree_set_open(state, row->node, row->open);
+}
 
-    // Check interaction
-    gui_rect_t rect = {x, y, w, h};
-    bool hovered = gui_rect_contains(rect, ctx->input.mouse_pos.x, ctx->input.mouse_pos.y);
-    bool clicked = false;
+bool gui_tree_view(gui_context_t *ctx, const char *id, const gui_tree_desc_t *desc,
+                   uint64_t *selected, float width, float height) {
+    GUI_TRACE_BEGIN("gui_tree_view");
+    ctx->stats.widget_count++;
+    gui_rect_t rect = gui_layout_next_rect(ctx, width, height, 300.0F, 300.0F);
+    gui_id_t tree_id = gui_get_id(ctx, id);
+    const gui_style_t *style = &ctx->style;
+    gui_tree_state_t *state = (gui_tree_state_t *)gui_get_state_ex(
+        ctx, tree_id, sizeof(gui_tree_state_t), gui_tree_state_destroy);
+    if (!state) {
+        GUI_TRACE_END();
+        return false;
+    }
 
-    if (hovered) {
-        ctx->hot_item = id;
-        if (ctx->active_item == 0 && ctx->input.mouse_clicked[GUI_MOUSE_BUTTON_LEFT]) {
-            ctx->active_item = id;
+    // The whole list is only walked again when the tree itself changes
+    if (!state->built || state->root != desc->root || state->version != desc->version) {
+        state->row_count = 0;
+        if (gui_tree_collect(state, desc, desc->root, 0) &&
+            gui_grow_array((void **)&state->rows, &state->row_capacity, state->scratch_count,
+                           sizeof(gui_tree_row_t))) {
+            memcpy(state->rows, state->scratch, state->scratch_count * sizeof(gui_tree_row_t));
+            state->row_count = state->scratch_count;
         }
+        state->root = desc->root;
+        state->version = desc->version;
+        state->built = true;
     }
 
-    if (ctx->active_item == id) {
-        if (ctx->input.mouse_released[GUI_MOUSE_BUTTON_LEFT]) {
-            if (hovered) {
-                clicked = true;
+    float pad = style->table_cell_padding;
+    float row_h = style->text_size + (pad * 2.0F);
+    float indent = style->text_size;
+    float char_w = style->text_size * 0.6F;
+    float view_rows = rect.h / row_h;
+    bool need_v = (float)state->row_count > view_rows;
+    float bar_w = need_v ? style->scrollbar_size : 0.0F;
+    gui_rect_t view = {rect.x, rect.y, fmaxf(0.0F, rect.w - bar_w), rect.h};
+
+    // One hit rect for the view; the row under a click is found from its position. Clicking a
+    // row's arrow toggles it, clicking elsewhere selects it.
+    char buf[256];
+    bool hovered;
+    bool picked = false;
+    if (gui_button_behavior(ctx, tree_id, view, &hovered, NULL)) {
+        double row_pos = state->scroll + (double)((ctx->input.mouse_pos.y - view.y) / row_h);
+        if (row_pos >= 0.0 && row_pos < (double)state->row_count) {
+            uint32_t r = (uint32_t)row_pos;
+            const gui_tree_row_t *row = &state->rows[r];
+            bool has_children = false;
+            if (desc->label) {
+                desc->label(desc->user_data, row->node, &has_children, buf, sizeof(buf));
+            }
+            float arrow_x = view.x + pad + ((float)row->depth * indent);
+            float mouse_x = ctx->input.mouse_pos.x;
+            if ((has_children || row->open) && mouse_x >= arrow_x && mouse_x < arrow_x + indent) {
+                gui_tree_toggle(state, desc, r);
+            } else if (selected) {
+                *selected = row->node;
+                picked = true;
             }
-            ctx->active_item = 0;
         }
     }
 
-    // Determine color based on state
-    gui_color_t bg_color;
-    if (ctx->active_item == id) {
-        bg_color = ctx->style.button_bg_active;
-    } else if (ctx->hot_item == id) {
-        bg_color = ctx->style.button_bg_hovered;
-    } else {
-        bg_color = ctx->style.button_bg;
+    double max_scroll = fmax(0.0, (double)state->row_count - (double)view_rows);
+    double scroll = state->scroll;
+    if (hovered && ctx->input.mouse_wheel != 0.0F) {
+        scroll -= (double)ctx->input.mouse_wheel * 3.0;
     }
 
-    // Draw button
-    gui_add_rect_filled(ctx, x, y, w, h, bg_color);
-    gui_add_rect(ctx, x, y, w, h, GUI_COLOR_BLACK, 1.0F);
+    gui_push_clip_rect(ctx, rect.x, rect.y, rect.w, rect.h, true);
+    gui_add_rect_filled(ctx, rect.x, rect.y, rect.w, rect.h, style->table_bg);
+    if (need_v) {
+        gui_rect_t bar_rect = {view.x + view.w, view.y, bar_w, view.h};
+        float bar_scroll = (float)scroll;
+        float before = bar_scroll;
+        gui_scrollbar(ctx, gui_combine_id(tree_id, 1U), bar_rect, true, &bar_scroll,
+                      (float)state->row_count, view_rows);
+        scroll = (bar_scroll != before) ? (double)bar_scroll : scroll;
+    }
+    scroll = fmin(fmax(scroll, 0.0), max_scroll);
+    state->scroll = scroll;
+
+    // Visible rows only: selection, arrow, label
+    uint32_t top = (uint32_t)scroll;
+    float top_offset = (float)(scroll - (double)top) * row_h;
+    uint32_t below = state->row_count - top;
+    gui_list_clipper_t clipper;
+    gui_list_clipper_begin(&clipper, (below > INT32_MAX) ? INT32_MAX : (int)below, row_h,
+                           top_offset, view.h);
+    float rows_y = view.y - top_offset;
+
+    gui_push_clip_rect(ctx, view.x, view.y, view.w, view.h, true);
+    for (int r = clipper.display_start; r < clipper.display_end; r++) {
+        const gui_tree_row_t *row = &state->rows[top + (uint32_t)r];
+        float y = rows_y + ((float)r * row_h);
+        if (selected && *selected == row->node) {
+            gui_add_rect_filled(ctx, view.x, y, view.w, row_h, style->table_header_bg);
+        }
+        bool has_children = false;
+        const char *label =
+            desc->label ? desc->label(desc->user_data, row->node, &has_children, buf, sizeof(buf))
+                        : NULL;
+        float x = view.x + pad + ((float)row->depth * indent);
+        float cx = x + (indent * 0.5F);
+        float cy = y + (row_h * 0.5F);
+        float a = indent * 0.25F;
+        if (row->open) {
+            gui_add_triangle_filled(ctx, cx - a, cy - (a * 0.6F), cx + a, cy - (a * 0.6F), cx,
+                                    cy + (a * 0.8F), style->text);
+        } else if (has_children) {
+            gui_add_triangle_filled(ctx, cx - (a * 0.6F), cy - a, cx + (a * 0.8F), cy,
+                                    cx - (a * 0.6F), cy + a, style->text);
+        }
+        if (label) {
+            float text_x = x + indent;
+            size_t max_chars = (size_t)fmaxf(0.0F, ((view.x + view.w - text_x) / char_w) + 1.0F);
+            gui_add_text_n(ctx, label, max_chars, text_x, y + pad, style->text, style->text_size);
+        }
+    }
+    gui_pop_clip_rect(ctx);
 
-    // Draw label (centered)
-    float text_w = gui_text_width(label, ctx->style.text_size);
-    float text_x = x + ((w - text_w) * 0.5F);
-    float text_y = y + ((h - ctx->style.text_size) * 0.5F);
-    gui_add_text(ctx, label, text_x, text_y, ctx->style.button_text, ctx->style.text_size);
+    gui_add_rect(ctx, rect.x, rect.y, rect.w, rect.h, style->table_border, 1.0F);
+    gui_pop_clip_rect(ctx);
+    GUI_TRACE_END();
+    return picked;
+}
 
-    return clicked;
+// =============================================================================
+// NODE GRAPH
+// =============================================================================
+
+typedef struct {
+    uint32_t version;
+    uint32_t node_count;
+    uint32_t link_count;
+    bool dirty;      // Grid out of date, rebuilt once no node is dragged
+    gui_grid_t grid; // Over bounds: nodes first, then links
+    gui_rect_t *bounds;
+    uint32_t bounds_capacity;
+    uint32_t *link_start; // Links of node n: node_links[link_start[n] .. link_start[n + 1])
+    uint32_t link_start_capacity;
+    uint32_t *node_links;
+    uint32_t node_links_capacity;
+    uint32_t *marks; // Query stamp per item, so items spanning several cells are visited once
+    uint32_t mark_capacity;
+    uint32_t stamp;
+    uint32_t *visible;
+    uint32_t visible_capacity;
+    float offset_x; // Canvas point at the top left of the view
+    float offset_y;
+    float zoom;
+    uint32_t drag_node; // UINT32_MAX when panning or idle
+    gui_vec2_t drag_offset;
+    gui_vec2_t last_mouse;
+} gui_graph_state_t;
+
+static void gui_graph_state_destroy(void *data) {
+    gui_graph_state_t *state = (gui_graph_state_t *)data;
+    gui_grid_free(&state->grid);
+    CGUI_FREE(state->bounds);
+    CGUI_FREE(state->link_start);
+    CGUI_FREE(state->node_links);
+    CGUI_FREE(state->marks);
+    CGUI_FREE(state->visible);
 }
 
-bool gui_slider_float(gui_context_t *ctx, const char *label, float *value, float min, float max,
-                      float width) {
-    gui_layout_state_t *layout = gui_get_current_layout(ctx);
+// Cubic from the right edge of one node to the left edge of the other, in canvas units
+static bool gui_graph_link_curve(const gui_graph_desc_t *desc, const gui_graph_link_t *link,
+                                 gui_vec2_t p[4]) {
+    if (link->from >= desc->node_count || link->to >= desc->node_count) {
+        return false;
+    }
+    gui_rect_t a = desc->nodes[link->from].rect;
+    gui_rect_t b = desc->nodes[link->to].rect;
+    p[0] = (gui_vec2_t){a.x + a.w, a.y + (a.h * 0.5F)};
+    p[3] = (gui_vec2_t){b.x, b.y + (b.h * 0.5F)};
+    float bend = fmaxf(fabsf(p[3].x - p[0].x) * 0.5F, 40.0F);
+    p[1] = (gui_vec2_t){p[0].x + bend, p[0].y};
+    p[2] = (gui_vec2_t){p[3].x - bend, p[3].y};
+    return true;
+}
 
-    // Calculate slider position and size
-    float x;
-    float y;
-    float w;
-    float h;
-    if (layout) {
-        x = layout->cursor_x;
-        y = layout->cursor_y;
+// The curve lies within the bounds of its control points
+static gui_rect_t gui_graph_curve_bounds(const gui_vec2_t p[4]) {
+    float x0 = fminf(fminf(p[0].x, p[1].x), fminf(p[2].x, p[3].x));
+    float y0 = fminf(fminf(p[0].y, p[1].y), fminf(p[2].y, p[3].y));
+    float x1 = fmaxf(fmaxf(p[0].x, p[1].x), fmaxf(p[2].x, p[3].x));
+    float y1 = fmaxf(fmaxf(p[0].y, p[1].y), fmaxf(p[2].y, p[3].y));
+    return (gui_rect_t){x0, y0, x1 - x0, y1 - y0};
+}
 
-        if (layout->type == GUI_LAYOUT_VBOX) {
-            w = (width > 0) ? width : layout->item_width;
-            h = ctx->style.slider_height;
-            layout->cursor_y += h + layout->spacing;
-        } else if (layout->type == GUI_LAYOUT_HBOX) {
-            w = (width > 0) ? width : 200.0F;
-            h = ctx->style.slider_height;
-            layout->cursor_x += w + layout->spacing;
-        } else {
-            w = (width > 0) ? width : 200.0F;
-            h = ctx->style.slider_height;
+static gui_rect_t gui_graph_link_bounds(const gui_graph_desc_t *desc, uint32_t link) {
+    gui_vec2_t p[4];
+    return gui_graph_link_curve(desc, &desc->links[link], p) ? gui_graph_curve_bounds(p)
+                                                             : (gui_rect_t){0}; // Never drawn
+}
+
+static void gui_graph_build(gui_graph_state_t *state, const gui_graph_desc_t *desc) {
+    uint32_t count = desc->node_count + desc->link_count;
+    state->version = desc->version;
+    state->node_count = 0;
+    state->link_count = 0;
+    state->dirty = false;
+    if (!gui_grow_array((void **)&state->bounds, &state->bounds_capacity, count,
+                        sizeof(gui_rect_t)) ||
+        !gui_grow_array((void **)&state->marks, &state->mark_capacity, count,
+                        sizeof(uint32_t)) ||
+        !gui_grow_array((void **)&state->link_start, &state->link_start_capacity,
+                        desc->node_count + 1U, sizeof(uint32_t)) ||
+        !gui_grow_array((void **)&state->node_links, &state->node_links_capacity,
+                        desc->link_count * 2U, sizeof(uint32_t))) {
+        state->grid.cols = 0;
+        state->grid.rows = 0;
+        return;
+    }
+    for (uint32_t i = 0; i < desc->node_count; i++) {
+        state->bounds[i] = desc->nodes[i].rect;
+    }
+    for (uint32_t i = 0; i < desc->link_count; i++) {
+        state->bounds[desc->node_count + i] = gui_graph_link_bounds(desc, i);
+    }
+    memset(state->marks, 0, count * sizeof(uint32_t));
+    state->stamp = 0;
+    gui_grid_build(&state->grid, state->bounds, sizeof(gui_rect_t), count, CGUI_GRAPH_CELL_SIZE);
+
+    // Links per node, binned like the grid, so moving a node updates only its own links
+    memset(state->link_start, 0, (desc->node_count + 1U) * sizeof(uint32_t));
+    uint32_t total = 0;
+    for (uint32_t i = 0; i < desc->link_count; i++) {
+        const gui_graph_link_t *link = &desc->links[i];
+        if (link->from < desc->node_count && link->to < desc->node_count) {
+            state->link_start[link->from]++;
+            state->link_start[link->to]++;
+            total += 2U;
         }
-    } else {
-        x = 10;
-        y = 10;
-        w = (width > 0) ? width : 200.0F;
-        h = ctx->style.slider_height;
     }
+    uint32_t sum = 0;
+    for (uint32_t n = 0; n < desc->node_count; n++) {
+        sum += state->link_start[n];
+        state->link_start[n] = sum;
+    }
+    state->link_start[desc->node_count] = total;
+    for (uint32_t i = 0; i < desc->link_count; i++) {
+        const gui_graph_link_t *link = &desc->links[i];
+        if (link->from < desc->node_count && link->to < desc->node_count) {
+            state->node_links[--state->link_start[link->from]] = i;
+            state->node_links[--state->link_start[link->to]] = i;
+        }
+    }
+    state->node_count = desc->node_count;
+    state->link_count = desc->link_count;
+}
 
-    // Generate unique ID
-    gui_id_t id = gui_hash_string(label);
+// Moves a node without rebuilding the grid: its bounds and those of its links are updated in
+// place and gui_graph_query checks them directly until the grid is rebuilt
+static void gui_graph_move_node(gui_graph_state_t *state, const gui_graph_desc_t *desc,
+                                uint32_t node, float x, float y) {
+    desc->nodes[node].rect.x = x;
+    desc->nodes[node].rect.y = y;
+    state->bounds[node] = desc->nodes[node].rect;
+    for (uint32_t k = state->link_start[node]; k < state->link_start[node + 1U]; k++) {
+        uint32_t link = state->node_links[k];
+        state->bounds[state->node_count + link] = gui_graph_link_bounds(desc, link);
+    }
+    state->dirty = true;
+}
 
-    // Calculate grab position
-    float normalized = (*value - min) / (max - min);
-    if (normalized < 0.0F) {
-        normalized = 0.0F;
+static bool gui_graph_visit(gui_graph_state_t *state, gui_rect_t area, uint32_t i,
+                            uint32_t *found) {
+    if (state->marks[i] == state->stamp) {
+        return true;
     }
-    if (normalized > 1.0F) {
-        normalized = 1.0F;
+    state->marks[i] = state->stamp;
+    gui_rect_t b = state->bounds[i];
+    if (b.x > area.x + area.w || b.y > area.y + area.h || b.x + b.w < area.x ||
+        b.y + b.h < area.y) {
+        return true;
     }
+    if (!gui_grow_array((void **)&state->visible, &state->visible_capacity, *found + 1U,
+                        sizeof(uint32_t))) {
+        return false;
+    }
+    state->visible[(*found)++] = i;
+    return true;
+}
 
-    float grab_w = ctx->style.slider_grab_size;
-    float grab_x = x + ((w - grab_w) * normalized);
-    float grab_y = y + ((h - grab_w) * 0.5F);
+static int gui_graph_compare_index(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
 
-    gui_rect_t grab_rect = {grab_x, grab_y, grab_w, grab_w};
-    gui_rect_t track_rect = {x, y, w, h};
+// Collects the items whose bounds overlap `area`, each once, in index order
+static uint32_t gui_graph_query(gui_graph_state_t *state, gui_rect_t area) {
+    const gui_grid_t *grid = &state->grid;
+    uint32_t count = state->node_count + state->link_count;
+    if (grid->cols == 0 || count == 0) {
+        return 0;
+    }
+    if (++state->stamp == 0) {
+        memset(state->marks, 0, count * sizeof(uint32_t));
+        state->stamp = 1;
+    }
+    int c0, r0, c1, r1;
+    gui_grid_cell_range(grid, area, &c0, &r0, &c1, &r1);
+    uint32_t found = 0;
+    bool ok = true;
+    for (int r = r0; r <= r1 && ok; r++) {
+        for (int c = c0; c <= c1 && ok; c++) {
+            int cell = (r * grid->cols) + c;
+            for (uint32_t e = grid->cell_start[cell]; e < grid->cell_start[cell + 1] && ok; e++) {
+                ok = gui_graph_visit(state, area, grid->entries[e], &found);
+            }
+        }
+    }
 
-    bool hovered = gui_rect_contains(grab_rect, ctx->input.mouse_pos.x, ctx->input.mouse_pos.y) ||
-                   gui_rect_contains(track_rect, ctx->input.mouse_pos.x, ctx->input.mouse_pos.y);
-    bool changed = false;
+    // A dragged node and its links may have left the cells they are binned in
+    uint32_t node = state->drag_node;
+    if (ok && node < state->node_count) {
+        ok = gui_graph_visit(state, area, node, &found);
+        for (uint32_t k = state->link_start[node]; k < state->link_start[node + 1U] && ok; k++) {
+            ok = gui_graph_visit(state, area, state->node_count + state->node_links[k], &found);
+        }
+    }
+    qsort(state->visible, found, sizeof(uint32_t), gui_graph_compare_index);
+    return found;
+}
 
-    if (hovered) {
-        ctx->hot_item = id;
-        if (ctx->active_item == 0 && ctx->input.mouse_clicked[GUI_MOUSE_BUTTON_LEFT]) {
-            ctx->active_item = id;
+// Topmost node containing a canvas point, UINT32_MAX for none
+static uint32_t gui_graph_node_at(const gui_graph_state_t *state, const gui_graph_desc_t *desc,
+                                  float x, float y) {
+    uint32_t begin;
+    uint32_t end;
+    uint32_t hit = UINT32_MAX;
+    if (!gui_grid_cell_at(&state->grid, x, y, &begin, &end)) {
+        return hit;
+    }
+    for (uint32_t e = begin; e < end; e++) {
+        uint32_t i = state->grid.entries[e];
+        if (i < desc->node_count && (hit == UINT32_MAX || i > hit) &&
+            gui_rect_contains(desc->nodes[i].rect, x, y)) {
+            hit = i;
         }
     }
+    return hit;
+}
 
-    if (ctx->active_item == id) {
-        if (ctx->input.mouse_down[GUI_MOUSE_BUTTON_LEFT]) {
-            // Update value based on mouse position
-            float mouse_norm = (ctx->input.mouse_pos.x - x) / w;
-            if (mouse_norm < 0.0F) {
-                mouse_norm = 0.0F;
-            }
-            if (mouse_norm > 1.0F) {
-                mouse_norm = 1.0F;
-            }
+bool gui_node_graph(gui_context_t *ctx, const char *id, const gui_graph_desc_t *desc,
+                    uint32_t *selected, float width, float height) {
+    GUI_TRACE_BEGIN("gui_node_graph");
+    ctx->stats.widget_count++;
+    gui_rect_t rect = gui_layout_next_rect(ctx, width, height, 400.0F, 300.0F);
+    gui_id_t graph_id = gui_get_id(ctx, id);
+    const gui_style_t *style = &ctx->style;
+    const gui_input_t *input = &ctx->input;
+    gui_graph_state_t *state = (gui_graph_state_t *)gui_get_state_ex(
+        ctx, graph_id, sizeof(gui_graph_state_t), gui_graph_state_destroy);
+    if (!state) {
+        GUI_TRACE_END();
+        return false;
+    }
+    if (state->zoom == 0.0F) {
+        state->zoom = 1.0F;
+        state->drag_node = UINT32_MAX;
+        state->dirty = true;
+    }
+    if (state->version != desc->version || state->node_count != desc->node_count ||
+        state->link_count != desc->link_count) {
+        state->drag_node = UINT32_MAX; // The dragged node may be gone
+        state->dirty = true;
+    }
+    // Moves during a drag leave the grid stale until the node is dropped (see gui_graph_query)
+    if (state->dirty && state->drag_node == UINT32_MAX) {
+        gui_graph_build(state, desc);
+    }
 
-            float new_value = min + (mouse_norm * (max - min));
-            if (new_value != *value) {
-                *value = new_value;
+    // Clicks pick the topmost node under the mouse or start panning
+    bool changed = false;
+    bool hovered;
+    bool held;
+    gui_button_behavior(ctx, graph_id, rect, &hovered, &held);
+    float zoom = state->zoom;
+    gui_vec2_t mouse = {state->offset_x + ((input->mouse_pos.x - rect.x) / zoom),
+                        state->offset_y + ((input->mouse_pos.y - rect.y) / zoom)};
+    if (hovered && input->mouse_clicked[GUI_MOUSE_BUTTON_LEFT]) {
+        uint32_t hit = gui_graph_node_at(state, desc, mouse.x, mouse.y);
+        state->drag_node = hit;
+        if (hit != UINT32_MAX) {
+            state->drag_offset = (gui_vec2_t){mouse.x - desc->nodes[hit].rect.x,
+                                              mouse.y - desc->nodes[hit].rect.y};
+        }
+        if (selected && *selected != hit) {
+            *selected = hit;
+            changed = true;
+        }
+    } else if (held && input->mouse_down[GUI_MOUSE_BUTTON_LEFT]) {
+        if (state->drag_node < state->node_count) {
+            const gui_rect_t *node = &desc->nodes[state->drag_node].rect;
+            float x = mouse.x - state->drag_offset.x;
+            float y = mouse.y - state->drag_offset.y;
+            if (node->x != x || node->y != y) {
+                gui_graph_move_node(state, desc, state->drag_node, x, y);
                 changed = true;
             }
         } else {
-            ctx->active_item = 0;
+            state->offset_x -= (input->mouse_pos.x - state->last_mouse.x) / zoom;
+            state->offset_y -= (input->mouse_pos.y - state->last_mouse.y) / zoom;
         }
     }
+    state->last_mouse = input->mouse_pos;
+    if (!held || !input->mouse_down[GUI_MOUSE_BUTTON_LEFT]) {
+        state->drag_node = UINT32_MAX;
+    }
+    if (state->dirty && state->drag_node == UINT32_MAX) {
+        gui_graph_build(state, desc); // Rebins a node dropped this frame before it is drawn
+    }
 
-    // Draw slider track
-    gui_add_rect_filled(ctx, x, y, w, h, ctx->style.slider_bg);
+    // Zoom around the canvas point under the mouse
+    if (hovered && input->mouse_wheel != 0.0F) {
+        float new_zoom = gui_clampf(zoom * powf(1.15F, input->mouse_wheel), 0.02F, 4.0F);
+        state->offset_x = mouse.x - ((input->mouse_pos.x - rect.x) / new_zoom);
+        state->offset_y = mouse.y - ((input->mouse_pos.y - rect.y) / new_zoom);
+        state->zoom = new_zoom;
+        zoom = new_zoom;
+    }
 
-    // Draw slider grab
-    gui_color_t grab_color =
-        (ctx->active_item == id) ? ctx->style.slider_grab_active : ctx->style.slider_grab;
-    gui_add_circle_filled(ctx, grab_x + (grab_w * 0.5F), grab_y + (grab_w * 0.5F), grab_w * 0.5F,
-                          grab_color);
+    gui_push_clip_rect(ctx, rect.x, rect.y, rect.w, rect.h, true);
+    gui_add_rect_filled(ctx, rect.x, rect.y, rect.w, rect.h, style->plot_bg);
+
+    gui_rect_t area = {state->offset_x, state->offset_y, rect.w / zoom, rect.h / zoom};
+    uint32_t found = gui_graph_query(state, area);
+    float ox = rect.x - (state->offset_x * zoom);
+    float oy = rect.y - (state->offset_y * zoom);
+    bool detailed = zoom >= CGUI_GRAPH_LOD_ZOOM;
+
+    // Links first, under the nodes. Items are sorted, so the visible nodes come first.
+    gui_vec2_t points[65];
+    for (uint32_t v = 0; v < found; v++) {
+        uint32_t i = state->visible[v];
+        gui_vec2_t p[4];
+        if (i < desc->node_count ||
+            !gui_graph_link_curve(desc, &desc->links[i - desc->node_count], p)) {
+            continue;
+        }
+        for (int k = 0; k < 4; k++) {
+            p[k] = (gui_vec2_t){ox + (p[k].x * zoom), oy + (p[k].y * zoom)};
+        }
+        if (!detailed) {
+            gui_add_line(ctx, p[0].x, p[0].y, p[3].x, p[3].y, style->plot_line, 1.0F);
+            continue;
+        }
+        // The control polygon bounds the curve's length
+        float length = hypotf(p[1].x - p[0].x, p[1].y - p[0].y) +
+                       hypotf(p[2].x - p[1].x, p[2].y - p[1].y) +
+                       hypotf(p[3].x - p[2].x, p[3].y - p[2].y);
+        int segments = (int)gui_clampf(ceilf(length / CGUI_GRAPH_LINK_SEGMENT), 1.0F, 64.0F);
+        for (int k = 0; k <= segments; k++) {
+            float t = (float)k / (float)segments;
+            float u = 1.0F - t;
+            float w0 = u * u * u;
+            float w1 = 3.0F * u * u * t;
+            float w2 = 3.0F * u * t * t;
+            float w3 = t * t * t;
+            points[k] = (gui_vec2_t){(w0 * p[0].x) + (w1 * p[1].x) + (w2 * p[2].x) + (w3 * p[3].x),
+                                     (w0 * p[0].y) + (w1 * p[1].y) + (w2 * p[2].y) + (w3 * p[3].y)};
+        }
+        gui_add_polyline(ctx, points, segments + 1, style->plot_line, 1.5F);
+    }
+
+    float title_h = (style->text_size + (style->table_cell_padding * 2.0F)) * zoom;
+    float text_size = style->text_size * zoom;
+    for (uint32_t v = 0; v < found && state->visible[v] < desc->node_count; v++) {
+        const gui_graph_node_t *node = &desc->nodes[state->visible[v]];
+        bool is_selected = selected && *selected == state->visible[v];
+        float x = ox + (node->rect.x * zoom);
+        float y = oy + (node->rect.y * zoom);
+        float w = node->rect.w * zoom;
+        float h = node->rect.h * zoom;
+        if (!detailed) {
+            gui_add_rect_filled(ctx, x, y, w, h,
+                                is_selected ? style->slider_grab_active : style->table_header_bg);
+            continue;
+        }
+        gui_add_rect_filled(ctx, x, y, w, h, style->button_bg);
+        gui_add_rect_filled(ctx, x, y, w, fminf(title_h, h), style->table_header_bg);
+        if (node->title) {
+            float pad = style->table_cell_padding * zoom;
+            size_t max_chars = (size_t)fmaxf(0.0F, (w - (pad * 2.0F)) / (text_size * 0.6F));
+            gui_add_text_n(ctx, node->title, max_chars, x + pad, y + pad, style->button_text,
+                           text_size);
+        }
+        gui_add_rect(ctx, x, y, w, h,
+                     is_selected ? style->slider_grab_active : style->table_border, 1.0F);
+    }
 
+    gui_add_rect(ctx, rect.x, rect.y, rect.w, rect.h, style->table_border, 1.0F);
+    gui_pop_clip_rect(ctx);
+    GUI_TRACE_END();
     return changed;
 }
 
+// =============================================================================
+// STATISTICS OVERLAY
+// =============================================================================
+
+void gui_stats_overlay(gui_context_t *ctx, float width) {
+    GUI_TRACE_BEGIN("gui_stats_overlay");
+    const gui_frame_stats_t *stats = gui_get_frame_stats(ctx);
+    float padding = 6.0F;
+    float line_h = ctx->style.text_size + 4.0F;
+    float plot_h = 40.0F;
+    const int line_count = 7;
+    float height = (padding * 3.0F) + (line_h * (float)line_count) + (plot_h * 2.0F) + 4.0F;
+    gui_rect_t rect = gui_layout_next_rect(ctx, width, height, 300.0F, height);
+    ctx->stats.widget_count++;
+
+    gui_add_rect_filled(ctx, rect.x, rect.y, rect.w, rect.h, ctx->style.table_bg);
+    gui_add_rect(ctx, rect.x, rect.y, rect.w, rect.h, ctx->style.table_border, 1.0F);
+
+    char lines[7][96];
+    snprintf(lines[0], sizeof(lines[0]), "CPU %.2f ms (begin %.2f, widgets %.2f, end %.2f)",
+             (double)stats->cpu_ms, (double)stats->begin_ms, (double)stats->widgets_ms,
+             (double)stats->end_ms);
+    snprintf(lines[1], sizeof(lines[1]), "%u vertices, %u indices, %u commands",
+             stats->vertex_count, stats->index_count, stats->draw_command_count);
+    snprintf(lines[2], sizeof(lines[2]), "Switches: %u clip, %u texture (%u merged)",
+             stats->clip_switches, stats->texture_switches, stats->merged_commands);
+    snprintf(lines[3], sizeof(lines[3]),
+             "%u widgets, %u hit rects, %u culled, %u cached, %u layers", stats->widget_count,
+             stats->hit_item_count, stats->culled_primitives, stats->cached_blocks,
+             stats->cached_layers);
+    snprintf(lines[4], sizeof(lines[4]), "Arena %zu KB (peak %zu KB)", stats->arena_used / 1024U,
+             stats->arena_high_water / 1024U);
+    snprintf(lines[5], sizeof(lines[5]), "Peak %u vertices, %u indices", stats->vertex_high_water,
+             stats->index_high_water);
+    snprintf(lines[6], sizeof(lines[6]), "Upload %.1f KB in %.2f ms",
+             (double)stats->upload_bytes / 1024.0, (double)stats->upload_ms);
+
+    float x = rect.x + padding;
+    float y = rect.y + padding;
+    for (int i = 0; i < line_count; i++) {
+        gui_add_text(ctx, lines[i], x, y, ctx->style.text, ctx->style.text_size);
+        y += line_h;
+    }
+
+    // Both graphs read the history ring in place
+    uint64_t total = ctx->stats_frame_count;
+    size_t stride = sizeof(gui_frame_stats_t);
+    gui_push_id(ctx, "gui_stats_overlay");
+    gui_begin_vbox(ctx, rect.x, y, rect.w, padding, 4.0F);
+    gui_plot_lines_ring(ctx, "CPU ms", &ctx->stats_history[0].cpu_ms, CGUI_STATS_HISTORY, stride,
+                        total, 0.0F, 0.0F, 0.0F, plot_h);
+    gui_plot_lines_ring(ctx, "Upload ms", &ctx->stats_history[0].upload_ms, CGUI_STATS_HISTORY,
+                        stride, total, 0.0F, 0.0F, 0.0F, plot_h);
+    gui_end_vbox(ctx);
+    gui_pop_id(ctx);
+    GUI_TRACE_END();
+}
+
 #endif // CGUI_IMPLEMENTATION
 
 #ifdef __cplusplus
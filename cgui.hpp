@@ -0,0 +1,292 @@
+/*
+ * CGUI - C++ Wrapper
+ * Header-only C++17 layer over cgui.h. It adds no state: everything forwards to the C API.
+ *   - Literal labels are hashed at compile time, matching gui_hash_string, so widgets neither
+ *     hash nor measure them each frame.
+ *   - Scope guards close layouts, clip rects, ID scopes, transforms and cached blocks on every
+ *     path out of a scope.
+ *   - Text is taken as std::string_view (no strlen, no terminating NUL needed).
+ *   - Bulk draw calls take any contiguous range (std::span, std::vector, std::array, arrays).
+ *
+ * Usage (the implementation still comes from one file defining CGUI_IMPLEMENTATION):
+ *   #include "cgui.hpp"
+ *
+ *   cgui::ui ui(&ctx);
+ *   {
+ *       cgui::vbox box(ui, 20, 20, 200, 10, 5);
+ *       if (ui.button("Save")) { ... }       // ID hashed at compile time
+ *       ui.label(status);                    // std::string_view
+ *   }                                        // gui_end_vbox
+ *   if (cgui::cached block{ui, "panel", version, 0, 0}) {
+ *       ...                                  // Runs only when not replayed
+ *   }                                        // gui_end_cached when it ran
+ */
+
+#ifndef CGUI_HPP
+#define CGUI_HPP
+
+#include "cgui.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <string>
+#include <string_view>
+
+// Literal labels must be hashed during compilation from C++20 on; before, constexpr leaves it to
+// the optimizer
+#if defined(__cpp_consteval) && __cpp_consteval >= 201811L
+#define CGUI_CONSTEVAL consteval
+#else
+#define CGUI_CONSTEVAL constexpr
+#endif
+
+namespace cgui {
+
+// =============================================================================
+// IDS
+// =============================================================================
+
+// gui_hash_string (32-bit FNV-1a) of a string without embedded NULs
+constexpr gui_id_t hash(std::string_view str) noexcept {
+    gui_id_t value = 2166136261U;
+    for (char c : str) {
+        value ^= static_cast<uint8_t>(c);
+        value *= 16777619U;
+    }
+    return value;
+}
+
+static_assert(hash("") == 2166136261U && hash("a") == 0xE40C292CU, "FNV-1a mismatch");
+
+// Label and its hash. String literals convert implicitly and are hashed at compile time; other
+// strings (or char buffers filled at run time) go through label::runtime.
+class label {
+  public:
+    // Measured up to the first NUL, not N - 1: under C++17 a char buffer filled at run time binds
+    // here as well
+    template <std::size_t N>
+    CGUI_CONSTEVAL label(const char (&text)[N]) noexcept // NOLINT(google-explicit-constructor)
+        : text_(text, std::char_traits<char>::length(text)), hash_(cgui::hash(text_)) {}
+
+    static constexpr label runtime(std::string_view text) noexcept {
+        return label(text, cgui::hash(text));
+    }
+
+    constexpr std::string_view text() const noexcept { return text_; }
+    constexpr gui_id_t hash() const noexcept { return hash_; }
+
+  private:
+    constexpr label(std::string_view text, gui_id_t hash) noexcept : text_(text), hash_(hash) {}
+
+    std::string_view text_;
+    gui_id_t hash_;
+};
+
+// =============================================================================
+// SCOPE GUARDS
+// =============================================================================
+
+// Each guard opens its scope in the constructor and closes it in the destructor. Guards are
+// neither copyable nor movable; declare them as named locals (a temporary closes at once).
+
+class vbox {
+  public:
+    vbox(gui_context_t *ctx, float x, float y, float width, float padding, float spacing) noexcept
+        : ctx_(ctx) {
+        gui_begin_vbox(ctx, x, y, width, padding, spacing);
+    }
+    ~vbox() { gui_end_vbox(ctx_); }
+    vbox(const vbox &) = delete;
+    vbox &operator=(const vbox &) = delete;
+
+  private:
+    gui_context_t *ctx_;
+};
+
+class hbox {
+  public:
+    hbox(gui_context_t *ctx, float x, float y, float height, float padding, float spacing) noexcept
+        : ctx_(ctx) {
+        gui_begin_hbox(ctx, x, y, height, padding, spacing);
+    }
+    ~hbox() { gui_end_hbox(ctx_); }
+    hbox(const hbox &) = delete;
+    hbox &operator=(const hbox &) = delete;
+
+  private:
+    gui_context_t *ctx_;
+};
+
+class flex {
+  public:
+    flex(gui_context_t *ctx, const char *id, gui_flex_direction_t direction, float x, float y,
+         float width, float height, float padding, float spacing) noexcept
+        : ctx_(ctx) {
+        gui_begin_flex(ctx, id, direction, x, y, width, height, padding, spacing);
+    }
+    ~flex() { gui_end_flex(ctx_); }
+    flex(const flex &) = delete;
+    flex &operator=(const flex &) = delete;
+
+  private:
+    gui_context_t *ctx_;
+};
+
+class clip_rect {
+  public:
+    clip_rect(gui_context_t *ctx, float x, float y, float w, float h,
+              bool intersect_with_current = true) noexcept
+        : ctx_(ctx) {
+        gui_push_clip_rect(ctx, x, y, w, h, intersect_with_current);
+    }
+    ~clip_rect() { gui_pop_clip_rect(ctx_); }
+    clip_rect(const clip_rect &) = delete;
+    clip_rect &operator=(const clip_rect &) = delete;
+
+  private:
+    gui_context_t *ctx_;
+};
+
+class id_scope {
+  public:
+    id_scope(gui_context_t *ctx, label id) noexcept : ctx_(ctx) {
+        gui_push_id_hash(ctx, id.hash());
+    }
+    id_scope(gui_context_t *ctx, int id) noexcept : ctx_(ctx) { gui_push_id_int(ctx, id); }
+    ~id_scope() { gui_pop_id(ctx_); }
+    id_scope(const id_scope &) = delete;
+    id_scope &operator=(const id_scope &) = delete;
+
+  private:
+    gui_context_t *ctx_;
+};
+
+class transform {
+  public:
+    transform(gui_context_t *ctx, gui_transform_t t) noexcept : ctx_(ctx) {
+        gui_push_transform(ctx, t);
+    }
+    ~transform() { gui_pop_transform(ctx_); }
+    transform(const transform &) = delete;
+    transform &operator=(const transform &) = delete;
+
+  private:
+    gui_context_t *ctx_;
+};
+
+// True when the body must run; the block is closed only then
+class cached {
+  public:
+    cached(gui_context_t *ctx, const char *id, uint32_t version, float x, float y) noexcept
+        : ctx_(ctx), open_(gui_begin_cached(ctx, id, version, x, y)) {}
+    ~cached() {
+        if (open_) {
+            gui_end_cached(ctx_);
+        }
+    }
+    cached(const cached &) = delete;
+    cached &operator=(const cached &) = delete;
+    explicit operator bool() const noexcept { return open_; }
+
+  private:
+    gui_context_t *ctx_;
+    bool open_;
+};
+
+class cached_layer {
+  public:
+    cached_layer(gui_context_t *ctx, const char *id, uint32_t version, float x, float y,
+                 float width, float height) noexcept
+        : ctx_(ctx), open_(gui_begin_cached_layer(ctx, id, version, x, y, width, height)) {}
+    ~cached_layer() {
+        if (open_) {
+            gui_end_cached_layer(ctx_);
+        }
+    }
+    cached_layer(const cached_layer &) = delete;
+    cached_layer &operator=(const cached_layer &) = delete;
+    explicit operator bool() const noexcept { return open_; }
+
+  private:
+    gui_context_t *ctx_;
+    bool open_;
+};
+
+// =============================================================================
+// WIDGETS & DRAWING
+// =============================================================================
+
+// Non-owning handle to a context; converts to gui_context_t * for the guards and the C API
+class ui {
+  public:
+    explicit ui(gui_context_t *ctx) noexcept : ctx_(ctx) {}
+    // NOLINTNEXTLINE(google-explicit-constructor)
+    operator gui_context_t *() const noexcept { return ctx_; }
+    gui_context_t *get() const noexcept { return ctx_; }
+
+    gui_id_t id(cgui::label id) const noexcept { return gui_get_id_hash(ctx_, id.hash()); }
+
+    // Widgets
+    void label(std::string_view str) const noexcept {
+        gui_label_n(ctx_, str.data(), str.size());
+    }
+    bool button(cgui::label label, float width = 0, float height = 0) const noexcept {
+        return gui_button_ex(ctx_, label.hash(), label.text().data(), label.text().size(),
+                             width, height);
+    }
+    bool slider(cgui::label label, float &value, float min, float max,
+                float width = 0) const noexcept {
+        return gui_slider_float_ex(ctx_, label.hash(), &value, min, max, width);
+    }
+    void image(gui_texture_id_t texture, float width, float height, gui_vec2_t uv0 = {0, 0},
+               gui_vec2_t uv1 = {1, 1}, gui_color_t tint = {255, 255, 255, 255}) const noexcept {
+        gui_image(ctx_, texture, width, height, uv0, uv1, tint);
+    }
+
+    // Primitives
+    void rect(gui_rect_t r, gui_color_t color, float thickness = 1) const noexcept {
+        gui_add_rect(ctx_, r.x, r.y, r.w, r.h, color, thickness);
+    }
+    void rect_filled(gui_rect_t r, gui_color_t color) const noexcept {
+        gui_add_rect_filled(ctx_, r.x, r.y, r.w, r.h, color);
+    }
+    void line(gui_vec2_t a, gui_vec2_t b, gui_color_t color, float thickness = 1) const noexcept {
+        gui_add_line(ctx_, a.x, a.y, b.x, b.y, color, thickness);
+    }
+    void circle_filled(gui_vec2_t center, float radius, gui_color_t color) const noexcept {
+        gui_add_circle_filled(ctx_, center.x, center.y, radius, color);
+    }
+    void text(std::string_view str, gui_vec2_t pos, gui_color_t color,
+              float font_size) const noexcept {
+        gui_add_text_n(ctx_, str.data(), str.size(), pos.x, pos.y, color, font_size);
+    }
+
+    // Bulk drawing over contiguous ranges of gui_vec2_t / gui_rect_t
+    template <class Points>
+    void polyline(const Points &points, gui_color_t color, float thickness = 1) const noexcept {
+        gui_add_polyline(ctx_, std::data(points), static_cast<int>(std::size(points)), color,
+                         thickness);
+    }
+    template <class Rects>
+    void rects_filled(const Rects &items, gui_color_t color) const noexcept {
+        const gui_rect_t *r = std::data(items);
+        for (std::size_t i = 0, n = std::size(items); i < n; i++) {
+            gui_add_rect_filled(ctx_, r[i].x, r[i].y, r[i].w, r[i].h, color);
+        }
+    }
+    template <class Rects>
+    void rects(const Rects &items, gui_color_t color, float thickness = 1) const noexcept {
+        const gui_rect_t *r = std::data(items);
+        for (std::size_t i = 0, n = std::size(items); i < n; i++) {
+            gui_add_rect(ctx_, r[i].x, r[i].y, r[i].w, r[i].h, color, thickness);
+        }
+    }
+
+  private:
+    gui_context_t *ctx_;
+};
+
+} // namespace cgui
+
+#endif // CGUI_HPP
@@ -16,28 +16,205 @@
 extern "C" {
 #endif
 
-// Backend state
+#ifndef CGUI_GL_STREAM_BUFFERS
+#define CGUI_GL_STREAM_BUFFERS 3 // Pixel-unpack buffers cycled by streaming uploads
+#endif
+
+#ifndef CGUI_GL_LAYER_BUDGET
+#define CGUI_GL_LAYER_BUDGET (64U * 1024U * 1024U) // Default bytes of cached layer textures
+#endif
+
+// OpenGL 1.5/2.0 entry points (GL 1.1 is called directly)
+typedef void (*gui_gl_gen_buffers_fn)(int n, unsigned int *buffers);
+typedef void (*gui_gl_delete_buffers_fn)(int n, const unsigned int *buffers);
+typedef void (*gui_gl_bind_buffer_fn)(unsigned int target, unsigned int buffer);
+typedef void (*gui_gl_buffer_data_fn)(unsigned int target, ptrdiff_t size, const void *data,
+                                      unsigned int usage);
+typedef unsigned int (*gui_gl_create_shader_fn)(unsigned int type);
+typedef void (*gui_gl_shader_source_fn)(unsigned int shader, int count, const char **string,
+                                        const int *length);
+typedef void (*gui_gl_compile_shader_fn)(unsigned int shader);
+typedef void (*gui_gl_get_shaderiv_fn)(unsigned int shader, unsigned int pname, int *params);
+typedef void (*gui_gl_get_shader_info_log_fn)(unsigned int shader, int bufSize, int *length,
+                                              char *infoLog);
+typedef unsigned int (*gui_gl_create_program_fn)(void);
+typedef void (*gui_gl_attach_shader_fn)(unsigned int program, unsigned int shader);
+typedef void (*gui_gl_link_program_fn)(unsigned int program);
+typedef void (*gui_gl_get_programiv_fn)(unsigned int program, unsigned int pname, int *params);
+typedef void (*gui_gl_get_program_info_log_fn)(unsigned int program, int bufSize, int *length,
+                                               char *infoLog);
+typedef void (*gui_gl_use_program_fn)(unsigned int program);
+typedef void (*gui_gl_delete_shader_fn)(unsigned int shader);
+typedef void (*gui_gl_delete_program_fn)(unsigned int program);
+typedef int (*gui_gl_get_attrib_location_fn)(unsigned int program, const char *name);
+typedef int (*gui_gl_get_uniform_location_fn)(unsigned int program, const char *name);
+typedef void (*gui_gl_vertex_attrib_pointer_fn)(unsigned int index, int size, unsigned int type,
+                                                unsigned char normalized, int stride,
+                                                const void *pointer);
+typedef void (*gui_gl_enable_vertex_attrib_array_fn)(unsigned int index);
+typedef void (*gui_gl_disable_vertex_attrib_array_fn)(unsigned int index);
+typedef void (*gui_gl_uniform_matrix4fv_fn)(int location, int count, unsigned char transpose,
+                                            const float *value);
+typedef void (*gui_gl_uniform1i_fn)(int location, int v0);
+typedef void *(*gui_gl_map_buffer_fn)(unsigned int target, unsigned int access);
+typedef unsigned char (*gui_gl_unmap_buffer_fn)(unsigned int target);
+typedef void (*gui_gl_blend_func_separate_fn)(unsigned int src_rgb, unsigned int dst_rgb,
+                                              unsigned int src_alpha, unsigned int dst_alpha);
+
+// Framebuffer objects (GL 3.0 or ARB_framebuffer_object), used by cached layers when present
+typedef void (*gui_gl_gen_framebuffers_fn)(int n, unsigned int *framebuffers);
+typedef void (*gui_gl_delete_framebuffers_fn)(int n, const unsigned int *framebuffers);
+typedef void (*gui_gl_bind_framebuffer_fn)(unsigned int target, unsigned int framebuffer);
+typedef void (*gui_gl_framebuffer_texture_2d_fn)(unsigned int target, unsigned int attachment,
+                                                 unsigned int textarget, unsigned int texture,
+                                                 int level);
+typedef unsigned int (*gui_gl_check_framebuffer_status_fn)(unsigned int target);
+
+// Returns the address of a GL function for the current context (e.g. glfwGetProcAddress)
+typedef void (*gui_gl_proc_t)(void);
+typedef gui_gl_proc_t (*gui_gl_loader_t)(const char *name);
+
+// Function table of one backend
+typedef struct {
+    gui_gl_gen_buffers_fn gen_buffers;
+    gui_gl_delete_buffers_fn delete_buffers;
+    gui_gl_bind_buffer_fn bind_buffer;
+    gui_gl_buffer_data_fn buffer_data;
+    gui_gl_create_shader_fn create_shader;
+    gui_gl_shader_source_fn shader_source;
+    gui_gl_compile_shader_fn compile_shader;
+    gui_gl_get_shaderiv_fn get_shaderiv;
+    gui_gl_get_shader_info_log_fn get_shader_info_log;
+    gui_gl_create_program_fn create_program;
+    gui_gl_attach_shader_fn attach_shader;
+    gui_gl_link_program_fn link_program;
+    gui_gl_get_programiv_fn get_programiv;
+    gui_gl_get_program_info_log_fn get_program_info_log;
+    gui_gl_use_program_fn use_program;
+    gui_gl_delete_shader_fn delete_shader;
+    gui_gl_delete_program_fn delete_program;
+    gui_gl_get_attrib_location_fn get_attrib_location;
+    gui_gl_get_uniform_location_fn get_uniform_location;
+    gui_gl_vertex_attrib_pointer_fn vertex_attrib_pointer;
+    gui_gl_enable_vertex_attrib_array_fn enable_vertex_attrib_array;
+    gui_gl_disable_vertex_attrib_array_fn disable_vertex_attrib_array;
+    gui_gl_uniform_matrix4fv_fn uniform_matrix4fv;
+    gui_gl_uniform1i_fn uniform1i;
+    gui_gl_map_buffer_fn map_buffer;
+    gui_gl_unmap_buffer_fn unmap_buffer;
+    gui_gl_blend_func_separate_fn blend_func_separate;
+    gui_gl_gen_framebuffers_fn gen_framebuffers;
+    gui_gl_delete_framebuffers_fn delete_framebuffers;
+    gui_gl_bind_framebuffer_fn bind_framebuffer;
+    gui_gl_framebuffer_texture_2d_fn framebuffer_texture_2d;
+    gui_gl_check_framebuffer_status_fn check_framebuffer_status;
+} gui_backend_gl_functions_t;
+
+// Objects of a share group (contexts created sharing objects, e.g. through glfwCreateWindow's
+// share argument): the shader program and the white texture are created by the first backend
+// and deleted by the last. Textures from gui_backend_gl_create_texture are shared the same way
+// and usable by every backend of the group.
 typedef struct {
-    unsigned int vbo;
-    unsigned int ebo;
     unsigned int shader_program;
     int attrib_pos;
     int attrib_uv;
     int attrib_color;
+#ifdef CGUI_ENABLE_OPAQUE_PASS
+    int attrib_depth;
+#endif
     int uniform_projection;
+    int uniform_transform;
+    int uniform_texture;
+    unsigned int white_texture; // Bound for untextured commands
+    uint32_t ref_count;         // Backends using the objects
+} gui_backend_gl_shared_t;
+
+// Texture a cached layer (see gui_begin_cached_layer) was rendered into
+typedef struct {
+    gui_id_t id;
+    unsigned int texture;
+    unsigned int framebuffer;
+    int width, height;
+    uint64_t rendered;  // Render that last drew the layer's content
+    uint64_t last_used; // Render that last drew or composited it
+} gui_backend_gl_layer_t;
+
+// Backend state, one per GL context. Backends share no mutable state apart from the shared
+// objects, so each can render from its own thread.
+typedef struct {
+    gui_backend_gl_functions_t gl;
+    gui_backend_gl_shared_t *shared; // own_shared unless a share group was given
+    gui_backend_gl_shared_t own_shared;
+    unsigned int vbo;
+    unsigned int ebo;
+#ifdef CGUI_ENABLE_OPAQUE_PASS
+    unsigned int opaque_ebo;
+    bool opaque_pass; // Draw the opaque pass first with depth writes (default on; clears depth;
+                      // needs gui_context_t.opaque_pass to have built one)
+#endif
     float display_width;
     float display_height;
+
+    // Streaming uploads
+    unsigned int stream_buffers[CGUI_GL_STREAM_BUFFERS];
+    int stream_index;
+    gui_texture_id_t stream_texture; // Target of the mapped upload, NULL if none
+    int stream_rect[4];              // x, y, width, height
+
+    // Texture uploads since the last render, reported to the context with the draw data
+    uint64_t upload_bytes;
+    double upload_ms;
+
+    // Cached layer textures. Once they take more than layer_budget bytes (default
+    // CGUI_GL_LAYER_BUDGET), layers not used by the current render are evicted least recently
+    // used first and invalidated in the context, which renders them again on their next use.
+    gui_backend_gl_layer_t *layers;
+    uint32_t layer_count;
+    uint32_t layer_capacity;
+    size_t layer_bytes;
+    size_t layer_budget;
+    uint64_t render_count;
 } gui_backend_gl_t;
 
-// Initialize OpenGL backend
+// Initialize OpenGL backend (functions loaded through glfwGetProcAddress, no share group)
 void gui_backend_gl_init(gui_backend_gl_t *backend);
 
-// Shutdown OpenGL backend
+// Initialize with the backend's context current. loader may be NULL for glfwGetProcAddress;
+// shared may be NULL, or a zeroed gui_backend_gl_shared_t common to the backends of a share
+// group. Backends of one group are initialized and shut down from one thread at a time.
+// Returns false when the shader program cannot be built.
+bool gui_backend_gl_init_ex(gui_backend_gl_t *backend, gui_gl_loader_t loader,
+                            gui_backend_gl_shared_t *shared);
+
+// Shutdown OpenGL backend (the last backend of a share group deletes the shared objects)
 void gui_backend_gl_shutdown(gui_backend_gl_t *backend);
 
-// Render the GUI
+// Render the GUI. Uploads (draw data and textures since the last call) are reported through
+// gui_report_upload. Cached layers are rendered into textures first; without framebuffer
+// objects their content is drawn directly and they are invalidated every frame.
 void gui_backend_gl_render(gui_backend_gl_t *backend, gui_context_t *ctx);
 
+// Textures (RGBA8, rows tightly packed). pixels may be NULL to leave the contents undefined.
+gui_texture_id_t gui_backend_gl_create_texture(gui_backend_gl_t *backend, int width, int height,
+                                               const void *pixels);
+void gui_backend_gl_update_texture(gui_backend_gl_t *backend, gui_texture_id_t texture, int x,
+                                   int y, int width, int height, const void *pixels);
+void gui_backend_gl_destroy_texture(gui_backend_gl_t *backend, gui_texture_id_t texture);
+
+// Creates the textures of new atlas pages and uploads the rows changed in the others. Call
+// after adding images and before drawing them; gui_backend_gl_destroy_atlas deletes the textures.
+void gui_backend_gl_upload_atlas(gui_backend_gl_t *backend, gui_atlas_t *atlas);
+void gui_backend_gl_destroy_atlas(gui_backend_gl_t *backend, gui_atlas_t *atlas);
+
+// Streaming upload: returns write-only staging memory for width * height RGBA8 pixels, mapped
+// from the next pixel-unpack buffer in the ring. gui_backend_gl_stream_end unmaps it and queues
+// the copy into the texture; the driver performs the transfer asynchronously, so producers such
+// as camera feeds can write the next frame without waiting on the GPU. Returns NULL when pixel
+// buffers are unavailable; gui_backend_gl_update_texture then uploads directly.
+void *gui_backend_gl_stream_begin(gui_backend_gl_t *backend, gui_texture_id_t texture, int x,
+                                  int y, int width, int height);
+void gui_backend_gl_stream_end(gui_backend_gl_t *backend);
+
 #ifdef __cplusplus
 }
 #endif
@@ -50,7 +227,18 @@ void gui_backend_gl_render(gui_backend_gl_t *backend, gui_context_t *ctx);
 
 #ifdef CGUI_BACKEND_GL_IMPLEMENTATION
 
+#include <math.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Heap hooks, as in cgui.h
+#ifndef CGUI_MALLOC
+#define CGUI_MALLOC(size) malloc(size)
+#define CGUI_CALLOC(count, size) calloc(count, size)
+#define CGUI_REALLOC(ptr, size) realloc(ptr, size)
+#define CGUI_FREE(ptr) free(ptr)
+#endif
 
 // OpenGL headers (cross-platform)
 // Note: We rely on GLFW to load OpenGL, so we include GLFW first
@@ -79,130 +267,110 @@ void gui_backend_gl_render(gui_backend_gl_t *backend, gui_context_t *ctx);
 #define GL_INFO_LOG_LENGTH 0x8B84
 #endif
 
-// Function pointers for OpenGL extensions
-typedef void (*PFNGLGENBUFFERSPROC)(int n, unsigned int *buffers);
-typedef void (*PFNGLDELETEBUFFERSPROC)(int n, const unsigned int *buffers);
-typedef void (*PFNGLBINDBUFFERPROC)(unsigned int target, unsigned int buffer);
-typedef void (*PFNGLBUFFERDATAPROC)(unsigned int target, ptrdiff_t size, const void *data,
-                                    unsigned int usage);
-typedef unsigned int (*PFNGLCREATESHADERPROC)(unsigned int type);
-typedef void (*PFNGLSHADERSOURCEPROC)(unsigned int shader, int count, const char **string,
-                                      const int *length);
-typedef void (*PFNGLCOMPILESHADERPROC)(unsigned int shader);
-typedef void (*PFNGLGETSHADERIVPROC)(unsigned int shader, unsigned int pname, int *params);
-typedef void (*PFNGLGETSHADERINFOLOGPROC)(unsigned int shader, int bufSize, int *length,
-                                          char *infoLog);
-typedef unsigned int (*PFNGLCREATEPROGRAMPROC)(void);
-typedef void (*PFNGLATTACHSHADERPROC)(unsigned int program, unsigned int shader);
-typedef void (*PFNGLLINKPROGRAMPROC)(unsigned int program);
-typedef void (*PFNGLGETPROGRAMIVPROC)(unsigned int program, unsigned int pname, int *params);
-typedef void (*PFNGLGETPROGRAMINFOLOGPROC)(unsigned int program, int bufSize, int *length,
-                                           char *infoLog);
-typedef void (*PFNGLUSEPROGRAMPROC)(unsigned int program);
-typedef void (*PFNGLDELETESHADERPROC)(unsigned int shader);
-typedef void (*PFNGLDELETEPROGRAMPROC)(unsigned int program);
-typedef int (*PFNGLGETATTRIBLOCATIONPROC)(unsigned int program, const char *name);
-typedef int (*PFNGLGETUNIFORMLOCATIONPROC)(unsigned int program, const char *name);
-typedef void (*PFNGLVERTEXATTRIBPOINTERPROC)(unsigned int index, int size, unsigned int type,
-                                             unsigned char normalized, int stride,
-                                             const void *pointer);
-typedef void (*PFNGLENABLEVERTEXATTRIBARRAYPROC)(unsigned int index);
-typedef void (*PFNGLDISABLEVERTEXATTRIBARRAYPROC)(unsigned int index);
-typedef void (*PFNGLUNIFORMMATRIX4FVPROC)(int location, int count, unsigned char transpose,
-                                          const float *value);
-
-static PFNGLGENBUFFERSPROC gl_gen_buffers = NULL;
-static PFNGLDELETEBUFFERSPROC gl_delete_buffers = NULL;
-static PFNGLBINDBUFFERPROC gl_bind_buffer = NULL;
-static PFNGLBUFFERDATAPROC gl_buffer_data = NULL;
-static PFNGLCREATESHADERPROC gl_create_shader = NULL;
-static PFNGLSHADERSOURCEPROC gl_shader_source = NULL;
-static PFNGLCOMPILESHADERPROC gl_compile_shader = NULL;
-static PFNGLGETSHADERIVPROC gl_get_shaderiv = NULL;
-static PFNGLGETSHADERINFOLOGPROC gl_get_shader_info_log = NULL;
-static PFNGLCREATEPROGRAMPROC gl_create_program = NULL;
-static PFNGLATTACHSHADERPROC gl_attach_shader = NULL;
-static PFNGLLINKPROGRAMPROC gl_link_program = NULL;
-static PFNGLGETPROGRAMIVPROC gl_get_programiv = NULL;
-static PFNGLGETPROGRAMINFOLOGPROC gl_get_program_info_log = NULL;
-static PFNGLUSEPROGRAMPROC gl_use_program = NULL;
-static PFNGLDELETESHADERPROC gl_delete_shader = NULL;
-static PFNGLDELETEPROGRAMPROC gl_delete_program = NULL;
-static PFNGLGETATTRIBLOCATIONPROC gl_get_attrib_location = NULL;
-static PFNGLGETUNIFORMLOCATIONPROC gl_get_uniform_location = NULL;
-static PFNGLVERTEXATTRIBPOINTERPROC gl_vertex_attrib_pointer = NULL;
-static PFNGLENABLEVERTEXATTRIBARRAYPROC gl_enable_vertex_attrib_array = NULL;
-static PFNGLDISABLEVERTEXATTRIBARRAYPROC gl_disable_vertex_attrib_array = NULL;
-static PFNGLUNIFORMMATRIX4FVPROC gl_uniform_matrix4fv = NULL;
-
-// Use GLFW's cross-platform function pointer loader
-static void *gui_get_proc_address(const char *name) { return (void *)glfwGetProcAddress(name); }
-
-static void gui_load_gl_functions(void) {
-    // Load all OpenGL function pointers using GLFW
-    gl_gen_buffers = (PFNGLGENBUFFERSPROC)gui_get_proc_address("glGenBuffers");
-    gl_delete_buffers = (PFNGLDELETEBUFFERSPROC)gui_get_proc_address("glDeleteBuffers");
-    gl_bind_buffer = (PFNGLBINDBUFFERPROC)gui_get_proc_address("glBindBuffer");
-    gl_buffer_data = (PFNGLBUFFERDATAPROC)gui_get_proc_address("glBufferData");
-    gl_create_shader = (PFNGLCREATESHADERPROC)gui_get_proc_address("glCreateShader");
-    gl_shader_source = (PFNGLSHADERSOURCEPROC)gui_get_proc_address("glShaderSource");
-    gl_compile_shader = (PFNGLCOMPILESHADERPROC)gui_get_proc_address("glCompileShader");
-    gl_get_shaderiv = (PFNGLGETSHADERIVPROC)gui_get_proc_address("glGetShaderiv");
-    gl_get_shader_info_log = (PFNGLGETSHADERINFOLOGPROC)gui_get_proc_address("glGetShaderInfoLog");
-    gl_create_program = (PFNGLCREATEPROGRAMPROC)gui_get_proc_address("glCreateProgram");
-    gl_attach_shader = (PFNGLATTACHSHADERPROC)gui_get_proc_address("glAttachShader");
-    gl_link_program = (PFNGLLINKPROGRAMPROC)gui_get_proc_address("glLinkProgram");
-    gl_get_programiv = (PFNGLGETPROGRAMIVPROC)gui_get_proc_address("glGetProgramiv");
-    gl_get_program_info_log =
-        (PFNGLGETPROGRAMINFOLOGPROC)gui_get_proc_address("glGetProgramInfoLog");
-    gl_use_program = (PFNGLUSEPROGRAMPROC)gui_get_proc_address("glUseProgram");
-    gl_delete_shader = (PFNGLDELETESHADERPROC)gui_get_proc_address("glDeleteShader");
-    gl_delete_program = (PFNGLDELETEPROGRAMPROC)gui_get_proc_address("glDeleteProgram");
-    gl_get_attrib_location =
-        (PFNGLGETATTRIBLOCATIONPROC)gui_get_proc_address("glGetAttribLocation");
-    gl_get_uniform_location =
-        (PFNGLGETUNIFORMLOCATIONPROC)gui_get_proc_address("glGetUniformLocation");
-    gl_vertex_attrib_pointer =
-        (PFNGLVERTEXATTRIBPOINTERPROC)gui_get_proc_address("glVertexAttribPointer");
-    gl_enable_vertex_attrib_array =
-        (PFNGLENABLEVERTEXATTRIBARRAYPROC)gui_get_proc_address("glEnableVertexAttribArray");
-    gl_disable_vertex_attrib_array =
-        (PFNGLDISABLEVERTEXATTRIBARRAYPROC)gui_get_proc_address("glDisableVertexAttribArray");
-    gl_uniform_matrix4fv = (PFNGLUNIFORMMATRIX4FVPROC)gui_get_proc_address("glUniformMatrix4fv");
+#ifndef GL_PIXEL_UNPACK_BUFFER
+#define GL_PIXEL_UNPACK_BUFFER 0x88EC
+#define GL_STREAM_DRAW 0x88E0
+#define GL_WRITE_ONLY 0x88B9
+#endif
+
+#ifndef GL_CLAMP_TO_EDGE
+#define GL_CLAMP_TO_EDGE 0x812F
+#endif
+
+#ifndef GL_FRAMEBUFFER
+#define GL_FRAMEBUFFER 0x8D40
+#define GL_FRAMEBUFFER_BINDING 0x8CA6
+#define GL_FRAMEBUFFER_COMPLETE 0x8CD5
+#define GL_COLOR_ATTACHMENT0 0x8CE0
+#endif
+
+// Entry points belong to the context that was current when they were loaded
+static void gui_backend_gl_load_functions(gui_backend_gl_functions_t *gl,
+                                          gui_gl_loader_t loader) {
+    gl->gen_buffers = (gui_gl_gen_buffers_fn)loader("glGenBuffers");
+    gl->delete_buffers = (gui_gl_delete_buffers_fn)loader("glDeleteBuffers");
+    gl->bind_buffer = (gui_gl_bind_buffer_fn)loader("glBindBuffer");
+    gl->buffer_data = (gui_gl_buffer_data_fn)loader("glBufferData");
+    gl->create_shader = (gui_gl_create_shader_fn)loader("glCreateShader");
+    gl->shader_source = (gui_gl_shader_source_fn)loader("glShaderSource");
+    gl->compile_shader = (gui_gl_compile_shader_fn)loader("glCompileShader");
+    gl->get_shaderiv = (gui_gl_get_shaderiv_fn)loader("glGetShaderiv");
+    gl->get_shader_info_log = (gui_gl_get_shader_info_log_fn)loader("glGetShaderInfoLog");
+    gl->create_program = (gui_gl_create_program_fn)loader("glCreateProgram");
+    gl->attach_shader = (gui_gl_attach_shader_fn)loader("glAttachShader");
+    gl->link_program = (gui_gl_link_program_fn)loader("glLinkProgram");
+    gl->get_programiv = (gui_gl_get_programiv_fn)loader("glGetProgramiv");
+    gl->get_program_info_log = (gui_gl_get_program_info_log_fn)loader("glGetProgramInfoLog");
+    gl->use_program = (gui_gl_use_program_fn)loader("glUseProgram");
+    gl->delete_shader = (gui_gl_delete_shader_fn)loader("glDeleteShader");
+    gl->delete_program = (gui_gl_delete_program_fn)loader("glDeleteProgram");
+    gl->get_attrib_location = (gui_gl_get_attrib_location_fn)loader("glGetAttribLocation");
+    gl->get_uniform_location = (gui_gl_get_uniform_location_fn)loader("glGetUniformLocation");
+    gl->vertex_attrib_pointer = (gui_gl_vertex_attrib_pointer_fn)loader("glVertexAttribPointer");
+    gl->enable_vertex_attrib_array =
+        (gui_gl_enable_vertex_attrib_array_fn)loader("glEnableVertexAttribArray");
+    gl->disable_vertex_attrib_array =
+        (gui_gl_disable_vertex_attrib_array_fn)loader("glDisableVertexAttribArray");
+    gl->uniform_matrix4fv = (gui_gl_uniform_matrix4fv_fn)loader("glUniformMatrix4fv");
+    gl->uniform1i = (gui_gl_uniform1i_fn)loader("glUniform1i");
+    gl->map_buffer = (gui_gl_map_buffer_fn)loader("glMapBuffer");
+    gl->unmap_buffer = (gui_gl_unmap_buffer_fn)loader("glUnmapBuffer");
+    gl->blend_func_separate = (gui_gl_blend_func_separate_fn)loader("glBlendFuncSeparate");
+    gl->gen_framebuffers = (gui_gl_gen_framebuffers_fn)loader("glGenFramebuffers");
+    gl->delete_framebuffers = (gui_gl_delete_framebuffers_fn)loader("glDeleteFramebuffers");
+    gl->bind_framebuffer = (gui_gl_bind_framebuffer_fn)loader("glBindFramebuffer");
+    gl->framebuffer_texture_2d =
+        (gui_gl_framebuffer_texture_2d_fn)loader("glFramebufferTexture2D");
+    gl->check_framebuffer_status =
+        (gui_gl_check_framebuffer_status_fn)loader("glCheckFramebufferStatus");
 }
 
+// Vertex depth (z = 0 without the opaque pass)
+#ifdef CGUI_ENABLE_OPAQUE_PASS
+#define GUI_GL_DEPTH_ATTRIBUTE "attribute float a_depth;\n"
+#define GUI_GL_DEPTH "a_depth"
+#else
+#define GUI_GL_DEPTH_ATTRIBUTE ""
+#define GUI_GL_DEPTH "0.0"
+#endif
+
 // Simple vertex shader
-static const char *vertex_shader_src = "#version 120\n"
-                                       "uniform mat4 u_projection;\n"
-                                       "attribute vec2 a_pos;\n"
-                                       "attribute vec2 a_uv;\n"
-                                       "attribute vec4 a_color;\n"
-                                       "varying vec2 v_uv;\n"
-                                       "varying vec4 v_color;\n"
-                                       "void main() {\n"
-                                       "    gl_Position = u_projection * vec4(a_pos, 0.0, 1.0);\n"
-                                       "    v_uv = a_uv;\n"
-                                       "    v_color = a_color;\n"
-                                       "}\n";
-
-// Simple fragment shader
-static const char *fragment_shader_src = "#version 120\n"
-                                         "varying vec2 v_uv;\n"
-                                         "varying vec4 v_color;\n"
-                                         "void main() {\n"
-                                         "    gl_FragColor = v_color;\n"
-                                         "}\n";
-
-static unsigned int gui_compile_shader(unsigned int type, const char *source) {
-    unsigned int shader = gl_create_shader(type);
-    gl_shader_source(shader, 1, &source, NULL);
-    gl_compile_shader(shader);
+static const char *vertex_shader_src =
+    "#version 120\n"
+    "uniform mat4 u_projection;\n"
+    "uniform mat4 u_transform;\n"
+    "attribute vec2 a_pos;\n"
+    "attribute vec2 a_uv;\n"
+    "attribute vec4 a_color;\n" GUI_GL_DEPTH_ATTRIBUTE
+    "varying vec2 v_uv;\n"
+    "varying vec4 v_color;\n"
+    "void main() {\n"
+    "    gl_Position = u_projection * u_transform * vec4(a_pos, " GUI_GL_DEPTH ", 1.0);\n"
+    "    v_uv = a_uv;\n"
+    "    v_color = a_color;\n"
+    "}\n";
+
+// Simple fragment shader (untextured geometry samples a 1x1 white texture)
+static const char *fragment_shader_src =
+    "#version 120\n"
+    "uniform sampler2D u_texture;\n"
+    "varying vec2 v_uv;\n"
+    "varying vec4 v_color;\n"
+    "void main() {\n"
+    "    gl_FragColor = v_color * texture2D(u_texture, v_uv);\n"
+    "}\n";
+
+static unsigned int gui_compile_shader(const gui_backend_gl_functions_t *gl, unsigned int type,
+                                       const char *source) {
+    unsigned int shader = gl->create_shader(type);
+    gl->shader_source(shader, 1, &source, NULL);
+    gl->compile_shader(shader);
 
     int success;
-    gl_get_shaderiv(shader, GL_COMPILE_STATUS, &success);
+    gl->get_shaderiv(shader, GL_COMPILE_STATUS, &success);
     if (!success) {
         char info_log[512];
-        gl_get_shader_info_log(shader, 512, NULL, info_log);
+        gl->get_shader_info_log(shader, 512, NULL, info_log);
         fprintf(stderr, "Shader compilation error: %s\n", info_log);
         return 0;
     }
@@ -210,147 +378,635 @@ static unsigned int gui_compile_shader(unsigned int type, const char *source) {
     return shader;
 }
 
-static unsigned int gui_create_shader_program(void) {
-    unsigned int vertex_shader = gui_compile_shader(GL_VERTEX_SHADER, vertex_shader_src);
-    unsigned int fragment_shader = gui_compile_shader(GL_FRAGMENT_SHADER, fragment_shader_src);
+static unsigned int gui_create_shader_program(const gui_backend_gl_functions_t *gl) {
+    unsigned int vertex_shader = gui_compile_shader(gl, GL_VERTEX_SHADER, vertex_shader_src);
+    unsigned int fragment_shader = gui_compile_shader(gl, GL_FRAGMENT_SHADER, fragment_shader_src);
 
     if (!vertex_shader || !fragment_shader) {
         return 0;
     }
 
-    unsigned int program = gl_create_program();
-    gl_attach_shader(program, vertex_shader);
-    gl_attach_shader(program, fragment_shader);
-    gl_link_program(program);
+    unsigned int program = gl->create_program();
+    gl->attach_shader(program, vertex_shader);
+    gl->attach_shader(program, fragment_shader);
+    gl->link_program(program);
 
     int success;
-    gl_get_programiv(program, GL_LINK_STATUS, &success);
+    gl->get_programiv(program, GL_LINK_STATUS, &success);
     if (!success) {
         char info_log[512];
-        gl_get_program_info_log(program, 512, NULL, info_log);
+        gl->get_program_info_log(program, 512, NULL, info_log);
         fprintf(stderr, "Shader linking error: %s\n", info_log);
         return 0;
     }
 
-    gl_delete_shader(vertex_shader);
-    gl_delete_shader(fragment_shader);
+    gl->delete_shader(vertex_shader);
+    gl->delete_shader(fragment_shader);
 
     return program;
 }
 
-void gui_backend_gl_init(gui_backend_gl_t *backend) {
+void gui_backend_gl_init(gui_backend_gl_t *backend) { gui_backend_gl_init_ex(backend, NULL, NULL); }
+
+bool gui_backend_gl_init_ex(gui_backend_gl_t *backend, gui_gl_loader_t loader,
+                            gui_backend_gl_shared_t *shared) {
     memset(backend, 0, sizeof(gui_backend_gl_t));
+    const gui_backend_gl_functions_t *gl = &backend->gl;
 
     // Load OpenGL functions
-    gui_load_gl_functions();
+    gui_backend_gl_load_functions(&backend->gl, loader ? loader : glfwGetProcAddress);
 
     // Create buffers
-    gl_gen_buffers(1, &backend->vbo);
-    gl_gen_buffers(1, &backend->ebo);
+    gl->gen_buffers(1, &backend->vbo);
+    gl->gen_buffers(1, &backend->ebo);
+#ifdef CGUI_ENABLE_OPAQUE_PASS
+    gl->gen_buffers(1, &backend->opaque_ebo);
+    backend->opaque_pass = true;
+#endif
+    backend->layer_budget = CGUI_GL_LAYER_BUDGET;
+
+    backend->shared = shared ? shared : &backend->own_shared;
+    shared = backend->shared;
+    if (shared->ref_count++ > 0) {
+        return shared->shader_program != 0;
+    }
 
     // Create shader program
-    backend->shader_program = gui_create_shader_program();
-    if (!backend->shader_program) {
+    shared->shader_program = gui_create_shader_program(gl);
+    if (!shared->shader_program) {
         fprintf(stderr, "Failed to create shader program\n");
-        return;
+        return false;
     }
 
     // Get attribute/uniform locations
-    backend->attrib_pos = gl_get_attrib_location(backend->shader_program, "a_pos");
-    backend->attrib_uv = gl_get_attrib_location(backend->shader_program, "a_uv");
-    backend->attrib_color = gl_get_attrib_location(backend->shader_program, "a_color");
-    backend->uniform_projection = gl_get_uniform_location(backend->shader_program, "u_projection");
+    shared->attrib_pos = gl->get_attrib_location(shared->shader_program, "a_pos");
+    shared->attrib_uv = gl->get_attrib_location(shared->shader_program, "a_uv");
+    shared->attrib_color = gl->get_attrib_location(shared->shader_program, "a_color");
+#ifdef CGUI_ENABLE_OPAQUE_PASS
+    shared->attrib_depth = gl->get_attrib_location(shared->shader_program, "a_depth");
+#endif
+    shared->uniform_projection = gl->get_uniform_location(shared->shader_program, "u_projection");
+    shared->uniform_transform = gl->get_uniform_location(shared->shader_program, "u_transform");
+    shared->uniform_texture = gl->get_uniform_location(shared->shader_program, "u_texture");
+
+    // Untextured geometry multiplies its color by this texture
+    const uint32_t white = 0xFFFFFFFFU;
+    shared->white_texture =
+        (unsigned int)(uintptr_t)gui_backend_gl_create_texture(backend, 1, 1, &white);
+    return true;
 }
 
 void gui_backend_gl_shutdown(gui_backend_gl_t *backend) {
+    const gui_backend_gl_functions_t *gl = &backend->gl;
+    gui_backend_gl_shared_t *shared = backend->shared;
+    if (shared && --shared->ref_count == 0) {
+        if (shared->white_texture) {
+            glDeleteTextures(1, &shared->white_texture);
+        }
+        if (shared->shader_program) {
+            gl->delete_program(shared->shader_program);
+        }
+        memset(shared, 0, sizeof(gui_backend_gl_shared_t));
+    }
+    for (int i = 0; i < CGUI_GL_STREAM_BUFFERS; i++) {
+        if (backend->stream_buffers[i]) {
+            gl->delete_buffers(1, &backend->stream_buffers[i]);
+        }
+    }
     if (backend->vbo) {
-        gl_delete_buffers(1, &backend->vbo);
+        gl->delete_buffers(1, &backend->vbo);
     }
     if (backend->ebo) {
-        gl_delete_buffers(1, &backend->ebo);
+        gl->delete_buffers(1, &backend->ebo);
     }
-    if (backend->shader_program) {
-        gl_delete_program(backend->shader_program);
+#ifdef CGUI_ENABLE_OPAQUE_PASS
+    if (backend->opaque_ebo) {
+        gl->delete_buffers(1, &backend->opaque_ebo);
+    }
+#endif
+    for (uint32_t i = 0; i < backend->layer_count; i++) {
+        gl->delete_framebuffers(1, &backend->layers[i].framebuffer);
+        glDeleteTextures(1, &backend->layers[i].texture);
     }
+    CGUI_FREE(backend->layers);
     memset(backend, 0, sizeof(gui_backend_gl_t));
 }
 
+static double gui_backend_gl_time_ms(void) { return (double)gui_time_ns() / 1000000.0; }
+
+// Hands the accumulated upload counters to the context
+static void gui_backend_gl_report_uploads(gui_backend_gl_t *backend, gui_context_t *ctx) {
+    gui_report_upload(ctx, backend->upload_bytes, (float)backend->upload_ms);
+    backend->upload_bytes = 0;
+    backend->upload_ms = 0.0;
+}
+
+// =============================================================================
+// CACHED LAYERS
+// =============================================================================
+
+static gui_backend_gl_layer_t *gui_backend_gl_find_layer(const gui_backend_gl_t *backend,
+                                                         gui_id_t id) {
+    for (uint32_t i = 0; i < backend->layer_count; i++) {
+        if (backend->layers[i].id == id) {
+            return &backend->layers[i];
+        }
+    }
+    return NULL;
+}
+
+static bool gui_backend_gl_layers_supported(const gui_backend_gl_t *backend) {
+    const gui_backend_gl_functions_t *gl = &backend->gl;
+    return gl->blend_func_separate && gl->gen_framebuffers && gl->delete_framebuffers &&
+           gl->bind_framebuffer && gl->framebuffer_texture_2d && gl->check_framebuffer_status;
+}
+
+static void gui_backend_gl_delete_layer(gui_backend_gl_t *backend, gui_backend_gl_layer_t *layer) {
+    backend->gl.delete_framebuffers(1, &layer->framebuffer);
+    glDeleteTextures(1, &layer->texture);
+    backend->layer_bytes -= (size_t)layer->width * (size_t)layer->height * 4U;
+    *layer = backend->layers[--backend->layer_count];
+}
+
+// The layer's texture and framebuffer at the given size, created or resized as needed. NULL
+// when the framebuffer is unusable.
+static gui_backend_gl_layer_t *gui_backend_gl_layer_target(gui_backend_gl_t *backend, gui_id_t id,
+                                                           int width, int height) {
+    const gui_backend_gl_functions_t *gl = &backend->gl;
+    gui_backend_gl_layer_t *layer = gui_backend_gl_find_layer(backend, id);
+    if (layer && (layer->width != width || layer->height != height)) {
+        gui_backend_gl_delete_layer(backend, layer);
+        layer = NULL;
+    }
+    if (layer) {
+        return layer;
+    }
+    if (backend->layer_count >= backend->layer_capacity) {
+        uint32_t capacity = (backend->layer_capacity > 0) ? backend->layer_capacity * 2U : 8U;
+        void *grown = CGUI_REALLOC(backend->layers, capacity * sizeof(gui_backend_gl_layer_t));
+        if (!grown) {
+            return NULL;
+        }
+        backend->layers = (gui_backend_gl_layer_t *)grown;
+        backend->layer_capacity = capacity;
+    }
+
+    layer = &backend->layers[backend->layer_count++];
+    memset(layer, 0, sizeof(gui_backend_gl_layer_t));
+    layer->id = id;
+    layer->width = width;
+    layer->height = height;
+    layer->texture =
+        (unsigned int)(uintptr_t)gui_backend_gl_create_texture(backend, width, height, NULL);
+    backend->layer_bytes += (size_t)width * (size_t)height * 4U;
+    gl->gen_framebuffers(1, &layer->framebuffer);
+    gl->bind_framebuffer(GL_FRAMEBUFFER, layer->framebuffer);
+    gl->framebuffer_texture_2d(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D,
+                               layer->texture, 0);
+    if (gl->check_framebuffer_status(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        gui_backend_gl_delete_layer(backend, layer);
+        return NULL;
+    }
+    return layer;
+}
+
+// Frees the least recently used layers the current render does not need until the textures
+// fit the budget
+static void gui_backend_gl_evict_layers(gui_backend_gl_t *backend, gui_context_t *ctx) {
+    while (backend->layer_bytes > backend->layer_budget) {
+        gui_backend_gl_layer_t *oldest = NULL;
+        for (uint32_t i = 0; i < backend->layer_count; i++) {
+            gui_backend_gl_layer_t *layer = &backend->layers[i];
+            if (layer->last_used != backend->render_count &&
+                (!oldest || layer->last_used < oldest->last_used)) {
+                oldest = layer;
+            }
+        }
+        if (!oldest) {
+            return;
+        }
+        gui_invalidate_cached_layer(ctx, oldest->id);
+        gui_backend_gl_delete_layer(backend, oldest);
+    }
+}
+
+static void gui_backend_gl_set_projection(const gui_backend_gl_t *backend, float l, float r,
+                                          float t, float b) {
+    // Orthographic, vertex depth [0, 1] mapping to clip z [-1, 1]
+    float projection[16] = {
+        2.0F / (r - l),    0.0F,              0.0F,  0.0F, //
+        0.0F,              2.0F / (t - b),    0.0F,  0.0F, //
+        0.0F,              0.0F,              2.0F,  0.0F, //
+        (r + l) / (l - r), (t + b) / (b - t), -1.0F, 1.0F,
+    };
+    backend->gl.uniform_matrix4fv(backend->shared->uniform_projection, 1, 0, projection);
+}
+
+// Loads a command's 2D affine transform as the column-major model matrix
+static void gui_backend_gl_set_transform(const gui_backend_gl_t *backend,
+                                         const gui_transform_t *t) {
+    float transform[16] = {
+        t->m[0], t->m[1], 0.0F, 0.0F, //
+        t->m[2], t->m[3], 0.0F, 0.0F, //
+        0.0F,    0.0F,    1.0F, 0.0F, //
+        t->m[4], t->m[5], 0.0F, 1.0F,
+    };
+    backend->gl.uniform_matrix4fv(backend->shared->uniform_transform, 1, 0, transform);
+}
+
+// Index of the LAYER_END closing the LAYER_BEGIN at `begin` (the command count if missing)
+static uint32_t gui_backend_gl_layer_end(const gui_draw_cmd_t *commands, uint32_t count,
+                                         uint32_t begin) {
+    uint32_t end = begin + 1;
+    while (end < count && commands[end].type != GUI_DRAW_CMD_LAYER_END) {
+        end++;
+    }
+    return end;
+}
+
+// =============================================================================
+// RENDERING
+// =============================================================================
+
+// Issues one command list from the bound index buffer. Clip rects are relative to `target`, the
+// area of the bound framebuffer; the default framebuffer has y pointing up (flip_y).
+static void gui_backend_gl_draw_list(const gui_backend_gl_t *backend,
+                                     const gui_draw_cmd_t *commands, uint32_t command_count,
+                                     gui_rect_t target, bool flip_y, unsigned int *bound_texture) {
+    gui_transform_t transform = {{NAN}}; // Loaded before the first draw
+    for (uint32_t cmd_i = 0; cmd_i < command_count; cmd_i++) {
+        const gui_draw_cmd_t *cmd = &commands[cmd_i];
+        gui_id_t layer_id = (gui_id_t)(uintptr_t)cmd->texture;
+        const gui_backend_gl_layer_t *layer = NULL;
+
+        if (cmd->type == GUI_DRAW_CMD_LAYER_BEGIN || cmd->type == GUI_DRAW_CMD_LAYER_DRAW) {
+            layer = gui_backend_gl_find_layer(backend, layer_id);
+        }
+        if (cmd->type == GUI_DRAW_CMD_LAYER_BEGIN && layer &&
+            layer->rendered == backend->render_count) {
+            // Content went to the layer's texture
+            cmd_i = gui_backend_gl_layer_end(commands, command_count, cmd_i);
+            continue;
+        }
+        if (cmd->type == GUI_DRAW_CMD_LAYER_DRAW && !layer) {
+            continue;
+        }
+
+        if (cmd->type == GUI_DRAW_CMD_SET_CLIP_RECT || cmd->type == GUI_DRAW_CMD_TRIANGLES ||
+            cmd->type == GUI_DRAW_CMD_LAYER_DRAW) {
+            // Set scissor rect (triangle commands carry the clip rect they were recorded with)
+            float y = cmd->clip_rect.y - target.y;
+            glScissor((int)(cmd->clip_rect.x - target.x),
+                      (int)(flip_y ? target.h - y - cmd->clip_rect.h : y), (int)cmd->clip_rect.w,
+                      (int)cmd->clip_rect.h);
+        }
+        if ((cmd->type == GUI_DRAW_CMD_TRIANGLES || cmd->type == GUI_DRAW_CMD_LAYER_DRAW) &&
+            cmd->elem_count > 0) {
+            unsigned int texture = layer         ? layer->texture
+                                   : cmd->texture ? (unsigned int)(uintptr_t)cmd->texture
+                                                  : backend->shared->white_texture;
+            if (texture != *bound_texture) {
+                glBindTexture(GL_TEXTURE_2D, texture);
+                *bound_texture = texture;
+            }
+            if (memcmp(&cmd->transform, &transform, sizeof(transform)) != 0) {
+                transform = cmd->transform;
+                gui_backend_gl_set_transform(backend, &transform);
+            }
+            if (layer) {
+                glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA); // Layers hold premultiplied color
+            }
+            glDrawElements(GL_TRIANGLES, (int)cmd->elem_count, GL_UNSIGNED_INT,
+                           (void *)(uintptr_t)(cmd->idx_offset * sizeof(uint32_t)));
+            if (layer) {
+                glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+            }
+        }
+    }
+}
+
+// Renders the content of the layers drawn this frame into their textures, and marks the layers
+// composited this frame as used. Layers that cannot be rendered are invalidated, so they keep
+// drawing their content directly.
+static void gui_backend_gl_render_layers(gui_backend_gl_t *backend, gui_context_t *ctx,
+                                         unsigned int *bound_texture) {
+    const gui_backend_gl_functions_t *gl = &backend->gl;
+    bool supported = gui_backend_gl_layers_supported(backend);
+    int previous_framebuffer = 0;
+    float clear_color[4];
+    bool bound = false;
+
+    for (uint32_t c = 0; c < ctx->draw_command_count; c++) {
+        const gui_draw_cmd_t *cmd = &ctx->draw_commands[c];
+        gui_id_t id = (gui_id_t)(uintptr_t)cmd->texture;
+        if (cmd->type == GUI_DRAW_CMD_LAYER_DRAW) {
+            gui_backend_gl_layer_t *layer = gui_backend_gl_find_layer(backend, id);
+            if (layer) {
+                layer->last_used = backend->render_count;
+            } else {
+                gui_invalidate_cached_layer(ctx, id); // Evicted or never rendered here
+            }
+            continue;
+        }
+        if (cmd->type != GUI_DRAW_CMD_LAYER_BEGIN) {
+            continue;
+        }
+
+        uint32_t end = gui_backend_gl_layer_end(ctx->draw_commands, ctx->draw_command_count, c);
+        gui_backend_gl_layer_t *layer = NULL;
+        if (supported) {
+            if (!bound) {
+                glGetIntegerv(GL_FRAMEBUFFER_BINDING, &previous_framebuffer);
+                glGetFloatv(GL_COLOR_CLEAR_VALUE, clear_color);
+                glDisable(GL_DEPTH_TEST);
+                gl->blend_func_separate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE,
+                                        GL_ONE_MINUS_SRC_ALPHA);
+                bound = true;
+            }
+            layer = gui_backend_gl_layer_target(backend, id, (int)ceilf(cmd->clip_rect.w),
+                                                (int)ceilf(cmd->clip_rect.h));
+        }
+        if (!layer) {
+            gui_invalidate_cached_layer(ctx, id);
+            c = end;
+            continue;
+        }
+
+        gl->bind_framebuffer(GL_FRAMEBUFFER, layer->framebuffer);
+        glViewport(0, 0, layer->width, layer->height);
+        glDisable(GL_SCISSOR_TEST);
+        glClearColor(0.0F, 0.0F, 0.0F, 0.0F);
+        glClear(GL_COLOR_BUFFER_BIT);
+        glEnable(GL_SCISSOR_TEST);
+
+        // Texture rows run from the top of the layer, so the composite quad's v = 0 is its top
+        gui_rect_t area = {cmd->clip_rect.x, cmd->clip_rect.y, (float)layer->width,
+                           (float)layer->height};
+        gui_backend_gl_set_projection(backend, area.x, area.x + area.w, area.y + area.h, area.y);
+        gui_backend_gl_draw_list(backend, &ctx->draw_commands[c + 1], end - (c + 1), area,
+                                 false, bound_texture);
+        layer->rendered = backend->render_count;
+        layer->last_used = backend->render_count;
+        c = end;
+    }
+
+    if (bound) {
+        gl->bind_framebuffer(GL_FRAMEBUFFER, (unsigned int)previous_framebuffer);
+        glClearColor(clear_color[0], clear_color[1], clear_color[2], clear_color[3]);
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    }
+    glDisable(GL_SCISSOR_TEST);
+    gui_backend_gl_evict_layers(backend, ctx);
+}
+
 void gui_backend_gl_render(gui_backend_gl_t *backend, gui_context_t *ctx) {
+    GUI_TRACE_BEGIN("gui_backend_gl_render");
     if (ctx->vertex_count == 0 || ctx->index_count == 0) {
+        gui_backend_gl_report_uploads(backend, ctx);
+        GUI_TRACE_END();
         return;
     }
+#ifdef CGUI_ENABLE_OPAQUE_PASS
+    bool opaque_pass = backend->opaque_pass && ctx->opaque_command_count > 0;
+#endif
+    backend->render_count++;
 
     // Setup render state
     glEnable(GL_BLEND);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
     glDisable(GL_CULL_FACE);
+
+    // Use shader program
+    const gui_backend_gl_functions_t *gl = &backend->gl;
+    const gui_backend_gl_shared_t *shared = backend->shared;
+    gl->use_program(shared->shader_program);
+    gl->uniform1i(shared->uniform_texture, 0);
+
+    // Upload vertex and index data
+    double upload_start = gui_backend_gl_time_ms();
+    size_t vertex_bytes = sizeof(gui_vertex_t) * ctx->vertex_count;
+    size_t index_bytes = sizeof(uint32_t) * ctx->index_count;
+    gl->bind_buffer(GL_ARRAY_BUFFER, backend->vbo);
+    gl->buffer_data(GL_ARRAY_BUFFER, (ptrdiff_t)vertex_bytes, ctx->vertices, GL_DYNAMIC_DRAW);
+
+#ifdef CGUI_ENABLE_OPAQUE_PASS
+    if (opaque_pass) {
+        size_t opaque_bytes = sizeof(uint32_t) * ctx->opaque_index_count;
+        gl->bind_buffer(GL_ELEMENT_ARRAY_BUFFER, backend->opaque_ebo);
+        gl->buffer_data(GL_ELEMENT_ARRAY_BUFFER, (ptrdiff_t)opaque_bytes, ctx->opaque_indices,
+                        GL_DYNAMIC_DRAW);
+        backend->upload_bytes += opaque_bytes;
+    }
+#endif
+    gl->bind_buffer(GL_ELEMENT_ARRAY_BUFFER, backend->ebo);
+    gl->buffer_data(GL_ELEMENT_ARRAY_BUFFER, (ptrdiff_t)index_bytes, ctx->indices,
+                    GL_DYNAMIC_DRAW);
+    backend->upload_bytes += vertex_bytes + index_bytes;
+    backend->upload_ms += gui_backend_gl_time_ms() - upload_start;
+    gui_backend_gl_report_uploads(backend, ctx);
+
+    // Setup vertex attributes
+    gl->enable_vertex_attrib_array(shared->attrib_pos);
+    gl->enable_vertex_attrib_array(shared->attrib_uv);
+    gl->enable_vertex_attrib_array(shared->attrib_color);
+#ifdef CGUI_ENABLE_OPAQUE_PASS
+    gl->enable_vertex_attrib_array(shared->attrib_depth);
+#endif
+
+    gl->vertex_attrib_pointer(shared->attrib_pos, 2, GL_FLOAT, 0, sizeof(gui_vertex_t),
+                              (void *)offsetof(gui_vertex_t, pos));
+    gl->vertex_attrib_pointer(shared->attrib_uv, 2, GL_FLOAT, 0, sizeof(gui_vertex_t),
+                              (void *)offsetof(gui_vertex_t, uv));
+    gl->vertex_attrib_pointer(shared->attrib_color, 4, GL_UNSIGNED_BYTE, 1,
+                              sizeof(gui_vertex_t), (void *)offsetof(gui_vertex_t, col));
+#ifdef CGUI_ENABLE_OPAQUE_PASS
+    gl->vertex_attrib_pointer(shared->attrib_depth, 1, GL_FLOAT, 0, sizeof(gui_vertex_t),
+                              (void *)offsetof(gui_vertex_t, depth));
+#endif
+
+    unsigned int bound_texture = 0;
+    gui_backend_gl_render_layers(backend, ctx, &bound_texture);
+
+#ifdef CGUI_ENABLE_OPAQUE_PASS
+    if (opaque_pass) {
+        glEnable(GL_DEPTH_TEST);
+        glDepthFunc(GL_LESS);
+        glDepthMask(GL_TRUE);
+        glClear(GL_DEPTH_BUFFER_BIT);
+    } else {
+        glDisable(GL_DEPTH_TEST);
+    }
+#else
     glDisable(GL_DEPTH_TEST);
+#endif
     glEnable(GL_SCISSOR_TEST);
-
-    // Setup viewport
     glViewport(0, 0, (int)ctx->display_width, (int)ctx->display_height);
+    gui_backend_gl_set_projection(backend, 0.0F, ctx->display_width, 0.0F, ctx->display_height);
+
+    // Opaque primitives nearest first, unblended, writing depth. The full list then draws
+    // back-to-front without depth writes: pixels already covered by a nearer opaque primitive
+    // (including the opaque primitives themselves, at equal depth) fail the depth test before
+    // shading.
+    gui_rect_t screen = {0.0F, 0.0F, ctx->display_width, ctx->display_height};
+#ifdef CGUI_ENABLE_OPAQUE_PASS
+    if (opaque_pass) {
+        glDisable(GL_BLEND);
+        gl->bind_buffer(GL_ELEMENT_ARRAY_BUFFER, backend->opaque_ebo);
+        gui_backend_gl_draw_list(backend, ctx->opaque_commands, ctx->opaque_command_count,
+                                 screen, true, &bound_texture);
+        glEnable(GL_BLEND);
+        glDepthMask(GL_FALSE);
+        gl->bind_buffer(GL_ELEMENT_ARRAY_BUFFER, backend->ebo);
+    }
+#endif
+    gui_backend_gl_draw_list(backend, ctx->draw_commands, ctx->draw_command_count, screen,
+                             true, &bound_texture);
 
-    // Setup orthographic projection matrix
-    float l = 0.0F;
-    float r = ctx->display_width;
-    float t = 0.0F;
-    float b = ctx->display_height;
-    float projection[16] = {
-        2.0F / (r - l), 0.0F, 0.0F, 0.0F,  0.0F, 2.0F / (t - b),    0.0F,
-        0.0F,           0.0F, 0.0F, -1.0F, 0.0F, (r + l) / (l - r), (t + b) / (b - t),
-        0.0F,           1.0F,
-    };
+    // Cleanup
+    gl->disable_vertex_attrib_array(shared->attrib_pos);
+    gl->disable_vertex_attrib_array(shared->attrib_uv);
+    gl->disable_vertex_attrib_array(shared->attrib_color);
+#ifdef CGUI_ENABLE_OPAQUE_PASS
+    gl->disable_vertex_attrib_array(shared->attrib_depth);
+#endif
+    gl->bind_buffer(GL_ARRAY_BUFFER, 0);
+    gl->bind_buffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    gl->use_program(0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glDisable(GL_SCISSOR_TEST);
+    glDepthMask(GL_TRUE);
+    glDisable(GL_DEPTH_TEST);
+    GUI_TRACE_END();
+}
 
-    // Use shader program
-    gl_use_program(backend->shader_program);
-    gl_uniform_matrix4fv(backend->uniform_projection, 1, 0, projection);
+// =============================================================================
+// TEXTURES
+// =============================================================================
 
-    // Upload vertex and index data
-    gl_bind_buffer(GL_ARRAY_BUFFER, backend->vbo);
-    gl_buffer_data(GL_ARRAY_BUFFER, (ptrdiff_t)sizeof(gui_vertex_t) * ctx->vertex_count,
-                   ctx->vertices, GL_DYNAMIC_DRAW);
+gui_texture_id_t gui_backend_gl_create_texture(gui_backend_gl_t *backend, int width, int height,
+                                               const void *pixels) {
+    unsigned int texture = 0;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    double upload_start = gui_backend_gl_time_ms();
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+    if (pixels) {
+        backend->upload_bytes += (uint64_t)width * (uint64_t)height * 4U;
+        backend->upload_ms += gui_backend_gl_time_ms() - upload_start;
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+    return (gui_texture_id_t)(uintptr_t)texture;
+}
+
+void gui_backend_gl_update_texture(gui_backend_gl_t *backend, gui_texture_id_t texture, int x,
+                                   int y, int width, int height, const void *pixels) {
+    void *staging = gui_backend_gl_stream_begin(backend, texture, x, y, width, height);
+    if (staging) {
+        memcpy(staging, pixels, (size_t)width * (size_t)height * 4U);
+        gui_backend_gl_stream_end(backend);
+        return;
+    }
 
-    gl_bind_buffer(GL_ELEMENT_ARRAY_BUFFER, backend->ebo);
-    gl_buffer_data(GL_ELEMENT_ARRAY_BUFFER, (ptrdiff_t)sizeof(uint32_t) * ctx->index_count,
-                   ctx->indices, GL_DYNAMIC_DRAW);
+    glBindTexture(GL_TEXTURE_2D, (unsigned int)(uintptr_t)texture);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    double upload_start = gui_backend_gl_time_ms();
+    glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+    backend->upload_bytes += (uint64_t)width * (uint64_t)height * 4U;
+    backend->upload_ms += gui_backend_gl_time_ms() - upload_start;
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
 
-    // Setup vertex attributes
-    gl_enable_vertex_attrib_array(backend->attrib_pos);
-    gl_enable_vertex_attrib_array(backend->attrib_uv);
-    gl_enable_vertex_attrib_array(backend->attrib_color);
-
-    gl_vertex_attrib_pointer(backend->attrib_pos, 2, GL_FLOAT, 0, sizeof(gui_vertex_t),
-                             (void *)offsetof(gui_vertex_t, pos));
-    gl_vertex_attrib_pointer(backend->attrib_uv, 2, GL_FLOAT, 0, sizeof(gui_vertex_t),
-                             (void *)offsetof(gui_vertex_t, uv));
-    gl_vertex_attrib_pointer(backend->attrib_color, 4, GL_UNSIGNED_BYTE, 1, sizeof(gui_vertex_t),
-                             (void *)offsetof(gui_vertex_t, col));
-
-    // Render all draw commands
-    uint32_t idx_offset = 0;
-    for (uint32_t cmd_i = 0; cmd_i < ctx->draw_command_count; cmd_i++) {
-        gui_draw_cmd_t *cmd = &ctx->draw_commands[cmd_i];
-
-        if (cmd->type == GUI_DRAW_CMD_SET_CLIP_RECT) {
-            // Set scissor rect
-            glScissor((int)cmd->clip_rect.x,
-                      (int)(ctx->display_height - cmd->clip_rect.y - cmd->clip_rect.h),
-                      (int)cmd->clip_rect.w, (int)cmd->clip_rect.h);
-        } else if (cmd->type == GUI_DRAW_CMD_TRIANGLES) {
-            glDrawElements(GL_TRIANGLES, (int)cmd->elem_count, GL_UNSIGNED_INT,
-                           (void *)(uintptr_t)(idx_offset * sizeof(uint32_t)));
-            idx_offset += cmd->elem_count;
+void gui_backend_gl_destroy_texture(gui_backend_gl_t *backend, gui_texture_id_t texture) {
+    (void)backend;
+    unsigned int name = (unsigned int)(uintptr_t)texture;
+    if (name) {
+        glDeleteTextures(1, &name);
+    }
+}
+
+void gui_backend_gl_upload_atlas(gui_backend_gl_t *backend, gui_atlas_t *atlas) {
+    for (uint32_t i = 0; i < atlas->page_count; i++) {
+        gui_atlas_page_t *page = &atlas->pages[i];
+        if (!page->texture) {
+            page->texture = gui_backend_gl_create_texture(backend, atlas->page_width,
+                                                          atlas->page_height, page->pixels);
+        } else if (page->dirty_y0 < page->dirty_y1) {
+            // Whole rows are contiguous in the page's pixels
+            size_t offset = (size_t)page->dirty_y0 * (size_t)atlas->page_width * 4U;
+            gui_backend_gl_update_texture(backend, page->texture, 0, page->dirty_y0,
+                                          atlas->page_width, page->dirty_y1 - page->dirty_y0,
+                                          page->pixels + offset);
         }
+        page->dirty_y0 = 0;
+        page->dirty_y1 = 0;
     }
+}
 
-    // Cleanup
-    gl_disable_vertex_attrib_array(backend->attrib_pos);
-    gl_disable_vertex_attrib_array(backend->attrib_uv);
-    gl_disable_vertex_attrib_array(backend->attrib_color);
-    gl_bind_buffer(GL_ARRAY_BUFFER, 0);
-    gl_bind_buffer(GL_ELEMENT_ARRAY_BUFFER, 0);
-    gl_use_program(0);
-    glDisable(GL_SCISSOR_TEST);
+void gui_backend_gl_destroy_atlas(gui_backend_gl_t *backend, gui_atlas_t *atlas) {
+    for (uint32_t i = 0; i < atlas->page_count; i++) {
+        gui_backend_gl_destroy_texture(backend, atlas->pages[i].texture);
+        atlas->pages[i].texture = NULL;
+    }
+}
+
+void *gui_backend_gl_stream_begin(gui_backend_gl_t *backend, gui_texture_id_t texture, int x,
+                                  int y, int width, int height) {
+    const gui_backend_gl_functions_t *gl = &backend->gl;
+    if (!gl->map_buffer || !gl->unmap_buffer || backend->stream_texture || width <= 0 ||
+        height <= 0) {
+        return NULL;
+    }
+
+    int slot = backend->stream_index;
+    backend->stream_index = (backend->stream_index + 1) % CGUI_GL_STREAM_BUFFERS;
+    if (!backend->stream_buffers[slot]) {
+        gl->gen_buffers(1, &backend->stream_buffers[slot]);
+    }
+
+    // Re-specifying the store orphans the previous one, so mapping never waits for a transfer
+    // that is still in flight from this buffer
+    size_t size = (size_t)width * (size_t)height * 4U;
+    gl->bind_buffer(GL_PIXEL_UNPACK_BUFFER, backend->stream_buffers[slot]);
+    gl->buffer_data(GL_PIXEL_UNPACK_BUFFER, (ptrdiff_t)size, NULL, GL_STREAM_DRAW);
+    void *memory = gl->map_buffer(GL_PIXEL_UNPACK_BUFFER, GL_WRITE_ONLY);
+    if (!memory) {
+        gl->bind_buffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        return NULL;
+    }
+
+    backend->stream_texture = texture;
+    backend->stream_rect[0] = x;
+    backend->stream_rect[1] = y;
+    backend->stream_rect[2] = width;
+    backend->stream_rect[3] = height;
+    return memory;
+}
+
+void gui_backend_gl_stream_end(gui_backend_gl_t *backend) {
+    const gui_backend_gl_functions_t *gl = &backend->gl;
+    if (!backend->stream_texture) {
+        return;
+    }
+
+    // The pixel pointer is an offset into the bound unpack buffer: the copy is queued on the GPU
+    double upload_start = gui_backend_gl_time_ms();
+    gl->unmap_buffer(GL_PIXEL_UNPACK_BUFFER);
+    glBindTexture(GL_TEXTURE_2D, (unsigned int)(uintptr_t)backend->stream_texture);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, backend->stream_rect[0], backend->stream_rect[1],
+                    backend->stream_rect[2], backend->stream_rect[3], GL_RGBA, GL_UNSIGNED_BYTE,
+                    NULL);
+    backend->upload_bytes +=
+        (uint64_t)backend->stream_rect[2] * (uint64_t)backend->stream_rect[3] * 4U;
+    backend->upload_ms += gui_backend_gl_time_ms() - upload_start;
+    glBindTexture(GL_TEXTURE_2D, 0);
+    gl->bind_buffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    backend->stream_texture = NULL;
 }
 
 #endif // CGUI_BACKEND_GL_IMPLEMENTATION
@@ -0,0 +1,643 @@
+/*
+ * CGUI - Frame Recording and Replay
+ * Captures sessions as a compact binary stream for offline profiling: every frame stores the
+ * input state it was built from and, optionally, the resulting draw data. Both are delta coded
+ * against the previous frame, so static UI costs a few bytes per frame.
+ *
+ * Recording:
+ *   gui_record_begin_frame after gui_begin_frame (input as the frame saw it),
+ *   gui_record_end_frame after gui_end_frame (writes the frame).
+ *
+ * Replay (the file is memory-mapped):
+ *   Frontend: gui_replay_apply_input, then gui_begin_frame with the recorded display size and
+ *             the same UI code; widgets see the recorded input.
+ *   Backend:  gui_replay_apply_draw_data fills the context's draw lists directly, skipping the
+ *             UI code, and a backend renders them (requires GUI_RECORD_DRAW_DATA).
+ *
+ * Files use native endianness and struct layouts; gui_replay_open rejects files whose layouts
+ * differ. Texture handles are stored as recorded, so backend replays remap them through
+ * gui_replay_t.map_texture when the textures were recreated.
+ *
+ * Usage:
+ *   #define CGUI_RECORD_IMPLEMENTATION
+ *   #include "cgui_record.h"
+ */
+
+#ifndef CGUI_RECORD_H
+#define CGUI_RECORD_H
+
+#include "cgui.h"
+
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define GUI_RECORD_DRAW_DATA 1U // Also record vertices, indices and draw commands
+
+// Delta-coded stream (previous frame's raw bytes, zero past the end)
+typedef struct {
+    uint8_t *data;
+    uint32_t size;
+    uint32_t capacity;
+} gui_record_stream_t;
+
+enum {
+    GUI_RECORD_STREAM_INPUT,
+    GUI_RECORD_STREAM_VERTICES,
+    GUI_RECORD_STREAM_INDICES,
+    GUI_RECORD_STREAM_COMMANDS,
+    GUI_RECORD_STREAM_COUNT,
+};
+
+typedef struct {
+    FILE *file;
+    uint32_t flags;
+    gui_input_t input; // Captured by gui_record_begin_frame
+    float delta_time;
+    bool input_captured;
+    gui_record_stream_t streams[GUI_RECORD_STREAM_COUNT];
+    uint8_t *scratch; // Encoded frame
+    uint32_t scratch_capacity;
+    uint32_t frame_count;
+    uint64_t bytes_written;
+} gui_recorder_t;
+
+typedef struct {
+    // Mapped file
+    const uint8_t *data;
+    size_t size;
+    size_t offset; // Next frame
+    void *map_handle;
+
+    uint32_t flags;
+    uint32_t frame_count; // Frames in the file
+    uint32_t frame_index; // Frames decoded since open or rewind
+
+    // Current frame
+    float display_width;
+    float display_height;
+    float delta_time;
+    gui_record_stream_t streams[GUI_RECORD_STREAM_COUNT];
+
+    // Optional remapping of recorded texture handles for backend replays
+    gui_texture_id_t (*map_texture)(void *user_data, gui_texture_id_t recorded);
+    void *user_data;
+} gui_replay_t;
+
+// Recording. Return false on I/O failure.
+bool gui_record_open(gui_recorder_t *rec, const char *path, uint32_t flags);
+void gui_record_begin_frame(gui_recorder_t *rec, const gui_context_t *ctx);
+bool gui_record_end_frame(gui_recorder_t *rec, const gui_context_t *ctx);
+bool gui_record_close(gui_recorder_t *rec);
+
+// Replay. gui_replay_next decodes the next frame and returns false at the end of the file or
+// on malformed data.
+bool gui_replay_open(gui_replay_t *replay, const char *path);
+bool gui_replay_next(gui_replay_t *replay);
+void gui_replay_rewind(gui_replay_t *replay);
+void gui_replay_close(gui_replay_t *replay);
+
+// Restores the current frame's input and time; call before gui_begin_frame
+void gui_replay_apply_input(const gui_replay_t *replay, gui_context_t *ctx);
+
+// Replaces the context's draw lists with the current frame's (clamped to the context limits);
+// call instead of building a frame. Returns false when the file has no draw data.
+bool gui_replay_apply_draw_data(const gui_replay_t *replay, gui_context_t *ctx);
+
+// Delta coding (also used by cgui_remote.h). gui_record_encode codes data against the stream's
+// reference into out (at least gui_record_encode_bound(size) bytes) and makes data the new
+// reference; gui_record_decode applies a coded delta to the reference in place.
+uint32_t gui_record_encode_bound(uint32_t size);
+bool gui_record_encode(gui_record_stream_t *stream, const void *data, uint32_t size, uint8_t *out,
+                       uint32_t *encoded_size);
+bool gui_record_decode(gui_record_stream_t *stream, uint32_t size, const uint8_t *in,
+                       uint32_t encoded_size);
+void gui_record_stream_reset(gui_record_stream_t *stream); // Empty reference
+void gui_record_stream_free(gui_record_stream_t *stream);
+
+// LEB128 counts (also used by cgui_remote.h). put writes at most 5 bytes and returns the end;
+// get advances *in and fails on truncated or overlong input.
+uint8_t *gui_record_put_varint(uint8_t *out, uint32_t value);
+bool gui_record_get_varint(const uint8_t **in, const uint8_t *end, uint32_t *value);
+
+// Copies decoded vertex, index and command streams (indexed by GUI_RECORD_STREAM_*) into the
+// context's draw lists, dropping out-of-range references; map_texture may be NULL
+void gui_record_load_draw_data(const gui_record_stream_t *streams,
+                               gui_texture_id_t (*map_texture)(void *, gui_texture_id_t),
+                               void *user_data, gui_context_t *ctx);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CGUI_RECORD_H
+
+// =============================================================================
+// IMPLEMENTATION
+// =============================================================================
+
+// Guarded so that headers built on this one can include it again
+#if defined(CGUI_RECORD_IMPLEMENTATION) && !defined(CGUI_RECORD_IMPLEMENTED)
+#define CGUI_RECORD_IMPLEMENTED
+
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifndef CGUI_MALLOC
+#define CGUI_MALLOC(size) malloc(size)
+#define CGUI_CALLOC(count, size) calloc(count, size)
+#define CGUI_REALLOC(ptr, size) realloc(ptr, size)
+#define CGUI_FREE(ptr) free(ptr)
+#endif
+
+// File layout (native endianness):
+//   header: magic[8], version, flags, sizeof(gui_input_t), sizeof(gui_vertex_t),
+//           sizeof(gui_draw_cmd_t) as uint32
+//   frame:  payload size (uint32), display width, height, delta time (float), then per stream
+//           raw size and encoded size (uint32) followed by the encoded bytes
+// A stream is XORed with the same stream of the previous frame (zero past its end) and the
+// result is coded as (zero run, literal count, literals) tokens with LEB128 counts.
+#define GUI_RECORD_MAGIC "CGUIREC"
+#define GUI_RECORD_VERSION 1U
+#define GUI_RECORD_HEADER_SIZE 28U
+#define GUI_RECORD_MIN_ZERO_RUN 8U // Shorter zero runs stay in the literals
+
+static uint32_t gui_record_stream_count(uint32_t flags) {
+    return (flags & GUI_RECORD_DRAW_DATA) ? GUI_RECORD_STREAM_COUNT : 1U;
+}
+
+// Grows capacity keeping the bytes past size zero
+static bool gui_record_stream_reserve(gui_record_stream_t *stream, uint32_t size) {
+    if (size <= stream->capacity) {
+        return true;
+    }
+    uint32_t capacity = stream->capacity ? stream->capacity : 256U;
+    while (capacity < size) {
+        capacity *= 2U;
+    }
+    uint8_t *data = (uint8_t *)CGUI_REALLOC(stream->data, capacity);
+    if (!data) {
+        return false;
+    }
+    memset(data + stream->capacity, 0, capacity - stream->capacity);
+    stream->data = data;
+    stream->capacity = capacity;
+    return true;
+}
+
+void gui_record_stream_reset(gui_record_stream_t *stream) {
+    if (stream->size > 0) {
+        memset(stream->data, 0, stream->size);
+    }
+    stream->size = 0;
+}
+
+void gui_record_stream_free(gui_record_stream_t *stream) {
+    CGUI_FREE(stream->data);
+    memset(stream, 0, sizeof(gui_record_stream_t));
+}
+
+uint8_t *gui_record_put_varint(uint8_t *out, uint32_t value) {
+    while (value >= 0x80U) {
+        *out++ = (uint8_t)(value | 0x80U);
+        value >>= 7;
+    }
+    *out++ = (uint8_t)value;
+    return out;
+}
+
+bool gui_record_get_varint(const uint8_t **in, const uint8_t *end, uint32_t *value) {
+    uint32_t result = 0;
+    for (uint32_t shift = 0; shift < 35U; shift += 7U) {
+        if (*in >= end) {
+            return false;
+        }
+        uint8_t byte = *(*in)++;
+        result |= (uint32_t)(byte & 0x7FU) << shift;
+        if (!(byte & 0x80U)) {
+            *value = result;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Every token after the first skips at least GUI_RECORD_MIN_ZERO_RUN bytes and costs at most two
+// 5-byte counts
+uint32_t gui_record_encode_bound(uint32_t size) {
+    return size + ((size / GUI_RECORD_MIN_ZERO_RUN) + 1U) * 10U;
+}
+
+bool gui_record_encode(gui_record_stream_t *stream, const void *bytes, uint32_t size, uint8_t *out,
+                       uint32_t *encoded_size) {
+    if (!gui_record_stream_reserve(stream, size)) {
+        return false;
+    }
+    const uint8_t *data = (const uint8_t *)bytes;
+    const gui_record_stream_t *prev = stream; // Zero past its size
+    uint8_t *cursor = out;
+    uint32_t i = 0;
+    while (i < size) {
+        uint32_t zero_start = i;
+        while (i < size && data[i] == prev->data[i]) {
+            i++;
+        }
+        uint32_t zero_run = i - zero_start;
+        uint32_t literal_start = i;
+        uint32_t literal_end = i;
+        while (i < size) {
+            // Extend the literals until a zero run long enough to pay for a token
+            uint32_t run = 0;
+            while (i + run < size && data[i + run] == prev->data[i + run]) {
+                run++;
+            }
+            if (run >= GUI_RECORD_MIN_ZERO_RUN || i + run == size) {
+                break;
+            }
+            i += run + 1U;
+            literal_end = i;
+        }
+        uint32_t literal_count = literal_end - literal_start;
+        if (literal_count == 0) {
+            break; // Trailing zeros are implied by the raw size
+        }
+        cursor = gui_record_put_varint(cursor, zero_run);
+        cursor = gui_record_put_varint(cursor, literal_count);
+        for (uint32_t j = literal_start; j < literal_end; j++) {
+            *cursor++ = (uint8_t)(data[j] ^ prev->data[j]);
+        }
+        i = literal_end;
+    }
+    *encoded_size = (uint32_t)(cursor - out);
+
+    // Keep data as the next reference, zero past its end
+    if (size < stream->size) {
+        memset(stream->data + size, 0, stream->size - size);
+    }
+    if (size > 0) {
+        memcpy(stream->data, data, size);
+    }
+    stream->size = size;
+    return true;
+}
+
+bool gui_record_decode(gui_record_stream_t *stream, uint32_t size, const uint8_t *in,
+                       uint32_t encoded_size) {
+    if (size < stream->size) {
+        memset(stream->data + size, 0, stream->size - size);
+    } else if (!gui_record_stream_reserve(stream, size)) {
+        return false;
+    }
+    stream->size = size;
+
+    const uint8_t *end = in + encoded_size;
+    uint32_t i = 0;
+    while (in < end) {
+        uint32_t zero_run;
+        uint32_t literal_count;
+        if (!gui_record_get_varint(&in, end, &zero_run) ||
+            !gui_record_get_varint(&in, end, &literal_count) || zero_run > size - i) {
+            return false;
+        }
+        i += zero_run;
+        if (literal_count > size - i || literal_count > (uint32_t)(end - in)) {
+            return false;
+        }
+        for (uint32_t j = 0; j < literal_count; j++) {
+            stream->data[i++] ^= *in++;
+        }
+    }
+    return true;
+}
+
+// =============================================================================
+// RECORDING
+// =============================================================================
+
+bool gui_record_open(gui_recorder_t *rec, const char *path, uint32_t flags) {
+    memset(rec, 0, sizeof(gui_recorder_t));
+    rec->file = fopen(path, "wb");
+    if (!rec->file) {
+        return false;
+    }
+    rec->flags = flags;
+
+    uint8_t header[GUI_RECORD_HEADER_SIZE];
+    uint32_t fields[5] = {GUI_RECORD_VERSION, flags, (uint32_t)sizeof(gui_input_t),
+                          (uint32_t)sizeof(gui_vertex_t), (uint32_t)sizeof(gui_draw_cmd_t)};
+    memcpy(header, GUI_RECORD_MAGIC, 8);
+    memcpy(header + 8, fields, sizeof(fields));
+    if (fwrite(header, 1, sizeof(header), rec->file) != sizeof(header)) {
+        fclose(rec->file);
+        rec->file = NULL;
+        return false;
+    }
+    rec->bytes_written = sizeof(header);
+    return true;
+}
+
+void gui_record_begin_frame(gui_recorder_t *rec, const gui_context_t *ctx) {
+    rec->input = ctx->input;
+    rec->delta_time = ctx->delta_time;
+    rec->input_captured = true;
+}
+
+bool gui_record_end_frame(gui_recorder_t *rec, const gui_context_t *ctx) {
+    if (!rec->file) {
+        return false;
+    }
+    if (!rec->input_captured) {
+        gui_record_begin_frame(rec, ctx); // Without a begin call the input is end-of-frame state
+    }
+    rec->input_captured = false;
+
+    const void *sources[GUI_RECORD_STREAM_COUNT] = {&rec->input, ctx->vertices, ctx->indices,
+                                                    ctx->draw_commands};
+    uint32_t sizes[GUI_RECORD_STREAM_COUNT] = {
+        (uint32_t)sizeof(gui_input_t), ctx->vertex_count * (uint32_t)sizeof(gui_vertex_t),
+        ctx->index_count * (uint32_t)sizeof(uint32_t),
+        ctx->draw_command_count * (uint32_t)sizeof(gui_draw_cmd_t)};
+    uint32_t stream_count = gui_record_stream_count(rec->flags);
+
+    uint32_t bound = 16U;
+    for (uint32_t s = 0; s < stream_count; s++) {
+        bound += 8U + gui_record_encode_bound(sizes[s]);
+    }
+    if (bound > rec->scratch_capacity) {
+        uint8_t *scratch = (uint8_t *)CGUI_REALLOC(rec->scratch, bound);
+        if (!scratch) {
+            return false;
+        }
+        rec->scratch = scratch;
+        rec->scratch_capacity = bound;
+    }
+
+    float frame_info[3] = {ctx->display_width, ctx->display_height, rec->delta_time};
+    uint8_t *cursor = rec->scratch + 4;
+    memcpy(cursor, frame_info, sizeof(frame_info));
+    cursor += sizeof(frame_info);
+    for (uint32_t s = 0; s < stream_count; s++) {
+        uint32_t encoded_size;
+        if (!gui_record_encode(&rec->streams[s], sources[s], sizes[s], cursor + 8,
+                               &encoded_size)) {
+            return false;
+        }
+        memcpy(cursor, &sizes[s], 4);
+        memcpy(cursor + 4, &encoded_size, 4);
+        cursor += 8U + encoded_size;
+    }
+
+    uint32_t frame_size = (uint32_t)(cursor - rec->scratch);
+    uint32_t payload_size = frame_size - 4U;
+    memcpy(rec->scratch, &payload_size, 4);
+    if (fwrite(rec->scratch, 1, frame_size, rec->file) != frame_size) {
+        return false;
+    }
+    rec->frame_count++;
+    rec->bytes_written += frame_size;
+    return true;
+}
+
+bool gui_record_close(gui_recorder_t *rec) {
+    bool ok = true;
+    if (rec->file) {
+        ok = fclose(rec->file) == 0;
+    }
+    for (int s = 0; s < GUI_RECORD_STREAM_COUNT; s++) {
+        gui_record_stream_free(&rec->streams[s]);
+    }
+    CGUI_FREE(rec->scratch);
+    memset(rec, 0, sizeof(gui_recorder_t));
+    return ok;
+}
+
+// =============================================================================
+// REPLAY
+// =============================================================================
+
+static bool gui_replay_map(gui_replay_t *replay, const char *path) {
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    LARGE_INTEGER size;
+    HANDLE mapping = NULL;
+    if (GetFileSizeEx(file, &size) && size.QuadPart > 0) {
+        mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    }
+    CloseHandle(file); // The mapping keeps the file open
+    if (!mapping) {
+        return false;
+    }
+    replay->data = (const uint8_t *)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!replay->data) {
+        CloseHandle(mapping);
+        return false;
+    }
+    replay->size = (size_t)size.QuadPart;
+    replay->map_handle = mapping;
+    return true;
+#else
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat info;
+    void *data = MAP_FAILED;
+    if (fstat(fd, &info) == 0 && info.st_size > 0) {
+        data = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    close(fd); // The mapping keeps the file open
+    if (data == MAP_FAILED) {
+        return false;
+    }
+    replay->data = (const uint8_t *)data;
+    replay->size = (size_t)info.st_size;
+    return true;
+#endif
+}
+
+static void gui_replay_unmap(gui_replay_t *replay) {
+    if (!replay->data) {
+        return;
+    }
+#ifdef _WIN32
+    UnmapViewOfFile(replay->data);
+    CloseHandle((HANDLE)replay->map_handle);
+#else
+    munmap((void *)replay->data, replay->size);
+#endif
+    replay->data = NULL;
+}
+
+bool gui_replay_open(gui_replay_t *replay, const char *path) {
+    memset(replay, 0, sizeof(gui_replay_t));
+    if (!gui_replay_map(replay, path)) {
+        return false;
+    }
+
+    uint32_t fields[5];
+    if (replay->size < GUI_RECORD_HEADER_SIZE || memcmp(replay->data, GUI_RECORD_MAGIC, 8) != 0) {
+        gui_replay_close(replay);
+        return false;
+    }
+    memcpy(fields, replay->data + 8, sizeof(fields));
+    if (fields[0] != GUI_RECORD_VERSION || fields[2] != sizeof(gui_input_t) ||
+        fields[3] != sizeof(gui_vertex_t) || fields[4] != sizeof(gui_draw_cmd_t)) {
+        gui_replay_close(replay);
+        return false;
+    }
+    replay->flags = fields[1];
+
+    // Count complete frames; a truncated tail (e.g. a crashed session) is ignored
+    size_t offset = GUI_RECORD_HEADER_SIZE;
+    while (replay->size - offset >= 4) {
+        uint32_t payload_size;
+        memcpy(&payload_size, replay->data + offset, 4);
+        if (payload_size > replay->size - offset - 4) {
+            break;
+        }
+        offset += 4U + payload_size;
+        replay->frame_count++;
+    }
+    replay->offset = GUI_RECORD_HEADER_SIZE;
+    return true;
+}
+
+bool gui_replay_next(gui_replay_t *replay) {
+    if (replay->frame_index >= replay->frame_count) {
+        return false;
+    }
+    uint32_t payload_size;
+    memcpy(&payload_size, replay->data + replay->offset, 4);
+    const uint8_t *cursor = replay->data + replay->offset + 4;
+    const uint8_t *end = cursor + payload_size;
+
+    float frame_info[3];
+    if (payload_size < sizeof(frame_info)) {
+        return false;
+    }
+    memcpy(frame_info, cursor, sizeof(frame_info));
+    cursor += sizeof(frame_info);
+    replay->display_width = frame_info[0];
+    replay->display_height = frame_info[1];
+    replay->delta_time = frame_info[2];
+
+    uint32_t stream_count = gui_record_stream_count(replay->flags);
+    for (uint32_t s = 0; s < stream_count; s++) {
+        uint32_t sizes[2]; // Raw, encoded
+        if ((size_t)(end - cursor) < sizeof(sizes)) {
+            return false;
+        }
+        memcpy(sizes, cursor, sizeof(sizes));
+        cursor += sizeof(sizes);
+        if (sizes[1] > (size_t)(end - cursor) ||
+            (s == GUI_RECORD_STREAM_INPUT && sizes[0] != sizeof(gui_input_t)) ||
+            !gui_record_decode(&replay->streams[s], sizes[0], cursor, sizes[1])) {
+            return false;
+        }
+        cursor += sizes[1];
+    }
+
+    replay->offset += 4U + payload_size;
+    replay->frame_index++;
+    return true;
+}
+
+void gui_replay_rewind(gui_replay_t *replay) {
+    replay->offset = GUI_RECORD_HEADER_SIZE;
+    replay->frame_index = 0;
+    for (int s = 0; s < GUI_RECORD_STREAM_COUNT; s++) {
+        gui_record_stream_reset(&replay->streams[s]);
+    }
+}
+
+void gui_replay_close(gui_replay_t *replay) {
+    gui_replay_unmap(replay);
+    for (int s = 0; s < GUI_RECORD_STREAM_COUNT; s++) {
+        gui_record_stream_free(&replay->streams[s]);
+    }
+    memset(replay, 0, sizeof(gui_replay_t));
+}
+
+void gui_replay_apply_input(const gui_replay_t *replay, gui_context_t *ctx) {
+    if (replay->streams[GUI_RECORD_STREAM_INPUT].size == sizeof(gui_input_t)) {
+        memcpy(&ctx->input, replay->streams[GUI_RECORD_STREAM_INPUT].data, sizeof(gui_input_t));
+    }
+    gui_update_time(ctx, replay->delta_time);
+}
+
+bool gui_replay_apply_draw_data(const gui_replay_t *replay, gui_context_t *ctx) {
+    if (!(replay->flags & GUI_RECORD_DRAW_DATA)) {
+        return false;
+    }
+    gui_record_load_draw_data(replay->streams, replay->map_texture, replay->user_data, ctx);
+    ctx->display_width = replay->display_width;
+    ctx->display_height = replay->display_height;
+    return true;
+}
+
+void gui_record_load_draw_data(const gui_record_stream_t *streams,
+                               gui_texture_id_t (*map_texture)(void *, gui_texture_id_t),
+                               void *user_data, gui_context_t *ctx) {
+    const gui_record_stream_t *vertices = &streams[GUI_RECORD_STREAM_VERTICES];
+    const gui_record_stream_t *indices = &streams[GUI_RECORD_STREAM_INDICES];
+    const gui_record_stream_t *commands = &streams[GUI_RECORD_STREAM_COMMANDS];
+
+    uint32_t vertex_count = vertices->size / (uint32_t)sizeof(gui_vertex_t);
+    uint32_t index_count = indices->size / (uint32_t)sizeof(uint32_t);
+    uint32_t command_count = commands->size / (uint32_t)sizeof(gui_draw_cmd_t);
+    ctx->vertex_count = vertex_count < CGUI_MAX_VERTICES ? vertex_count : CGUI_MAX_VERTICES;
+    ctx->index_count = index_count < CGUI_MAX_INDICES ? index_count : CGUI_MAX_INDICES;
+    ctx->draw_command_count =
+        command_count < CGUI_MAX_DRAW_COMMANDS ? command_count : CGUI_MAX_DRAW_COMMANDS;
+    if (ctx->vertex_count > 0) {
+        memcpy(ctx->vertices, vertices->data, ctx->vertex_count * sizeof(gui_vertex_t));
+    }
+    if (ctx->index_count > 0) {
+        memcpy(ctx->indices, indices->data, ctx->index_count * sizeof(uint32_t));
+    }
+    if (ctx->draw_command_count > 0) {
+        memcpy(ctx->draw_commands, commands->data,
+               ctx->draw_command_count * sizeof(gui_draw_cmd_t));
+    }
+
+    // Drop commands that reach past the clamped lists
+    uint32_t kept = 0;
+    for (uint32_t i = 0; i < ctx->draw_command_count; i++) {
+        gui_draw_cmd_t *cmd = &ctx->draw_commands[i];
+        if (cmd->idx_offset > ctx->index_count ||
+            cmd->elem_count > ctx->index_count - cmd->idx_offset) {
+            continue;
+        }
+        if (map_texture && cmd->texture && cmd->type == GUI_DRAW_CMD_TRIANGLES) {
+            cmd->texture = map_texture(user_data, cmd->texture);
+        }
+        ctx->draw_commands[kept++] = *cmd;
+    }
+    ctx->draw_command_count = kept;
+#ifdef CGUI_ENABLE_OPAQUE_PASS
+    ctx->opaque_index_count = 0; // Not recorded: the full list alone draws the frame
+    ctx->opaque_command_count = 0;
+#endif
+    for (uint32_t i = 0; i < ctx->index_count; i++) {
+        if (ctx->indices[i] >= ctx->vertex_count) {
+            ctx->indices[i] = 0; // Degenerate rather than read past the vertices
+        }
+    }
+}
+
+#endif // CGUI_RECORD_IMPLEMENTATION
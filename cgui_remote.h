@@ -0,0 +1,867 @@
+/*
+ * CGUI - Remote Rendering
+ * Streams each frame's draw data over TCP to a thin viewer that renders it with a backend, and
+ * sends the viewer's input events back into the application's input queue. Frames carry only
+ * the byte ranges that changed since the previous frame (the delta coder of cgui_record.h),
+ * compressed with a small LZ77 codec. The server sends a new frame only after the viewer has
+ * acknowledged the last one, so a slow link drops frames instead of queueing them. Once
+ * connected, neither side blocks the UI thread; gui_remote_client_connect itself waits until the
+ * server accepts or refuses the connection, so call it before entering the frame loop.
+ *
+ * Application (server), with sockets non-blocking:
+ *   gui_remote_server_poll before gui_begin_frame (accepts a viewer, queues its input),
+ *   gui_remote_server_send_frame after gui_end_frame.
+ *
+ * Viewer (client): gui_remote_client_poll each iteration; when it returns true,
+ * gui_remote_client_apply loads the frame into a context for the backend to render. Input is
+ * sent with gui_remote_client_send_event.
+ *
+ * Both sides must share struct layouts (the handshake checks them). Texture handles are sent as
+ * recorded; the viewer remaps them through map_texture or draws those commands untextured.
+ * Hosts are numeric IPv4 addresses or "localhost".
+ *
+ * The stream is neither authenticated nor encrypted: by default the server only listens on the
+ * loopback interface. Pass another address (e.g. "0.0.0.0") only on a trusted network.
+ *
+ * Usage (requires the cgui_record.h implementation in the program):
+ *   #define CGUI_REMOTE_IMPLEMENTATION
+ *   #include "cgui_remote.h"
+ * On Windows, include <windows.h> after <winsock2.h> or with WIN32_LEAN_AND_MEAN, and link
+ * ws2_32.
+ */
+
+#ifndef CGUI_REMOTE_H
+#define CGUI_REMOTE_H
+
+#include "cgui_record.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef CGUI_REMOTE_MAX_MESSAGE
+#define CGUI_REMOTE_MAX_MESSAGE (64U << 20) // Larger messages are a protocol error
+#endif
+
+#ifndef CGUI_REMOTE_LZ_HASH_BITS
+#define CGUI_REMOTE_LZ_HASH_BITS 14
+#endif
+
+// Byte buffer; offset is the sent (outgoing) or parsed (incoming) prefix
+typedef struct {
+    uint8_t *data;
+    uint32_t size;
+    uint32_t offset;
+    uint32_t capacity;
+} gui_remote_buffer_t;
+
+typedef struct {
+    intptr_t listen_socket;
+    intptr_t socket; // Connected viewer, -1 if none
+    bool connected;
+    bool awaiting_ack; // A frame is in flight
+
+    // Viewer framebuffer size, 0 until it is reported
+    float display_width;
+    float display_height;
+
+    gui_record_stream_t streams[GUI_RECORD_STREAM_COUNT]; // Last sent frame
+    uint8_t *frame;                                       // Delta-coded frame before compression
+    uint32_t frame_capacity;
+    gui_remote_buffer_t in;
+    gui_remote_buffer_t out;
+    uint32_t lz_table[1U << CGUI_REMOTE_LZ_HASH_BITS];
+
+    uint64_t frames_sent;
+    uint64_t raw_bytes;  // Draw data before coding
+    uint64_t sent_bytes; // After delta coding and compression
+} gui_remote_server_t;
+
+typedef struct {
+    intptr_t socket;
+    bool connected;
+    bool handshake_done;
+
+    // Application display size of the current frame
+    float display_width;
+    float display_height;
+
+    gui_record_stream_t streams[GUI_RECORD_STREAM_COUNT]; // Current frame
+    uint8_t *frame;                                       // Decompressed frame
+    uint32_t frame_capacity;
+    gui_remote_buffer_t in;
+    gui_remote_buffer_t out;
+    uint64_t frames_received;
+
+    // Optional remapping of the application's texture handles
+    gui_texture_id_t (*map_texture)(void *user_data, gui_texture_id_t remote);
+    void *user_data;
+} gui_remote_client_t;
+
+// Server. address NULL listens on loopback only; any other interface must be named explicitly
+// ("0.0.0.0" for all of them). Returns false when the port is unavailable.
+bool gui_remote_server_open(gui_remote_server_t *server, const char *address, uint16_t port);
+void gui_remote_server_poll(gui_remote_server_t *server, gui_context_t *ctx);
+bool gui_remote_server_send_frame(gui_remote_server_t *server, const gui_context_t *ctx);
+void gui_remote_server_close(gui_remote_server_t *server);
+
+// Client. gui_remote_client_connect blocks until the connection is established or refused;
+// gui_remote_client_poll returns true when a new frame was received; connected turns false when
+// the server goes away.
+bool gui_remote_client_connect(gui_remote_client_t *client, const char *host, uint16_t port);
+bool gui_remote_client_poll(gui_remote_client_t *client);
+void gui_remote_client_apply(const gui_remote_client_t *client, gui_context_t *ctx);
+bool gui_remote_client_send_event(gui_remote_client_t *client, const gui_input_event_t *event);
+bool gui_remote_client_send_display_size(gui_remote_client_t *client, float width,
+                                         float height);
+void gui_remote_client_close(gui_remote_client_t *client);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CGUI_REMOTE_H
+
+// =============================================================================
+// IMPLEMENTATION
+// =============================================================================
+
+#ifdef CGUI_REMOTE_IMPLEMENTATION
+
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#ifdef _MSC_VER
+#pragma comment(lib, "ws2_32")
+#endif
+#else
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+#ifndef CGUI_MALLOC
+#define CGUI_MALLOC(size) malloc(size)
+#define CGUI_CALLOC(count, size) calloc(count, size)
+#define CGUI_REALLOC(ptr, size) realloc(ptr, size)
+#define CGUI_FREE(ptr) free(ptr)
+#endif
+
+#if defined(MSG_NOSIGNAL)
+#define GUI_REMOTE_SEND_FLAGS MSG_NOSIGNAL
+#else
+#define GUI_REMOTE_SEND_FLAGS 0 // SO_NOSIGPIPE is set on the socket where available
+#endif
+
+// Messages: type and payload size (uint32, native endianness), then the payload.
+//   HELLO   server -> viewer: version, sizeof(gui_vertex_t), sizeof(gui_draw_cmd_t)
+//   FRAME   server -> viewer: raw size, then LZ data of: display width, height (float) and per
+//           draw stream (vertices, indices, commands) raw size, coded size, coded delta
+//   ACK     viewer -> server: frame received
+//   INPUT   viewer -> server: events of GUI_REMOTE_EVENT_SIZE bytes
+//   DISPLAY viewer -> server: framebuffer width, height (float)
+enum {
+    GUI_REMOTE_MSG_HELLO = 1,
+    GUI_REMOTE_MSG_FRAME,
+    GUI_REMOTE_MSG_ACK,
+    GUI_REMOTE_MSG_INPUT,
+    GUI_REMOTE_MSG_DISPLAY,
+};
+
+#define GUI_REMOTE_VERSION 1U
+#define GUI_REMOTE_HEADER_SIZE 8U
+#define GUI_REMOTE_EVENT_SIZE 20U // type, timestamp (double), two 4-byte fields
+#define GUI_REMOTE_RECV_CHUNK 65536U
+#define GUI_REMOTE_LZ_MIN_MATCH 6U // Shortest match cheaper than its token
+#define GUI_REMOTE_LZ_WINDOW 65535U
+
+// =============================================================================
+// LZ CODEC
+// =============================================================================
+
+// Tokens: literal count, literals, then (unless at the end) match distance and length minus
+// GUI_REMOTE_LZ_MIN_MATCH, all counts LEB128 (the varints of cgui_record.h)
+
+// A match token never costs more than the bytes it replaces, so only literal counts expand
+static uint32_t gui_remote_lz_bound(uint32_t size) { return size + (size / 16U) + 16U; }
+
+static uint32_t gui_remote_lz_hash(const uint8_t *p) {
+    uint32_t value;
+    memcpy(&value, p, 4);
+    return (value * 2654435761U) >> (32 - CGUI_REMOTE_LZ_HASH_BITS);
+}
+
+static uint8_t *gui_remote_lz_literals(uint8_t *out, const uint8_t *in, uint32_t count) {
+    out = gui_record_put_varint(out, count);
+    memcpy(out, in, count);
+    return out + count;
+}
+
+// table holds position + 1 of the last occurrence of each hashed 4-byte prefix
+static uint32_t gui_remote_lz_compress(uint32_t *table, const uint8_t *in, uint32_t size,
+                                       uint8_t *out) {
+    memset(table, 0, sizeof(uint32_t) << CGUI_REMOTE_LZ_HASH_BITS);
+    uint8_t *cursor = out;
+    uint32_t literal_start = 0;
+    uint32_t i = 0;
+    while (size >= GUI_REMOTE_LZ_MIN_MATCH && i <= size - GUI_REMOTE_LZ_MIN_MATCH) {
+        uint32_t hash = gui_remote_lz_hash(in + i);
+        uint32_t candidate = table[hash];
+        table[hash] = i + 1U;
+        if (candidate == 0 || i - (candidate - 1U) > GUI_REMOTE_LZ_WINDOW ||
+            memcmp(in + candidate - 1U, in + i, GUI_REMOTE_LZ_MIN_MATCH) != 0) {
+            i++;
+            continue;
+        }
+        uint32_t match = candidate - 1U;
+        uint32_t length = GUI_REMOTE_LZ_MIN_MATCH;
+        while (i + length < size && in[match + length] == in[i + length]) {
+            length++;
+        }
+        cursor = gui_remote_lz_literals(cursor, in + literal_start, i - literal_start);
+        cursor = gui_record_put_varint(cursor, i - match);
+        cursor = gui_record_put_varint(cursor, length - GUI_REMOTE_LZ_MIN_MATCH);
+        i += length;
+        literal_start = i;
+    }
+    cursor = gui_remote_lz_literals(cursor, in + literal_start, size - literal_start);
+    return (uint32_t)(cursor - out);
+}
+
+static bool gui_remote_lz_decompress(const uint8_t *in, uint32_t in_size, uint8_t *out,
+                                     uint32_t out_size) {
+    const uint8_t *end = in + in_size;
+    uint32_t written = 0;
+    for (;;) {
+        uint32_t literals;
+        if (!gui_record_get_varint(&in, end, &literals) || literals > out_size - written ||
+            literals > (uint32_t)(end - in)) {
+            return false;
+        }
+        memcpy(out + written, in, literals);
+        written += literals;
+        in += literals;
+        if (in == end) {
+            return written == out_size;
+        }
+
+        uint32_t distance;
+        uint32_t length;
+        if (!gui_record_get_varint(&in, end, &distance) ||
+            !gui_record_get_varint(&in, end, &length) || distance == 0 || distance > written ||
+            out_size - written < GUI_REMOTE_LZ_MIN_MATCH ||
+            length > out_size - written - GUI_REMOTE_LZ_MIN_MATCH) {
+            return false;
+        }
+        length += GUI_REMOTE_LZ_MIN_MATCH;
+        for (uint32_t j = 0; j < length; j++, written++) {
+            out[written] = out[written - distance]; // Overlapping copies repeat the pattern
+        }
+    }
+}
+
+// =============================================================================
+// SOCKETS
+// =============================================================================
+
+#define GUI_REMOTE_NO_SOCKET ((intptr_t)-1)
+
+#ifdef _WIN32
+#define GUI_REMOTE_FD(socket_handle) ((SOCKET)(socket_handle))
+#else
+#define GUI_REMOTE_FD(socket_handle) ((int)(socket_handle))
+#endif
+
+static bool gui_remote_startup(void) {
+#ifdef _WIN32
+    WSADATA data;
+    return WSAStartup(MAKEWORD(2, 2), &data) == 0;
+#else
+    return true;
+#endif
+}
+
+static void gui_remote_cleanup(void) {
+#ifdef _WIN32
+    WSACleanup();
+#endif
+}
+
+static void gui_remote_close_socket(intptr_t socket_handle) {
+    if (socket_handle == GUI_REMOTE_NO_SOCKET) {
+        return;
+    }
+#ifdef _WIN32
+    closesocket(GUI_REMOTE_FD(socket_handle));
+#else
+    close(GUI_REMOTE_FD(socket_handle));
+#endif
+}
+
+static bool gui_remote_would_block(void) {
+#ifdef _WIN32
+    return WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+    return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+#endif
+}
+
+// Non-blocking, no Nagle delay, no SIGPIPE
+static bool gui_remote_configure_socket(intptr_t socket_handle) {
+    const char *one = (const char *)&(int){1};
+    setsockopt(GUI_REMOTE_FD(socket_handle), IPPROTO_TCP, TCP_NODELAY, one, sizeof(int));
+#ifdef SO_NOSIGPIPE
+    setsockopt(GUI_REMOTE_FD(socket_handle), SOL_SOCKET, SO_NOSIGPIPE, one, sizeof(int));
+#endif
+#ifdef _WIN32
+    u_long mode = 1;
+    return ioctlsocket(GUI_REMOTE_FD(socket_handle), FIONBIO, &mode) == 0;
+#else
+    int flags = fcntl(GUI_REMOTE_FD(socket_handle), F_GETFL, 0);
+    return flags >= 0 && fcntl(GUI_REMOTE_FD(socket_handle), F_SETFL, flags | O_NONBLOCK) == 0;
+#endif
+}
+
+static bool gui_remote_parse_address(struct sockaddr_in *addr, const char *host, uint16_t port) {
+    memset(addr, 0, sizeof(struct sockaddr_in));
+    addr->sin_family = AF_INET;
+    addr->sin_port = htons(port);
+    if (!host) {
+        addr->sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        return true;
+    }
+    if (strcmp(host, "localhost") == 0) {
+        host = "127.0.0.1";
+    }
+    return inet_pton(AF_INET, host, &addr->sin_addr) == 1;
+}
+
+static bool gui_remote_buffer_reserve(gui_remote_buffer_t *buffer, uint32_t size) {
+    if (size <= buffer->capacity) {
+        return true;
+    }
+    if (size > 2U * CGUI_REMOTE_MAX_MESSAGE) {
+        return false;
+    }
+    uint32_t capacity = buffer->capacity ? buffer->capacity : 4096U;
+    while (capacity < size) {
+        capacity *= 2U;
+    }
+    uint8_t *data = (uint8_t *)CGUI_REALLOC(buffer->data, capacity);
+    if (!data) {
+        return false;
+    }
+    buffer->data = data;
+    buffer->capacity = capacity;
+    return true;
+}
+
+static void gui_remote_buffer_free(gui_remote_buffer_t *buffer) {
+    CGUI_FREE(buffer->data);
+    memset(buffer, 0, sizeof(gui_remote_buffer_t));
+}
+
+// Appends a message header and returns where size bytes of payload go, NULL on overflow
+static uint8_t *gui_remote_queue(gui_remote_buffer_t *out, uint32_t type, uint32_t size) {
+    if (size > CGUI_REMOTE_MAX_MESSAGE ||
+        !gui_remote_buffer_reserve(out, out->size + GUI_REMOTE_HEADER_SIZE + size)) {
+        return NULL;
+    }
+    uint8_t *header = out->data + out->size;
+    memcpy(header, &type, 4);
+    memcpy(header + 4, &size, 4);
+    out->size += GUI_REMOTE_HEADER_SIZE + size;
+    return header + GUI_REMOTE_HEADER_SIZE;
+}
+
+// Sends what the socket accepts; false when the connection failed
+static bool gui_remote_flush(intptr_t socket_handle, gui_remote_buffer_t *out) {
+    while (out->offset < out->size) {
+        long sent = (long)send(GUI_REMOTE_FD(socket_handle), (const char *)out->data + out->offset,
+                               (int)(out->size - out->offset), GUI_REMOTE_SEND_FLAGS);
+        if (sent < 0) {
+            return gui_remote_would_block();
+        }
+        out->offset += (uint32_t)sent;
+    }
+    out->size = 0;
+    out->offset = 0;
+    return true;
+}
+
+// Reads what is available; false when the peer closed or the connection failed
+static bool gui_remote_receive(intptr_t socket_handle, gui_remote_buffer_t *in) {
+    for (;;) {
+        if (!gui_remote_buffer_reserve(in, in->size + GUI_REMOTE_RECV_CHUNK)) {
+            return false;
+        }
+        long received = (long)recv(GUI_REMOTE_FD(socket_handle), (char *)in->data + in->size,
+                                   (int)GUI_REMOTE_RECV_CHUNK, 0);
+        if (received > 0) {
+            in->size += (uint32_t)received;
+        } else if (received == 0) {
+            return false;
+        } else {
+            return gui_remote_would_block();
+        }
+    }
+}
+
+// Next complete message of in; false when none is complete or *error is set
+static bool gui_remote_next_message(gui_remote_buffer_t *in, uint32_t *type,
+                                    const uint8_t **payload, uint32_t *size, bool *error) {
+    if (in->size - in->offset < GUI_REMOTE_HEADER_SIZE) {
+        return false;
+    }
+    memcpy(type, in->data + in->offset, 4);
+    memcpy(size, in->data + in->offset + 4, 4);
+    if (*size > CGUI_REMOTE_MAX_MESSAGE) {
+        *error = true;
+        return false;
+    }
+    if (in->size - in->offset - GUI_REMOTE_HEADER_SIZE < *size) {
+        return false;
+    }
+    *payload = in->data + in->offset + GUI_REMOTE_HEADER_SIZE;
+    in->offset += GUI_REMOTE_HEADER_SIZE + *size;
+    return true;
+}
+
+// Drops parsed messages, keeping a partial one at the front
+static void gui_remote_compact(gui_remote_buffer_t *in) {
+    if (in->offset > 0) {
+        memmove(in->data, in->data + in->offset, in->size - in->offset);
+        in->size -= in->offset;
+        in->offset = 0;
+    }
+}
+
+// =============================================================================
+// SERVER
+// =============================================================================
+
+static void gui_remote_server_disconnect(gui_remote_server_t *server) {
+    gui_remote_close_socket(server->socket);
+    server->socket = GUI_REMOTE_NO_SOCKET;
+    server->connected = false;
+    server->awaiting_ack = false;
+    server->in.size = server->in.offset = 0;
+    server->out.size = server->out.offset = 0;
+}
+
+bool gui_remote_server_open(gui_remote_server_t *server, const char *address, uint16_t port) {
+    memset(server, 0, sizeof(gui_remote_server_t));
+    server->listen_socket = GUI_REMOTE_NO_SOCKET;
+    server->socket = GUI_REMOTE_NO_SOCKET;
+    if (!gui_remote_startup()) {
+        return false;
+    }
+
+    struct sockaddr_in addr;
+    intptr_t listen_socket = (intptr_t)socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (listen_socket == GUI_REMOTE_NO_SOCKET) {
+        gui_remote_cleanup();
+        return false;
+    }
+    server->listen_socket = listen_socket;
+    const char *one = (const char *)&(int){1};
+    setsockopt(GUI_REMOTE_FD(listen_socket), SOL_SOCKET, SO_REUSEADDR, one, sizeof(int));
+    if (!gui_remote_parse_address(&addr, address, port) ||
+        bind(GUI_REMOTE_FD(listen_socket), (const struct sockaddr *)&addr, sizeof(addr)) != 0 ||
+        listen(GUI_REMOTE_FD(listen_socket), 1) != 0 ||
+        !gui_remote_configure_socket(listen_socket)) {
+        gui_remote_server_close(server);
+        return false;
+    }
+    return true;
+}
+
+static void gui_remote_server_accept(gui_remote_server_t *server) {
+    intptr_t socket_handle = (intptr_t)accept(GUI_REMOTE_FD(server->listen_socket), NULL, NULL);
+    if (socket_handle == GUI_REMOTE_NO_SOCKET) {
+        return;
+    }
+    if (!gui_remote_configure_socket(socket_handle)) {
+        gui_remote_close_socket(socket_handle);
+        return;
+    }
+    server->socket = socket_handle;
+    server->connected = true;
+    server->display_width = 0.0F;
+    server->display_height = 0.0F;
+
+    // A new viewer has no reference frame
+    for (int s = 0; s < GUI_RECORD_STREAM_COUNT; s++) {
+        gui_record_stream_reset(&server->streams[s]);
+    }
+    uint32_t hello[3] = {GUI_REMOTE_VERSION, (uint32_t)sizeof(gui_vertex_t),
+                         (uint32_t)sizeof(gui_draw_cmd_t)};
+    uint8_t *payload = gui_remote_queue(&server->out, GUI_REMOTE_MSG_HELLO, sizeof(hello));
+    if (payload) {
+        memcpy(payload, hello, sizeof(hello));
+    }
+}
+
+static void gui_remote_server_input(gui_context_t *ctx, const uint8_t *payload, uint32_t size) {
+    for (uint32_t offset = 0; offset + GUI_REMOTE_EVENT_SIZE <= size;
+         offset += GUI_REMOTE_EVENT_SIZE) {
+        const uint8_t *wire = payload + offset;
+        uint32_t type;
+        uint32_t a;
+        uint32_t b;
+        gui_input_event_t event;
+        memset(&event, 0, sizeof(event));
+        memcpy(&type, wire, 4);
+        memcpy(&event.timestamp, wire + 4, 8);
+        memcpy(&a, wire + 12, 4);
+        memcpy(&b, wire + 16, 4);
+        event.type = (gui_input_event_type_t)type;
+        switch (event.type) {
+        case GUI_INPUT_EVENT_MOUSE_POS:
+            memcpy(&event.mouse_pos.x, &a, 4);
+            memcpy(&event.mouse_pos.y, &b, 4);
+            break;
+        case GUI_INPUT_EVENT_MOUSE_BUTTON:
+            event.mouse_button.button = (int)a;
+            event.mouse_button.down = b != 0;
+            break;
+        case GUI_INPUT_EVENT_MOUSE_WHEEL:
+            memcpy(&event.mouse_wheel.x, &a, 4);
+            memcpy(&event.mouse_wheel.y, &b, 4);
+            break;
+        case GUI_INPUT_EVENT_KEY:
+            event.key.key = (int)a;
+            event.key.down = b != 0;
+            break;
+        case GUI_INPUT_EVENT_TEXT:
+            event.codepoint = a;
+            break;
+        default:
+            continue;
+        }
+        gui_input_push_event(ctx, &event);
+    }
+}
+
+void gui_remote_server_poll(gui_remote_server_t *server, gui_context_t *ctx) {
+    if (!server->connected) {
+        gui_remote_server_accept(server);
+        if (!server->connected) {
+            return;
+        }
+    }
+    if (!gui_remote_flush(server->socket, &server->out) ||
+        !gui_remote_receive(server->socket, &server->in)) {
+        gui_remote_server_disconnect(server);
+        return;
+    }
+
+    uint32_t type;
+    uint32_t size;
+    const uint8_t *payload;
+    bool error = false;
+    while (gui_remote_next_message(&server->in, &type, &payload, &size, &error)) {
+        if (type == GUI_REMOTE_MSG_ACK) {
+            server->awaiting_ack = false;
+        } else if (type == GUI_REMOTE_MSG_INPUT) {
+            gui_remote_server_input(ctx, payload, size);
+        } else if (type == GUI_REMOTE_MSG_DISPLAY && size == 8) {
+            memcpy(&server->display_width, payload, 4);
+            memcpy(&server->display_height, payload + 4, 4);
+        }
+    }
+    if (error) {
+        gui_remote_server_disconnect(server);
+        return;
+    }
+    gui_remote_compact(&server->in);
+}
+
+bool gui_remote_server_send_frame(gui_remote_server_t *server, const gui_context_t *ctx) {
+    if (!server->connected || server->awaiting_ack || server->out.size > 0) {
+        return false; // Skipped; the next frame is coded against the last one sent
+    }
+
+    const void *sources[3] = {ctx->vertices, ctx->indices, ctx->draw_commands};
+    uint32_t sizes[3] = {ctx->vertex_count * (uint32_t)sizeof(gui_vertex_t),
+                         ctx->index_count * (uint32_t)sizeof(uint32_t),
+                         ctx->draw_command_count * (uint32_t)sizeof(gui_draw_cmd_t)};
+    uint32_t bound = 8U;
+    for (int s = 0; s < 3; s++) {
+        bound += 8U + gui_record_encode_bound(sizes[s]);
+    }
+    if (bound > server->frame_capacity) {
+        uint8_t *frame = (uint8_t *)CGUI_REALLOC(server->frame, bound);
+        if (!frame) {
+            return false;
+        }
+        server->frame = frame;
+        server->frame_capacity = bound;
+    }
+
+    float display[2] = {ctx->display_width, ctx->display_height};
+    uint8_t *cursor = server->frame;
+    memcpy(cursor, display, sizeof(display));
+    cursor += sizeof(display);
+    for (int s = 0; s < 3; s++) {
+        uint32_t encoded_size;
+        if (!gui_record_encode(&server->streams[GUI_RECORD_STREAM_VERTICES + s], sources[s],
+                               sizes[s], cursor + 8, &encoded_size)) {
+            gui_remote_server_disconnect(server); // The viewer's reference is now unknown
+            return false;
+        }
+        memcpy(cursor, &sizes[s], 4);
+        memcpy(cursor + 4, &encoded_size, 4);
+        cursor += 8U + encoded_size;
+        server->raw_bytes += sizes[s];
+    }
+
+    uint32_t raw_size = (uint32_t)(cursor - server->frame);
+    uint8_t *payload =
+        gui_remote_queue(&server->out, GUI_REMOTE_MSG_FRAME, 4U + gui_remote_lz_bound(raw_size));
+    if (!payload) {
+        gui_remote_server_disconnect(server);
+        return false;
+    }
+    uint32_t compressed_size =
+        gui_remote_lz_compress(server->lz_table, server->frame, raw_size, payload + 4);
+    uint32_t message_size = 4U + compressed_size;
+    memcpy(payload, &raw_size, 4);
+    memcpy(payload - 4, &message_size, 4); // Patch the header with the actual size
+    server->out.size = (uint32_t)(payload - server->out.data) + message_size;
+
+    server->awaiting_ack = true;
+    server->frames_sent++;
+    server->sent_bytes += GUI_REMOTE_HEADER_SIZE + message_size;
+    if (!gui_remote_flush(server->socket, &server->out)) {
+        gui_remote_server_disconnect(server);
+        return false;
+    }
+    return true;
+}
+
+void gui_remote_server_close(gui_remote_server_t *server) {
+    gui_remote_server_disconnect(server);
+    if (server->listen_socket != GUI_REMOTE_NO_SOCKET) {
+        gui_remote_close_socket(server->listen_socket);
+        gui_remote_cleanup();
+    }
+    for (int s = 0; s < GUI_RECORD_STREAM_COUNT; s++) {
+        gui_record_stream_free(&server->streams[s]);
+    }
+    CGUI_FREE(server->frame);
+    gui_remote_buffer_free(&server->in);
+    gui_remote_buffer_free(&server->out);
+    memset(server, 0, sizeof(gui_remote_server_t));
+    server->listen_socket = GUI_REMOTE_NO_SOCKET;
+    server->socket = GUI_REMOTE_NO_SOCKET;
+}
+
+// =============================================================================
+// CLIENT
+// =============================================================================
+
+bool gui_remote_client_connect(gui_remote_client_t *client, const char *host, uint16_t port) {
+    memset(client, 0, sizeof(gui_remote_client_t));
+    client->socket = GUI_REMOTE_NO_SOCKET;
+    struct sockaddr_in addr;
+    if (!host || !gui_remote_parse_address(&addr, host, port) || !gui_remote_startup()) {
+        return false;
+    }
+    intptr_t socket_handle = (intptr_t)socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (socket_handle == GUI_REMOTE_NO_SOCKET) {
+        gui_remote_cleanup();
+        return false;
+    }
+    // Connect blocking, then switch to non-blocking I/O
+    if (connect(GUI_REMOTE_FD(socket_handle), (const struct sockaddr *)&addr, sizeof(addr)) != 0 ||
+        !gui_remote_configure_socket(socket_handle)) {
+        gui_remote_close_socket(socket_handle);
+        gui_remote_cleanup();
+        return false;
+    }
+    client->socket = socket_handle;
+    client->connected = true;
+    return true;
+}
+
+static void gui_remote_client_disconnect(gui_remote_client_t *client) {
+    if (client->connected) {
+        gui_remote_close_socket(client->socket);
+        gui_remote_cleanup();
+    }
+    client->socket = GUI_REMOTE_NO_SOCKET;
+    client->connected = false;
+}
+
+static bool gui_remote_client_frame(gui_remote_client_t *client, const uint8_t *payload,
+                                    uint32_t size) {
+    uint32_t raw_size;
+    if (size < 4) {
+        return false;
+    }
+    memcpy(&raw_size, payload, 4);
+    if (raw_size > CGUI_REMOTE_MAX_MESSAGE || raw_size < 8U) {
+        return false;
+    }
+    if (raw_size > client->frame_capacity) {
+        uint8_t *frame = (uint8_t *)CGUI_REALLOC(client->frame, raw_size);
+        if (!frame) {
+            return false;
+        }
+        client->frame = frame;
+        client->frame_capacity = raw_size;
+    }
+    if (!gui_remote_lz_decompress(payload + 4, size - 4U, client->frame, raw_size)) {
+        return false;
+    }
+
+    const uint8_t *cursor = client->frame;
+    const uint8_t *end = client->frame + raw_size;
+    float display[2];
+    memcpy(display, cursor, sizeof(display));
+    cursor += sizeof(display);
+    for (int s = 0; s < 3; s++) {
+        uint32_t sizes[2]; // Raw, encoded
+        if ((size_t)(end - cursor) < sizeof(sizes)) {
+            return false;
+        }
+        memcpy(sizes, cursor, sizeof(sizes));
+        cursor += sizeof(sizes);
+        if (sizes[1] > (size_t)(end - cursor) ||
+            !gui_record_decode(&client->streams[GUI_RECORD_STREAM_VERTICES + s], sizes[0],
+                               cursor, sizes[1])) {
+            return false;
+        }
+        cursor += sizes[1];
+    }
+    client->display_width = display[0];
+    client->display_height = display[1];
+    client->frames_received++;
+    return gui_remote_queue(&client->out, GUI_REMOTE_MSG_ACK, 0) != NULL;
+}
+
+bool gui_remote_client_poll(gui_remote_client_t *client) {
+    if (!client->connected) {
+        return false;
+    }
+    if (!gui_remote_receive(client->socket, &client->in)) {
+        gui_remote_client_disconnect(client);
+        return false;
+    }
+
+    bool new_frame = false;
+    bool error = false;
+    uint32_t type;
+    uint32_t size;
+    const uint8_t *payload;
+    while (!error && gui_remote_next_message(&client->in, &type, &payload, &size, &error)) {
+        if (type == GUI_REMOTE_MSG_HELLO) {
+            uint32_t hello[3];
+            error = size != sizeof(hello);
+            if (!error) {
+                memcpy(hello, payload, sizeof(hello));
+                error = hello[0] != GUI_REMOTE_VERSION || hello[1] != sizeof(gui_vertex_t) ||
+                        hello[2] != sizeof(gui_draw_cmd_t);
+            }
+            client->handshake_done = !error;
+        } else if (type == GUI_REMOTE_MSG_FRAME) {
+            error = !client->handshake_done || !gui_remote_client_frame(client, payload, size);
+            new_frame = new_frame || !error;
+        }
+    }
+    if (error || !gui_remote_flush(client->socket, &client->out)) {
+        gui_remote_client_disconnect(client);
+        return false;
+    }
+    gui_remote_compact(&client->in);
+    return new_frame;
+}
+
+void gui_remote_client_apply(const gui_remote_client_t *client, gui_context_t *ctx) {
+    gui_record_load_draw_data(client->streams, client->map_texture, client->user_data, ctx);
+    if (!client->map_texture) {
+        // Handles of the application's process mean nothing here (layer commands carry IDs)
+        for (uint32_t i = 0; i < ctx->draw_command_count; i++) {
+            if (ctx->draw_commands[i].type == GUI_DRAW_CMD_TRIANGLES) {
+                ctx->draw_commands[i].texture = NULL;
+            }
+        }
+    }
+    ctx->display_width = client->display_width;
+    ctx->display_height = client->display_height;
+}
+
+bool gui_remote_client_send_event(gui_remote_client_t *client, const gui_input_event_t *event) {
+    if (!client->connected) {
+        return false;
+    }
+    uint32_t type = (uint32_t)event->type;
+    uint32_t a = 0;
+    uint32_t b = 0;
+    switch (event->type) {
+    case GUI_INPUT_EVENT_MOUSE_POS:
+        memcpy(&a, &event->mouse_pos.x, 4);
+        memcpy(&b, &event->mouse_pos.y, 4);
+        break;
+    case GUI_INPUT_EVENT_MOUSE_BUTTON:
+        a = (uint32_t)event->mouse_button.button;
+        b = event->mouse_button.down ? 1U : 0U;
+        break;
+    case GUI_INPUT_EVENT_MOUSE_WHEEL:
+        memcpy(&a, &event->mouse_wheel.x, 4);
+        memcpy(&b, &event->mouse_wheel.y, 4);
+        break;
+    case GUI_INPUT_EVENT_KEY:
+        a = (uint32_t)event->key.key;
+        b = event->key.down ? 1U : 0U;
+        break;
+    case GUI_INPUT_EVENT_TEXT:
+        a = event->codepoint;
+        break;
+    }
+    uint8_t *wire = gui_remote_queue(&client->out, GUI_REMOTE_MSG_INPUT, GUI_REMOTE_EVENT_SIZE);
+    if (!wire) {
+        return false;
+    }
+    memcpy(wire, &type, 4);
+    memcpy(wire + 4, &event->timestamp, 8);
+    memcpy(wire + 12, &a, 4);
+    memcpy(wire + 16, &b, 4);
+    return true; // Sent by the next poll
+}
+
+bool gui_remote_client_send_display_size(gui_remote_client_t *client, float width,
+                                         float height) {
+    if (!client->connected) {
+        return false;
+    }
+    float display[2] = {width, height};
+    uint8_t *payload = gui_remote_queue(&client->out, GUI_REMOTE_MSG_DISPLAY, sizeof(display));
+    if (!payload) {
+        return false;
+    }
+    memcpy(payload, display, sizeof(display));
+    return true;
+}
+
+void gui_remote_client_close(gui_remote_client_t *client) {
+    gui_remote_client_disconnect(client);
+    for (int s = 0; s < GUI_RECORD_STREAM_COUNT; s++) {
+        gui_record_stream_free(&client->streams[s]);
+    }
+    CGUI_FREE(client->frame);
+    gui_remote_buffer_free(&client->in);
+    gui_remote_buffer_free(&client->out);
+    memset(client, 0, sizeof(gui_remote_client_t));
+    client->socket = GUI_REMOTE_NO_SOCKET;
+}
+
+#endif // CGUI_REMOTE_IMPLEMENTATION
@@ -5,6 +5,7 @@
 
 #include <stdint.h>
 #ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN // Leaves winsock2.h to cgui_remote.h
 #include <windows.h>
 #endif
 #include <GL/gl.h>
@@ -14,39 +15,214 @@
 #define CGUI_BACKEND_GL_IMPLEMENTATION
 #include "cgui_backend_gl.h"
 
+#define CGUI_RECORD_IMPLEMENTATION
+#include "cgui_record.h"
+
+#define CGUI_REMOTE_IMPLEMENTATION
+#include "cgui_remote.h"
+
 #include <GLFW/glfw3.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
 // Global state
 static gui_context_t gui_ctx;
 static gui_backend_gl_t backend;
-static bool mouse_buttons[3] = {false, false, false};
 static float last_time = 0.0F;
 
 // Demo state
 static float slider_value = 0.5F;
 static int button_click_count = 0;
 
+// Table demo state
+#define DEMO_TABLE_ROWS 100000
+#define DEMO_TABLE_COLUMNS 100
+static gui_table_column_t table_columns[DEMO_TABLE_COLUMNS];
+static char table_column_labels[DEMO_TABLE_COLUMNS][16];
+static int table_order[DEMO_TABLE_ROWS];
+static bool table_descending = false;
+
+static const char *table_cell_text(void *user_data, int row, int column, char *buf,
+                                   size_t buf_size) {
+    (void)user_data;
+    snprintf(buf, buf_size, "%d", (row * DEMO_TABLE_COLUMNS) + column);
+    return buf;
+}
+
+// Plot demo state (ring buffer fed every frame)
+#define DEMO_PLOT_CAPACITY 100000
+static float plot_ring[DEMO_PLOT_CAPACITY];
+static uint64_t plot_total = 0;
+
+// Log demo state (ring buffer of text lines, viewed in place)
+#define DEMO_LOG_CAPACITY 65536
+static char log_ring[DEMO_LOG_CAPACITY];
+static uint64_t log_total = 0;
+
+static void demo_log(const char *line) {
+    for (const char *c = line; *c; c++, log_total++) {
+        log_ring[log_total % DEMO_LOG_CAPACITY] = *c;
+    }
+    log_ring[log_total++ % DEMO_LOG_CAPACITY] = '\n';
+}
+
+// Heatmap demo state (streamed to a texture every frame)
+#define DEMO_HEATMAP_SIZE 128
+static gui_texture_id_t heatmap_texture = NULL;
+
+static void heatmap_stream(float time) {
+    uint8_t *pixels = (uint8_t *)gui_backend_gl_stream_begin(&backend, heatmap_texture, 0, 0,
+                                                             DEMO_HEATMAP_SIZE, DEMO_HEATMAP_SIZE);
+    static uint8_t fallback[DEMO_HEATMAP_SIZE * DEMO_HEATMAP_SIZE * 4];
+    uint8_t *out = pixels ? pixels : fallback;
+
+    for (int y = 0; y < DEMO_HEATMAP_SIZE; y++) {
+        for (int x = 0; x < DEMO_HEATMAP_SIZE; x++) {
+            float v = 0.5F + (0.25F * sinf(((float)x * 0.11F) + time)) +
+                      (0.25F * cosf(((float)y * 0.07F) - (time * 1.3F)));
+            uint8_t *p = &out[((y * DEMO_HEATMAP_SIZE) + x) * 4];
+            p[0] = (uint8_t)(v * 255.0F);
+            p[1] = (uint8_t)((1.0F - fabsf((v * 2.0F) - 1.0F)) * 255.0F);
+            p[2] = (uint8_t)((1.0F - v) * 255.0F);
+            p[3] = 255;
+        }
+    }
+
+    if (pixels) {
+        gui_backend_gl_stream_end(&backend);
+    } else {
+        gui_backend_gl_update_texture(&backend, heatmap_texture, 0, 0, DEMO_HEATMAP_SIZE,
+                                      DEMO_HEATMAP_SIZE, fallback);
+    }
+}
+
+// Toolbar icons, packed into one atlas page so they draw without texture switches
+#define DEMO_ICON_COUNT 6
+#define DEMO_ICON_SIZE 24
+static gui_atlas_t icon_atlas;
+static int icons[DEMO_ICON_COUNT];
+
+static void icons_build(void) {
+    static uint8_t pixels[DEMO_ICON_SIZE * DEMO_ICON_SIZE * 4];
+    gui_atlas_init(&icon_atlas, 256, 256, 1);
+    for (int i = 0; i < DEMO_ICON_COUNT; i++) {
+        // Discs of a different color each, fading out at the edge
+        float center = DEMO_ICON_SIZE * 0.5F;
+        for (int y = 0; y < DEMO_ICON_SIZE; y++) {
+            for (int x = 0; x < DEMO_ICON_SIZE; x++) {
+                float d = hypotf((float)x + 0.5F - center, (float)y + 0.5F - center);
+                uint8_t *p = &pixels[((y * DEMO_ICON_SIZE) + x) * 4];
+                p[0] = (uint8_t)(i & 1 ? 230 : 60);
+                p[1] = (uint8_t)(i & 2 ? 200 : 90);
+                p[2] = (uint8_t)(i & 4 ? 80 : 220);
+                p[3] = (uint8_t)(fminf(fmaxf(center - d, 0.0F), 1.0F) * 255.0F);
+            }
+        }
+        icons[i] = gui_atlas_add(&icon_atlas, DEMO_ICON_SIZE, DEMO_ICON_SIZE, pixels);
+    }
+    gui_backend_gl_upload_atlas(&backend, &icon_atlas);
+}
+
+static void icons_free(void) {
+    gui_backend_gl_destroy_atlas(&backend, &icon_atlas);
+    gui_atlas_free(&icon_atlas);
+}
+
+static void table_sort(bool descending) {
+    // Every column grows with the row index, so sorting only flips the permutation
+    for (int i = 0; i < DEMO_TABLE_ROWS; i++) {
+        table_order[i] = descending ? DEMO_TABLE_ROWS - 1 - i : i;
+    }
+    table_descending = descending;
+}
+
 void error_callback(int error, const char *description) {
     fprintf(stderr, "GLFW Error %d: %s\n", error, description);
 }
 
+// Input callbacks push timestamped events; gui_begin_frame drains them
+void cursor_pos_callback(GLFWwindow *window, double xpos, double ypos) {
+    (void)window;
+    gui_input_add_mouse_pos(&gui_ctx, (float)xpos, (float)ypos, glfwGetTime());
+}
+
 void mouse_button_callback(GLFWwindow *window, int button, int action, int mods) {
     (void)window;
     (void)mods;
-
-    if (button >= 0 && button < 3) {
-        mouse_buttons[button] = (action == GLFW_PRESS);
-    }
+    gui_input_add_mouse_button(&gui_ctx, button, action == GLFW_PRESS, glfwGetTime());
 }
 
 void scroll_callback(GLFWwindow *window, double xoffset, double yoffset) {
     (void)window;
-    (void)xoffset;
-    gui_ctx.input.mouse_wheel = (float)yoffset;
+    gui_input_add_mouse_wheel(&gui_ctx, (float)xoffset, (float)yoffset, glfwGetTime());
+}
+
+void key_callback(GLFWwindow *window, int key, int scancode, int action, int mods) {
+    (void)window;
+    (void)scancode;
+    (void)mods;
+    // Repeats arrive as further presses
+    gui_input_add_key(&gui_ctx, key, action != GLFW_RELEASE, glfwGetTime());
+}
+
+void char_callback(GLFWwindow *window, unsigned int codepoint) {
+    (void)window;
+    gui_input_add_text(&gui_ctx, codepoint, glfwGetTime());
+}
+
+// Renders a recorded session through the backend only, as fast as possible
+static int replay_session(GLFWwindow *window, const char *path) {
+    gui_replay_t replay;
+    if (!gui_replay_open(&replay, path)) {
+        fprintf(stderr, "Failed to open recording %s\n", path);
+        return -1;
+    }
+    if (!(replay.flags & GUI_RECORD_DRAW_DATA)) {
+        fprintf(stderr, "%s has no draw data (record with --record)\n", path);
+        gui_replay_close(&replay);
+        return -1;
+    }
+
+    glfwSwapInterval(0);
+    double start = glfwGetTime();
+    uint32_t frames = 0;
+    while (!glfwWindowShouldClose(window) && gui_replay_next(&replay)) {
+        glfwPollEvents();
+        gui_replay_apply_draw_data(&replay, &gui_ctx);
+        glClearColor(0.1F, 0.1F, 0.15F, 1.0F);
+        glClear(GL_COLOR_BUFFER_BIT);
+        gui_backend_gl_render(&backend, &gui_ctx);
+        glfwSwapBuffers(window);
+        frames++;
+    }
+    double elapsed = glfwGetTime() - start;
+    printf("Replayed %u/%u frames in %.3f s (%.3f ms/frame)\n", frames, replay.frame_count,
+           elapsed, frames ? elapsed * 1000.0 / frames : 0.0);
+    gui_replay_close(&replay);
+    return 0;
 }
 
-int main(void) {
+int main(int argc, char **argv) {
+    // --record FILE captures input and draw data, --replay FILE renders a capture,
+    // --serve PORT streams frames to cgui_viewer on this machine; --serve-address ADDR listens on
+    // another interface instead (the stream is unauthenticated, so only on trusted networks)
+    const char *record_path = NULL;
+    const char *replay_path = NULL;
+    const char *serve_address = "127.0.0.1";
+    int serve_port = 0;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (strcmp(argv[i], "--record") == 0) {
+            record_path = argv[i + 1];
+        } else if (strcmp(argv[i], "--replay") == 0) {
+            replay_path = argv[i + 1];
+        } else if (strcmp(argv[i], "--serve") == 0) {
+            serve_port = atoi(argv[i + 1]);
+        } else if (strcmp(argv[i], "--serve-address") == 0) {
+            serve_address = argv[i + 1];
+        }
+    }
+
     // Initialize GLFW
     glfwSetErrorCallback(error_callback);
 
@@ -71,12 +247,23 @@ int main(void) {
     glfwSwapInterval(1); // Enable vsync
 
     // Setup input callbacks
+    glfwSetCursorPosCallback(window, cursor_pos_callback);
     glfwSetMouseButtonCallback(window, mouse_button_callback);
     glfwSetScrollCallback(window, scroll_callback);
+    glfwSetKeyCallback(window, key_callback);
+    glfwSetCharCallback(window, char_callback);
 
     // Initialize GUI
     gui_init(&gui_ctx);
+    gui_ctx.style.anti_aliased_shapes = true; // Smooth canvas shapes without MSAA
+    gui_ctx.reorder_commands = true;          // Batch the toolbar icons and labels across widgets
+#ifdef CGUI_ENABLE_OPAQUE_PASS
+    gui_ctx.opaque_pass = true; // Skip pixels hidden behind the opaque panels
+#endif
     gui_backend_gl_init(&backend);
+    heatmap_texture =
+        gui_backend_gl_create_texture(&backend, DEMO_HEATMAP_SIZE, DEMO_HEATMAP_SIZE, NULL);
+    icons_build();
 
     printf("CGUI Demo Started\n");
     printf("- C17 Immediate Mode GUI Library\n");
@@ -84,6 +271,43 @@ int main(void) {
     printf("- Single-header design\n");
     printf("- GLFW + OpenGL 2.1 backend\n\n");
 
+    for (int i = 0; i < DEMO_TABLE_COLUMNS; i++) {
+        snprintf(table_column_labels[i], sizeof(table_column_labels[i]), "Col %d", i);
+        table_columns[i] = (gui_table_column_t){table_column_labels[i], 80.0F, 30.0F};
+    }
+    table_sort(false);
+
+    if (replay_path) {
+        int result = replay_session(window, replay_path);
+        icons_free();
+        gui_backend_gl_destroy_texture(&backend, heatmap_texture);
+        gui_backend_gl_shutdown(&backend);
+        gui_shutdown(&gui_ctx);
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return result;
+    }
+
+    gui_recorder_t recorder;
+    bool recording = false;
+    if (record_path) {
+        recording = gui_record_open(&recorder, record_path, GUI_RECORD_DRAW_DATA);
+        if (!recording) {
+            fprintf(stderr, "Failed to create recording %s\n", record_path);
+        }
+    }
+
+    gui_remote_server_t remote;
+    bool serving = false;
+    if (serve_port > 0) {
+        serving = gui_remote_server_open(&remote, serve_address, (uint16_t)serve_port);
+        if (serving) {
+            printf("Serving frames on %s:%d\n", serve_address, serve_port);
+        } else {
+            fprintf(stderr, "Failed to listen on %s:%d\n", serve_address, serve_port);
+        }
+    }
+
     last_time = (float)glfwGetTime();
 
     // Main loop
@@ -96,23 +320,22 @@ int main(void) {
         int display_h;
         glfwGetFramebufferSize(window, &display_w, &display_h);
 
-        // Get mouse position
-        double mouse_x;
-        double mouse_y;
-        glfwGetCursorPos(window, &mouse_x, &mouse_y);
-
         // Calculate delta time
         float current_time = (float)glfwGetTime();
         float delta_time = current_time - last_time;
         last_time = current_time;
 
-        // Update input
-        gui_update_input(&gui_ctx, (float)mouse_x, (float)mouse_y, mouse_buttons,
-                         gui_ctx.input.mouse_wheel, delta_time);
-        gui_ctx.input.mouse_wheel = 0.0F; // Reset scroll
+        // Update time (input arrives through the event callbacks and from a remote viewer)
+        gui_update_time(&gui_ctx, delta_time);
+        if (serving) {
+            gui_remote_server_poll(&remote, &gui_ctx);
+        }
 
         // Begin frame
         gui_begin_frame(&gui_ctx, (float)display_w, (float)display_h);
+        if (recording) {
+            gui_record_begin_frame(&recorder, &gui_ctx);
+        }
 
         // =============================================================================
         // GUI CODE (Immediate Mode)
@@ -130,6 +353,10 @@ int main(void) {
             if (gui_button(&gui_ctx, "Click Me!", 0, 0)) {
                 button_click_count++;
                 printf("Button clicked! Count: %d\n", button_click_count);
+                char line[64];
+                snprintf(line, sizeof(line), "%.2f button clicked (%d)", (double)current_time,
+                         button_click_count);
+                demo_log(line);
             }
 
             // Display click count
@@ -152,16 +379,20 @@ int main(void) {
 
             gui_spacing(&gui_ctx, 20);
 
-            // Multiple buttons in vertical layout
-            gui_label(&gui_ctx, "Multiple Buttons:");
-            if (gui_button(&gui_ctx, "Button A", 0, 0)) {
-                printf("Button A pressed\n");
-            }
-            if (gui_button(&gui_ctx, "Button B", 0, 0)) {
-                printf("Button B pressed\n");
-            }
-            if (gui_button(&gui_ctx, "Button C", 0, 0)) {
-                printf("Button C pressed\n");
+            // Multiple buttons in vertical layout, replayed from last frame until one of them
+            // is hovered
+            if (gui_begin_cached(&gui_ctx, "buttons", 0, 0, 0)) {
+                gui_label(&gui_ctx, "Multiple Buttons:");
+                if (gui_button(&gui_ctx, "Button A", 0, 0)) {
+                    printf("Button A pressed\n");
+                }
+                if (gui_button(&gui_ctx, "Button B", 0, 0)) {
+                    printf("Button B pressed\n");
+                }
+                if (gui_button(&gui_ctx, "Button C", 0, 0)) {
+                    printf("Button C pressed\n");
+                }
+                gui_end_cached(&gui_ctx);
             }
         }
         gui_end_vbox(&gui_ctx);
@@ -178,6 +409,10 @@ int main(void) {
             if (gui_button(&gui_ctx, "H3", 100, 0)) {
                 printf("H3 pressed\n");
             }
+            for (int i = 0; i < DEMO_ICON_COUNT; i++) {
+                gui_atlas_image(&gui_ctx, &icon_atlas, icons[i], DEMO_ICON_SIZE, DEMO_ICON_SIZE,
+                                GUI_COLOR_WHITE);
+            }
         }
         gui_end_hbox(&gui_ctx);
 
@@ -187,39 +422,109 @@ int main(void) {
         float canvas_w = 400;
         float canvas_h = 400;
 
-        // Draw canvas background
-        gui_add_rect_filled(&gui_ctx, canvas_x, canvas_y, canvas_w, canvas_h,
-                            gui_color_from_rgba(30, 30, 30, 255));
-        gui_add_rect(&gui_ctx, canvas_x, canvas_y, canvas_w, canvas_h, GUI_COLOR_WHITE, 2.0F);
-
-        // Draw some shapes
-        gui_add_circle_filled(&gui_ctx, canvas_x + 100, canvas_y + 100, 40, GUI_COLOR_RED);
-        gui_add_circle(&gui_ctx, canvas_x + 100, canvas_y + 100, 50, GUI_COLOR_WHITE, 2.0F);
-
-        gui_add_rect_filled(&gui_ctx, canvas_x + 200, canvas_y + 50, 80, 80, GUI_COLOR_GREEN);
-
-        gui_add_triangle_filled(&gui_ctx, canvas_x + 300, canvas_y + 200, canvas_x + 250,
-                                canvas_y + 300, canvas_x + 350, canvas_y + 300, GUI_COLOR_BLUE);
+        // The static shapes are rendered once into a texture and composited afterwards.
+        // Recordings and remote viewers need the content itself every frame.
+        if (recording || serving) {
+            gui_invalidate_cached_layers(&gui_ctx);
+        }
+        if (gui_begin_cached_layer(&gui_ctx, "canvas", 0, canvas_x - 2, canvas_y - 2,
+                                   canvas_w + 4, canvas_h + 4)) {
+            // Draw canvas background
+            gui_add_rect_filled(&gui_ctx, canvas_x, canvas_y, canvas_w, canvas_h,
+                                gui_color_from_rgba(30, 30, 30, 255));
+            gui_add_rect(&gui_ctx, canvas_x, canvas_y, canvas_w, canvas_h, GUI_COLOR_WHITE, 2.0F);
+
+            // Draw some shapes
+            gui_add_circle_filled(&gui_ctx, canvas_x + 100, canvas_y + 100, 40, GUI_COLOR_RED);
+            gui_add_circle(&gui_ctx, canvas_x + 100, canvas_y + 100, 50, GUI_COLOR_WHITE, 2.0F);
+
+            gui_add_rect_filled(&gui_ctx, canvas_x + 200, canvas_y + 50, 80, 80, GUI_COLOR_GREEN);
+
+            gui_add_triangle_filled(&gui_ctx, canvas_x + 300, canvas_y + 200, canvas_x + 250,
+                                    canvas_y + 300, canvas_x + 350, canvas_y + 300,
+                                    GUI_COLOR_BLUE);
+
+            // Draw some lines
+            for (int i = 0; i < 10; i++) {
+                float t = (float)i / 10.0F;
+                gui_add_line(&gui_ctx, canvas_x + (t * canvas_w), canvas_y + canvas_h - 50,
+                             canvas_x + canvas_w - (t * canvas_w), canvas_y + canvas_h - 10,
+                             gui_color_from_rgba(255, (uint8_t)(t * 255), 255, 255), 2.0F);
+            }
+            gui_end_cached_layer(&gui_ctx);
+        }
 
         // Draw animated circle based on slider value
         float anim_x = canvas_x + 50 + (slider_value * (canvas_w - 100));
         float anim_y = canvas_y + 300;
         gui_add_circle_filled(&gui_ctx, anim_x, anim_y, 20, GUI_COLOR_YELLOW);
 
-        // Draw some lines
-        for (int i = 0; i < 10; i++) {
-            float t = (float)i / 10.0F;
-            gui_add_line(&gui_ctx, canvas_x + (t * canvas_w), canvas_y + canvas_h - 50,
-                         canvas_x + canvas_w - (t * canvas_w), canvas_y + canvas_h - 10,
-                         gui_color_from_rgba(255, (uint8_t)(t * 255), 255, 255), 2.0F);
-        }
-
         // Label for custom drawing area
         gui_add_text(&gui_ctx, "Custom Draw API Demo", canvas_x + 10, canvas_y + canvas_h + 10,
                      GUI_COLOR_WHITE, 14.0F);
 
+        // Streamed texture (uploaded through pixel-unpack buffers)
+        heatmap_stream(current_time);
+        gui_begin_vbox(&gui_ctx, 500, 450, 220, 0, 10);
+        {
+            gui_label(&gui_ctx, "Streamed heatmap:");
+            gui_image(&gui_ctx, heatmap_texture, 200, 200, (gui_vec2_t){0, 0}, (gui_vec2_t){1, 1},
+                      GUI_COLOR_WHITE);
+        }
+        gui_end_vbox(&gui_ctx);
+
+        // Streaming plot: 256 new samples per frame, decimated to the plot width
+        for (int i = 0; i < 256; i++, plot_total++) {
+            float t = (float)plot_total * 0.0005F;
+            plot_ring[plot_total % DEMO_PLOT_CAPACITY] =
+                sinf(t) + (0.3F * sinf(t * 37.0F)) + (slider_value * sinf(t * 411.0F));
+        }
+        gui_begin_vbox(&gui_ctx, 20, 470, 400, 10, 10);
+        {
+            gui_plot_lines_ring(&gui_ctx, "Signal", plot_ring, DEMO_PLOT_CAPACITY, 0, plot_total,
+                                -2.5F, 2.5F, 0, 150);
+        }
+        gui_end_vbox(&gui_ctx);
+
+        // Log viewer over the ring buffer: one line every 10 frames, clicks highlighted
+        if (plot_total % 2560 == 0) {
+            char line[64];
+            snprintf(line, sizeof(line), "%.2f signal %.3f", (double)current_time,
+                     (double)plot_ring[(plot_total - 1) % DEMO_PLOT_CAPACITY]);
+            demo_log(line);
+        }
+        gui_begin_vbox(&gui_ctx, 730, 450, 200, 0, 10);
+        {
+            gui_label(&gui_ctx, "Log:");
+            gui_log_view(&gui_ctx, "log", log_ring, DEMO_LOG_CAPACITY, log_total, "click", 0, 200);
+        }
+        gui_end_vbox(&gui_ctx);
+
+        // Virtualized table (100k x 100 cells, only the visible ones are generated)
+        GUI_TRACE_BEGIN("table panel");
+        gui_begin_vbox(&gui_ctx, 940, 20, 320, 0, 10);
+        {
+            gui_label(&gui_ctx, "Table (click a header to sort):");
+            gui_table_desc_t table = {table_columns, DEMO_TABLE_COLUMNS, DEMO_TABLE_ROWS,
+                                      table_order, table_cell_text, NULL};
+            if (gui_table(&gui_ctx, "table", &table, 0, 400) >= 0) {
+                table_sort(!table_descending);
+            }
+
+            // Frame metrics (counters of the previous frame, graphs over the last 120)
+            gui_stats_overlay(&gui_ctx, 0);
+        }
+        gui_end_vbox(&gui_ctx);
+        GUI_TRACE_END();
+
         // End frame
         gui_end_frame(&gui_ctx);
+        if (recording) {
+            gui_record_end_frame(&recorder, &gui_ctx);
+        }
+        if (serving) {
+            gui_remote_server_send_frame(&remote, &gui_ctx);
+        }
 
         // =============================================================================
         // RENDERING
@@ -237,6 +542,22 @@ int main(void) {
     }
 
     // Cleanup
+    if (recording) {
+        printf("Recorded %u frames (%llu bytes) to %s\n", recorder.frame_count,
+               (unsigned long long)recorder.bytes_written, record_path);
+        gui_record_close(&recorder);
+    }
+    if (serving) {
+        gui_remote_server_close(&remote);
+    }
+#ifdef CGUI_ENABLE_TRACE
+    if (gui_trace_dump("cgui_trace.json")) {
+        printf("Trace written to cgui_trace.json\n");
+    }
+    gui_trace_shutdown();
+#endif
+    icons_free();
+    gui_backend_gl_destroy_texture(&backend, heatmap_texture);
     gui_backend_gl_shutdown(&backend);
     gui_shutdown(&gui_ctx);
 
@@ -0,0 +1,151 @@
+/*
+ * CGUI Remote Viewer
+ * Renders the draw lists streamed by an application using cgui_remote.h and sends input back.
+ *
+ *   cgui_viewer [host] [port]     (defaults: 127.0.0.1 7878)
+ */
+
+#include <stdint.h>
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#endif
+#include <GL/gl.h>
+#define CGUI_IMPLEMENTATION
+#include "cgui.h"
+
+#define CGUI_BACKEND_GL_IMPLEMENTATION
+#include "cgui_backend_gl.h"
+
+#define CGUI_RECORD_IMPLEMENTATION
+#include "cgui_record.h"
+
+#define CGUI_REMOTE_IMPLEMENTATION
+#include "cgui_remote.h"
+
+#include <GLFW/glfw3.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+static gui_context_t gui_ctx; // Holds the received draw lists
+static gui_backend_gl_t backend;
+static gui_remote_client_t client;
+
+void error_callback(int error, const char *description) {
+    fprintf(stderr, "GLFW Error %d: %s\n", error, description);
+}
+
+// Input callbacks forward events to the application
+void cursor_pos_callback(GLFWwindow *window, double xpos, double ypos) {
+    (void)window;
+    gui_input_event_t event = {.type = GUI_INPUT_EVENT_MOUSE_POS, .timestamp = glfwGetTime()};
+    event.mouse_pos = (gui_vec2_t){(float)xpos, (float)ypos};
+    gui_remote_client_send_event(&client, &event);
+}
+
+void mouse_button_callback(GLFWwindow *window, int button, int action, int mods) {
+    (void)window;
+    (void)mods;
+    gui_input_event_t event = {.type = GUI_INPUT_EVENT_MOUSE_BUTTON, .timestamp = glfwGetTime()};
+    event.mouse_button.button = button;
+    event.mouse_button.down = action == GLFW_PRESS;
+    gui_remote_client_send_event(&client, &event);
+}
+
+void scroll_callback(GLFWwindow *window, double xoffset, double yoffset) {
+    (void)window;
+    gui_input_event_t event = {.type = GUI_INPUT_EVENT_MOUSE_WHEEL, .timestamp = glfwGetTime()};
+    event.mouse_wheel = (gui_vec2_t){(float)xoffset, (float)yoffset};
+    gui_remote_client_send_event(&client, &event);
+}
+
+void key_callback(GLFWwindow *window, int key, int scancode, int action, int mods) {
+    (void)window;
+    (void)scancode;
+    (void)mods;
+    gui_input_event_t event = {.type = GUI_INPUT_EVENT_KEY, .timestamp = glfwGetTime()};
+    event.key.key = key;
+    event.key.down = action != GLFW_RELEASE;
+    gui_remote_client_send_event(&client, &event);
+}
+
+void char_callback(GLFWwindow *window, unsigned int codepoint) {
+    (void)window;
+    gui_input_event_t event = {.type = GUI_INPUT_EVENT_TEXT, .timestamp = glfwGetTime()};
+    event.codepoint = codepoint;
+    gui_remote_client_send_event(&client, &event);
+}
+
+int main(int argc, char **argv) {
+    const char *host = argc > 1 ? argv[1] : "127.0.0.1";
+    uint16_t port = (uint16_t)(argc > 2 ? atoi(argv[2]) : 7878);
+
+    glfwSetErrorCallback(error_callback);
+    if (!glfwInit()) {
+        fprintf(stderr, "Failed to initialize GLFW\n");
+        return -1;
+    }
+
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 2);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 1);
+    glfwWindowHint(GLFW_RESIZABLE, GLFW_TRUE);
+
+    GLFWwindow *window = glfwCreateWindow(1280, 720, "CGUI Remote Viewer", NULL, NULL);
+    if (!window) {
+        fprintf(stderr, "Failed to create GLFW window\n");
+        glfwTerminate();
+        return -1;
+    }
+    glfwMakeContextCurrent(window);
+    glfwSwapInterval(1);
+
+    glfwSetCursorPosCallback(window, cursor_pos_callback);
+    glfwSetMouseButtonCallback(window, mouse_button_callback);
+    glfwSetScrollCallback(window, scroll_callback);
+    glfwSetKeyCallback(window, key_callback);
+    glfwSetCharCallback(window, char_callback);
+
+    if (!gui_remote_client_connect(&client, host, port)) {
+        fprintf(stderr, "Failed to connect to %s:%u\n", host, (unsigned)port);
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return -1;
+    }
+    printf("Connected to %s:%u\n", host, (unsigned)port);
+
+    gui_init(&gui_ctx);
+    gui_backend_gl_init(&backend);
+
+    int sent_w = 0;
+    int sent_h = 0;
+    while (!glfwWindowShouldClose(window) && client.connected) {
+        glfwPollEvents();
+
+        int display_w;
+        int display_h;
+        glfwGetFramebufferSize(window, &display_w, &display_h);
+        if (display_w != sent_w || display_h != sent_h) {
+            gui_remote_client_send_display_size(&client, (float)display_w, (float)display_h);
+            sent_w = display_w;
+            sent_h = display_h;
+        }
+
+        // Also flushes queued input and acknowledgements
+        if (gui_remote_client_poll(&client)) {
+            gui_remote_client_apply(&client, &gui_ctx);
+        }
+
+        glClearColor(0.1F, 0.1F, 0.15F, 1.0F);
+        glClear(GL_COLOR_BUFFER_BIT);
+        gui_backend_gl_render(&backend, &gui_ctx);
+        glfwSwapBuffers(window);
+    }
+
+    printf("Received %llu frames\n", (unsigned long long)client.frames_received);
+    gui_remote_client_close(&client);
+    gui_backend_gl_shutdown(&backend);
+    gui_shutdown(&gui_ctx);
+    glfwDestroyWindow(window);
+    glfwTerminate();
+    return 0;
+}